@@ -3,6 +3,11 @@
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "TriePrediction.h"
 
 #define MAX_WORD_LENGTH 1023
@@ -11,24 +16,158 @@
 
 // Suggested Helper Functions
 
-// Creates a new TrieNode.
-TrieNode *createTrieNode(void) 
+// Creates an empty Trie.
+Trie *createTrie(void)
 {
-	
-	return calloc(1, sizeof(TrieNode));
+	Trie *trie = calloc(1, sizeof(Trie));
+
+	if (trie == NULL)
+	{
+		fprintf(stderr, "Error: could not allocate memory in createTrie().\n");
+		exit(1);
+	}
+
+	// Index 0 is never given to a node.
+	trie->nodeCount = 1;
+	return trie;
+}
+
+// Returns the node at the given index.
+TrieNode *trieNode(Trie *trie, unsigned int node)
+{
+	return &trie->chunks[node >> TRIE_CHUNK_BITS][node & (TRIE_CHUNK_NODES - 1)];
+}
+
+// Creates a new TrieNode in the trie and returns its index.
+unsigned int createTrieNode(Trie *trie)
+{
+	unsigned int chunk = trie->nodeCount >> TRIE_CHUNK_BITS;
+	TrieNode **chunks;
+
+	if (trie->nodeCount == UINT_MAX)
+	{
+		fprintf(stderr, "Error: too many nodes in createTrieNode().\n");
+		exit(1);
+	}
+
+	// The last chunk is full, add one (calloc gives nodes without children).
+	if (chunk == trie->chunkCount)
+	{
+		if (trie->chunkCount == trie->chunkCapacity)
+		{
+			trie->chunkCapacity = (trie->chunkCapacity == 0)? 16:trie->chunkCapacity * 2;
+			chunks = realloc(trie->chunks, sizeof(TrieNode *) * trie->chunkCapacity);
+			if (chunks == NULL)
+			{
+				fprintf(stderr, "Error: could not allocate memory in createTrieNode().\n");
+				exit(1);
+			}
+			trie->chunks = chunks;
+		}
+
+		trie->chunks[chunk] = calloc(TRIE_CHUNK_NODES, sizeof(TrieNode));
+		if (trie->chunks[chunk] == NULL)
+		{
+			fprintf(stderr, "Error: could not allocate memory in createTrieNode().\n");
+			exit(1);
+		}
+		trie->chunkCount++;
+	}
+
+	return trie->nodeCount++;
+}
+
+// Returns the child of ancestor whose subtree holds node.
+unsigned int childToward(Trie *trie, unsigned int ancestor, unsigned int node)
+{
+	while (trieNode(trie, node)->parent != ancestor)
+		node = trieNode(trie, node)->parent;
+
+	return node;
+}
+
+// Returns the letter of the edge between a node and its parent.
+char edgeLetter(Trie *trie, unsigned int node)
+{
+	int i;
+	TrieNode *parent = trieNode(trie, trieNode(trie, node)->parent);
+
+	for (i = 0; i < 26; i++)
+		if (parent->children[i] == node)
+			break;
+
+	return 'a' + i;
 }
 
-// Inserts String at the root of a TrieNode.
-TrieNode *insertString(TrieNode *root, char *str) // (Credit: Dr. S.) 
+// Called when the count of terminal went up: terminal becomes the best
+// word of the nodes above it that it now beats. A word
+// beats an other one with the same count if it comes first alphabetically,
+// which is the case for a prefix of the other word, or for a word that
+// leaves their common prefix by a smaller letter. Once terminal loses to
+// the best word of a node, that word also beats it everywhere above.
+void updateBest(Trie *trie, unsigned int terminal)
+{
+	int count = trieNode(trie, terminal)->count;
+	unsigned int node = terminal, from = 0, best;
+	TrieNode *current;
+
+	while (node != 0)
+	{
+		current = trieNode(trie, node);
+		best = current->best;
+
+		if (best != terminal && best != 0)
+		{
+			if (count < current->bestCount)
+				break;
+
+			if (count == current->bestCount && node != terminal &&
+			    (best == node || edgeLetter(trie, childToward(trie, node, best)) < edgeLetter(trie, from)))
+				break;
+		}
+
+		current->best = terminal;
+		current->bestCount = count;
+
+		// from is the child of the next node on the way to terminal
+		from = node;
+		node = current->parent;
+	}
+}
+
+// Writes the word of a node into str, from the root of its (sub)trie.
+void getWord(Trie *trie, unsigned int node, char *str)
+{
+	int i, len = 0;
+	char letter;
+
+	while (trieNode(trie, node)->parent != 0)
+	{
+		str[len++] = edgeLetter(trie, node);
+		node = trieNode(trie, node)->parent;
+	}
+	str[len] = '\0';
+
+	for (i = 0; i < len / 2; i++)
+	{
+		letter = str[i];
+		str[i] = str[len - 1 - i];
+		str[len - 1 - i] = letter;
+	}
+}
+
+// Inserts String at the root of a TrieNode. A root of 0 creates a new
+// (sub)trie; its index is returned.
+unsigned int insertString(Trie *trie, unsigned int root, char *str) // (Credit: Dr. S.) 
 {
 	int i, idx, len = strlen(str);
-	TrieNode *temp_root;
+	unsigned int temp_root, child;
 
-	// Check if the root is NULL
-	if (root == NULL)
-		root = createTrieNode();
+	// Check if the root is 0
+	if (root == 0)
+		root = createTrieNode(trie);
 
-	// If root != NULL, assign root to a temp variable.
+	// If root != 0, assign root to a temp variable.
 	temp_root = root;
 
 	// Then check every child in the TrieNode against str[i] for a match
@@ -38,27 +177,70 @@ TrieNode *insertString(TrieNode *root, char *str) // (Credit: Dr. S.)
 		if (!isalpha(str[i]))
 		{
 			fprintf(stderr, "Error: (%s) contains non-alpha characters (%c) and will not be inserted---InsertString():48.\n", str, str[i]);
-			return NULL;
+			return 0;
 		}		
 
 		// Else if char is in alphabet, set the index
 		idx = tolower(str[i]) - 'a';
 
-		// Before jumping to the child TrieNode, Check if NULL
-		if ( temp_root->children[idx] == NULL)
-			temp_root->children[idx] = createTrieNode();
+		// Before jumping to the child TrieNode, Check if 0
+		child = trieNode(trie, temp_root)->children[idx];
+		if ( child == 0)
+		{
+			child = createTrieNode(trie);
+			trieNode(trie, temp_root)->children[idx] = child;
+			trieNode(trie, child)->parent = temp_root;
+		}
 
 		// Move the temp_root to its correct child TrieNode
-		temp_root = temp_root->children[idx];
+		temp_root = child;
 
 	//	printf("\nSuccessfully inserted (%c) at root->children[%d]!\n", str[i], idx);
 	}
 
 	// The str is inserted, increment the count variable
-	temp_root->count++;
+	trieNode(trie, temp_root)->count++;
+	updateBest(trie, temp_root);
 	return root;
 }
 
+// Inserts a word read from the corpus, len characters that are not copied
+// or terminated, into the (sub)trie *root (created if 0). The characters
+// that are not letters are skipped, as stripPuncuators() would remove
+// them. Returns the terminal node of the word.
+unsigned int insertWord(Trie *trie, unsigned int *root, char *word, int len)
+{
+	int i, idx;
+	unsigned int temp_root, child;
+
+	if (*root == 0)
+		*root = createTrieNode(trie);
+
+	temp_root = *root;
+
+	for (i = 0; i < len; i++)
+	{
+		if (!isalpha((unsigned char)word[i]))
+			continue;
+
+		idx = tolower((unsigned char)word[i]) - 'a';
+
+		child = trieNode(trie, temp_root)->children[idx];
+		if (child == 0)
+		{
+			child = createTrieNode(trie);
+			trieNode(trie, temp_root)->children[idx] = child;
+			trieNode(trie, child)->parent = temp_root;
+		}
+
+		temp_root = child;
+	}
+
+	trieNode(trie, temp_root)->count++;
+	updateBest(trie, temp_root);
+	return temp_root;
+}
+
 // Strips away any punctuators from a string. 
 void stripPuncuators(char *str) 
 {
@@ -93,90 +275,13 @@ int noPuncuators(char *str)
 }
 
 
-// Determines Min of two numbers.
-int findMin(int A, int B)
-{
-	return ((A < B)? A:B);
-}
-
-// Prioritizes two strings passed by their alphabetical order.
-void alphabetizePriority(char *strA, char *strB, char *winner)
-{
-	int i;
-	int lenA = strlen(strA);
-	int lenB = strlen(strB);
-	int maxlen = (findMin(lenA, lenB));
-
-	// ASCII value variables for each char in both strings.
-	int A;
-	int B;
-	int order = 0; 
-
-	if (lenA == lenB)
-	{
-		// Both strings are the same in length.
-		for (i = 0; i < lenA; i++)
-		{	
-			if (strA[i] < strB[i])
-			{
-				order = 1;
-				break;
-			}
-			else if (strA[i] > strB[i])
-			{
-				order = 0;
-				break;
-			}
-	
-			else
-				order = 2;
-		}
-	}
-	else
-	{
-		// Both strings are NOT the same in length.
-		// Need to worry about overstepping bounds of each array.
-		for (i = 0; i < maxlen; i++)
-		{
-			if (strA[i] < strB[i])
-			{
-				order = 1;
-				break;
-			}
-			else if (strA[i] > strB[i])
-			{
-				order = 0;
-				break;
-			}
-			// If you have two of the same strings, but one 
-			// has a extra char at the end, priority is given to
-			// the shorter string, order 2;
-			else if (strA[i] == strB[i])
-			{
-				order = 2;
-			}
-		}
-	}
-	if (order == 1)
-		strcpy(winner, strA);
-	else if (order == 0)
-		strcpy(winner, strB);
-	else if (order == 2)
-	{
-		if ( lenA < lenB )
-			strcpy(winner, strA);
-		else
-			strcpy(winner, strB);
-	}
-}
-
 // This function finds the number of active children nodes
 int activeChildren(TrieNode *root)
 {
 	int i, active = 0;
 
 	for (i = 0; i < 26; i++)
-		if (root->children[i] != NULL)
+		if (root->children[i] != 0)
 			active++;
 
 	return active;
@@ -191,249 +296,508 @@ int isSubtrieEmpty(TrieNode *root) // :)
 // This function is a tweaked version of getNode().
 // getPrefixNode() is used to help find the terminal node
 // of a given prefix in a trie.
-TrieNode *getPrefixNode(TrieNode *root, char *str) 
+unsigned int getPrefixNode(Trie *trie, unsigned int root, char *str) 
 {
 	int i;
 	int idx;
 	int len = strlen(str);
-	TrieNode *temp_root;
-	TrieNode *terminal;
+	unsigned int temp_root;
 
-	// Check if root passed is NULL
-	if (root == NULL)
-		return NULL;
+	// Check if root passed is 0
+	if (trie == NULL || root == 0)
+		return 0;
 
 	// Assign root to a temporay variable
 	temp_root = root;
 
-	for (i = 0; i < len; i++)
+	for (i = 0; i < len && temp_root != 0; i++)
 	{
+		// Words of other characters are not in the trie
+		if (!isalpha(str[i]))
+			return 0;
+
 		// Find index of children[] corresponding to character
 		idx = tolower(str[i]) - 'a';
 
 		// Move temp_root to that index
-		temp_root = temp_root->children[idx];
-
-		// Check its count
-		if ( temp_root != NULL)
-			terminal = temp_root;
-		else 
-			terminal = NULL;
+		temp_root = trieNode(trie, temp_root)->children[idx];
 	}
-	return terminal;
+	return temp_root;
 }
 
-int countStrings(TrieNode *root) 
+int countStrings(Trie *trie, unsigned int root) 
 {
 	int i;
 	int count = 0;
+	TrieNode *node;
 
-	if (root == NULL)
+	if (trie == NULL || root == 0)
 		return 0;
 
-	if (root->count > 0)
+	node = trieNode(trie, root);
+	if (node->count > 0)
 		count += 1;
 
 	for (i = 0; i < 26; i++)
 	{
-		if (root->children[i] != NULL)
-			count += countStrings(root->children[i]);
+		if (node->children[i] != 0)
+			count += countStrings(trie, node->children[i]);
 	}
 	return count;
 }
 
-void getMostFreqHelper(TrieNode *root, char *actual, char *temp, int k, int max)
+// Helper function called by printTrie(). (Credit: Dr. S.)
+void printTrieHelper(Trie *trie, unsigned int root, char *buffer, int k) 
 {
-	int i, new_max;
-	char prev[MAX_WORD_LENGTH];
-	char current[MAX_WORD_LENGTH];
-	char newStr[MAX_WORD_LENGTH];
+	int i;
+	TrieNode *node;
 
-	if (root == NULL)
+	if (root == 0)
 		return;
 
+	node = trieNode(trie, root);
+	if (node->count > 0)
+		printf("%s (%d)\n", buffer, node->count);
+
+	buffer[k + 1] = '\0';
+
+	for (i = 0; i < 26; i++)
+	{
+		buffer[k] = 'a' + i;
+
+		printTrieHelper(trie, node->children[i], buffer, k + 1);
+	}
+
+	buffer[k] = '\0';
+}
 
-	if (root->count > 0)
+// If printing a subtrie, the second parameter should be 1; otherwise, if
+// printing the main trie, the second parameter should be 0. (Credit: Dr. S.)
+void printTrie(Trie *trie, unsigned int root, int useSubtrieFormatting) 
+{
+	char buffer[1026];
+
+	if (trie == NULL)
+		return;
+
+	if (useSubtrieFormatting)
 	{
-		
-		if (root->count == max)
+		strcpy(buffer, "- ");
+		printTrieHelper(trie, root, buffer, 2);
+	}
+	else
+	{
+		strcpy(buffer, "");
+		printTrieHelper(trie, root, buffer, 0);
+	}
+}
+
+// Maps a corpus file into memory to be read by nextWord(). Returns 0, or 1
+// if the file cannot be read.
+int openCorpus(CorpusReader *reader, char *filename)
+{
+	int fd;
+	struct stat st;
+
+	if ((fd = open(filename, O_RDONLY)) < 0)
+		return 1;
+
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return 1;
+	}
+
+	reader->size = st.st_size;
+	reader->data = NULL;
+
+	// An empty file cannot be mapped, it has no words anyway
+	if (reader->size > 0)
+	{
+		reader->data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (reader->data == MAP_FAILED)
 		{
-			new_max = root->count;
-			//strcpy(current, temp);
-			//printf("(max: %d count: %d)prev word: (%s)\n", new_max, root->count, actual);
-			//printf("(max: %d count: %d)current word: (%s)\n", new_max, root->count, current);
-			alphabetizePriority(actual, current, newStr);
-			strcpy(actual, newStr);
-			//printf("prioritized word: %s\n", actual);
+			close(fd);
+			return 1;
 		}
-		else
+		madvise(reader->data, reader->size, MADV_SEQUENTIAL);
+	}
+
+	// The mapping stays valid once the file is closed
+	close(fd);
+
+	reader->pos = 0;
+	reader->end = reader->size;
+	return 0;
+}
+
+void closeCorpus(CorpusReader *reader)
+{
+	if (reader->data != NULL)
+		munmap(reader->data, reader->size);
+
+	reader->data = NULL;
+}
+
+// Returns the next word of the corpus before reader->end, or NULL if there
+// is none. A word is what fscanf("%s") would read; it is not copied, its
+// length goes to *len and *sentenceEnded tells whether it contains '.',
+// '?' or '!'.
+char *nextWord(CorpusReader *reader, int *len, int *sentenceEnded)
+{
+	long pos = reader->pos;
+	char *word;
+
+	while (pos < reader->end && isspace((unsigned char)reader->data[pos]))
+		pos++;
+
+	if (pos >= reader->end)
+	{
+		reader->pos = pos;
+		return NULL;
+	}
+
+	word = reader->data + pos;
+	*sentenceEnded = 0;
+
+	for (; pos < reader->end && !isspace((unsigned char)reader->data[pos]); pos++)
+		if (reader->data[pos] == '.' || reader->data[pos] == '?' || reader->data[pos] == '!')
+			*sentenceEnded = 1;
+
+	*len = reader->data + pos - word;
+	reader->pos = pos;
+	return word;
+}
+
+Trie *buildTrie(char *filename)
+{
+	Trie *trie;
+	CorpusReader reader;
+
+	if (openCorpus(&reader, filename) != 0)
+	{
+		fprintf(stderr, "Failed to open \"%s\" in buildTrie().\n", filename);
+		return NULL;
+	}
+
+	trie = createTrie();
+	readCorpus(trie, &reader, NULL);
+
+	closeCorpus(&reader);
+	return trie;
+}
+
+// Adds a node to the list of the nodes whose subtrie a shard removed.
+void addCleared(TrieShard *shard, unsigned int node)
+{
+	unsigned int *cleared;
+
+	if (shard->clearedCount == shard->clearedCapacity)
+	{
+		shard->clearedCapacity = (shard->clearedCapacity == 0)? 1024:shard->clearedCapacity * 2;
+		cleared = realloc(shard->cleared, sizeof(unsigned int) * shard->clearedCapacity);
+		if (cleared == NULL)
 		{
-			strcpy(actual, temp);
-			new_max = root->count;
-			//printf("(max: %d count: %d)current word: %s\n", new_max, root->count, actual);
-		}		
+			fprintf(stderr, "Error: could not allocate memory in addCleared().\n");
+			exit(1);
+		}
+		shard->cleared = cleared;
 	}
 
-	temp[k + 1] = '\0';
+	shard->cleared[shard->clearedCount++] = node;
+}
 
-	for (i = 0; i < 26; i++)
+// Inserts the words of a corpus into the trie, from reader->pos up to
+// reader->end. The words are inserted where they lie in the mapped file,
+// and the terminal node of a word is kept for the word after it, instead
+// of being looked up again. The words that end a sentence get their
+// subtrie removed; if shard is not NULL, their nodes are also added to
+// shard->cleared.
+void readCorpus(Trie *trie, CorpusReader *reader, TrieShard *shard)
+{
+	unsigned int prev_node = 0, current_node;
+	int len, sentenceEnded = 0; // 1 = true, sentence has ended
+	int word_count = 0;
+	char *word;
+
+	// Insert words one-by-one into the trie.
+	while ((word = nextWord(reader, &len, &sentenceEnded)) != NULL)
 	{
-		temp[k] = 'a' + i;
-		getMostFreqHelper(root->children[i], actual, temp, k+1, new_max);
+		// New word is read & inserted, increment word_count
+		word_count++;
+
+		// Insert the word into the trie, without its punctuators
+		current_node = insertWord(trie, &trie->root, word, len);
+
+		// The first word of a sentence is only inserted.
+		if (word_count > 1)
+		{
+			// check if the word is the last in its sentence.
+			if (sentenceEnded) 
+			{	
+				// Set the the terminal node of the last word's
+				// subtrie equal to 0.
+				trieNode(trie, current_node)->subtrie = 0;
+
+				if (shard != NULL)
+					addCleared(shard, current_node);
+
+				// Reset word_count back to zero for next line
+				word_count = 0;
+			}
+			else 
+			{
+				// Insert the word into the subtrie of the prev word.
+				// insertWord() may add a chunk, but chunks never move.
+				insertWord(trie, &trieNode(trie, prev_node)->subtrie, word, len);
+			}
+		}
+
+		// The new word is no longer needed, now put in previous.
+		prev_node = current_node;
 	}
-	temp[k] = '\0';
 }
 
-// Helper function called by printTrie(). (Credit: Dr. S.)
-void printTrieHelper(TrieNode *root, char *buffer, int k) 
+// Returns the offset where the shard of a parallel build that would start
+// at the given offset really starts: after the next word that ends a
+// sentence and follows a word that does not. buildTrie() starts over
+// after such a word, whatever came before, so the shards can be built
+// apart. A word cut by the offset belongs to the previous shard.
+long findShardStart(CorpusReader *reader, long offset)
 {
-	int i;
+	int len, ended, prev_ended = -1;
+	CorpusReader scan = *reader;
 
-	if (root == NULL)
-		return;
+	if (offset <= 0)
+		return 0;
 
-	if (root->count > 0)
-		printf("%s (%d)\n", buffer, root->count);
+	// Skip the end of a word cut by the offset
+	scan.pos = offset;
+	scan.end = scan.size;
+	while (scan.pos < scan.size && !isspace((unsigned char)scan.data[scan.pos - 1]) && !isspace((unsigned char)scan.data[scan.pos]))
+		scan.pos++;
 
-	buffer[k + 1] = '\0';
+	while (nextWord(&scan, &len, &ended) != NULL)
+	{
+		if (ended && prev_ended == 0)
+			return scan.pos;
+
+		prev_ended = ended;
+	}
+
+	return scan.size;
+}
+
+// Thread function of buildTrieParallel(): builds the trie of a shard.
+void *buildShard(void *arg)
+{
+	TrieShard *shard = arg;
+
+	shard->trie = createTrie();
+	readCorpus(shard->trie, &shard->reader, shard);
+	return NULL;
+}
+
+// Adds the words of the src (sub)trie at node s to the dest (sub)trie at
+// node d, with their subtries. A subtrie that was removed in src
+// (cleared[s]) is removed in dest before the words that src added to it
+// afterwards, and dest->cleared gets the node. The most frequent words are
+// not updated, computeBest() does it once the shards are merged.
+void mergeNode(TrieShard *dest, unsigned int d, TrieShard *src, unsigned int s, unsigned char *cleared)
+{
+	int i;
+	unsigned int child;
+	TrieNode *from = trieNode(src->trie, s), *to = trieNode(dest->trie, d);
 
 	for (i = 0; i < 26; i++)
 	{
-		buffer[k] = 'a' + i;
+		if (from->children[i] == 0)
+			continue;
+
+		child = to->children[i];
+		if (child == 0)
+		{
+			child = createTrieNode(dest->trie);
+			to->children[i] = child;
+			trieNode(dest->trie, child)->parent = d;
+		}
 
-		printTrieHelper(root->children[i], buffer, k + 1);
+		mergeNode(dest, child, src, from->children[i], cleared);
 	}
 
-	buffer[k] = '\0';
+	to->count += from->count;
+
+	if (cleared[s])
+	{
+		to->subtrie = 0;
+		addCleared(dest, d);
+	}
+
+	if (from->subtrie != 0)
+	{
+		if (to->subtrie == 0)
+			to->subtrie = createTrieNode(dest->trie);
+
+		mergeNode(dest, to->subtrie, src, from->subtrie, cleared);
+	}
 }
 
-// If printing a subtrie, the second parameter should be 1; otherwise, if
-// printing the main trie, the second parameter should be 0. (Credit: Dr. S.)
-void printTrie(TrieNode *root, int useSubtrieFormatting) 
+// Thread function of buildTrieParallel(): merges the trie of a shard into
+// the one of the shard before it and frees it.
+void *mergeShard(void *arg)
 {
-	char buffer[1026];
-	if (useSubtrieFormatting)
+	TrieShard *dest = arg, *src = dest->next;
+	unsigned char *cleared;
+	unsigned int i;
+
+	cleared = calloc(src->trie->nodeCount, 1);
+	if (cleared == NULL)
 	{
-		strcpy(buffer, "- ");
-		printTrieHelper(root, buffer, 2);
+		fprintf(stderr, "Error: could not allocate memory in mergeShard().\n");
+		exit(1);
 	}
-	else
+
+	for (i = 0; i < src->clearedCount; i++)
+		cleared[src->cleared[i]] = 1;
+
+	if (src->trie->root != 0)
 	{
-		strcpy(buffer, "");
-		printTrieHelper(root, buffer, 0);
+		if (dest->trie->root == 0)
+			dest->trie->root = createTrieNode(dest->trie);
+
+		mergeNode(dest, dest->trie->root, src, src->trie->root, cleared);
 	}
+
+	free(cleared);
+	src->trie = destroyTrie(src->trie);
+	return NULL;
 }
 
-TrieNode *buildTrie(char *filename)
+// Sets the most frequent word of every node of a (sub)trie from the leaves
+// up, the way freezeTrie() does.
+void computeBest(Trie *trie, unsigned int root)
 {
-	TrieNode *root = NULL;
-	TrieNode *last_node = NULL;
-	int i, len, sentenceEnded = 0; // 1 = true, sentence has ended
-	int word_count = 0;
-	char buffer[MAX_WORD_LENGTH + 1];
+	int i;
+	TrieNode *node = trieNode(trie, root), *child;
+
+	node->best = (node->count > 0)? root:0;
+	node->bestCount = node->count;
+
+	for (i = 0; i < 26; i++)
+	{
+		if (node->children[i] == 0)
+			continue;
+
+		computeBest(trie, node->children[i]);
+
+		child = trieNode(trie, node->children[i]);
+		if (child->bestCount > node->bestCount)
+		{
+			node->best = child->best;
+			node->bestCount = child->bestCount;
+		}
+	}
+
+	if (node->subtrie != 0)
+		computeBest(trie, node->subtrie);
+}
 
-	// Initialize the buffers that contain nothing but empty strings
-	char prev[MAX_WORD_LENGTH + 1];
-	char current[MAX_WORD_LENGTH + 1];
+// Same as buildTrie(), with the corpus split into shards at the ends of
+// sentences that are built by separate threads. The tries of the shards
+// are then merged by summing the counts, each one into the one before it,
+// which gives the same trie as buildTrie(). The merges are done in pairs
+// by separate threads too: shard 1 into 0 while 3 goes into 2, then 2 into
+// 0, and so on.
+Trie *buildTrieParallel(char *filename, int threads)
+{
+	int i, step;
+	long start;
+	TrieShard *shards;
+	CorpusReader reader;
+	Trie *trie;
 
-	FILE *ifp;
+	if (threads <= 1)
+		return buildTrie(filename);
 
-	if ((ifp = fopen(filename, "r")) == NULL)
+	if (openCorpus(&reader, filename) != 0)
 	{
-		fprintf(stderr, "Failed to open \"%s\" in buildTrie().\n", filename);
+		fprintf(stderr, "Failed to open \"%s\" in buildTrieParallel().\n", filename);
 		return NULL;
 	}
 
-	// Insert strings one-by-one into the trie.
-	while (fscanf(ifp, "%s", buffer) != EOF)
+	shards = calloc(threads, sizeof(TrieShard));
+	if (shards == NULL)
 	{
-		// New word is read & inserted, increment word_count
-		word_count++;
-
-		// Find length of string
-		len = strlen(buffer);
+		fprintf(stderr, "Error: could not allocate memory in buildTrieParallel().\n");
+		exit(1);
+	}
 
-		// Reset sentenceEnded to 0 every time when entering loop 
-		sentenceEnded = 0;
+	// Every shard reads its part of the same mapping
+	for (i = 0; i < threads; i++)
+	{
+		start = findShardStart(&reader, reader.size / threads * i);
 
-		// Check each string for punctuators '.', '?', '!'
-		for (i = 0; i < len; i++)
-			if (buffer[i] == '.' || buffer[i] == '?' || buffer[i] == '!')
-				sentenceEnded = 1;
+		// A shard that starts before the previous one is left empty
+		if (i > 0 && start < shards[i - 1].reader.pos)
+			start = shards[i - 1].reader.pos;
 
-		// Strip the string of any punctuators
-		stripPuncuators(buffer);
+		shards[i].reader = reader;
+		shards[i].reader.pos = start;
+		if (i > 0)
+			shards[i - 1].reader.end = start;
+	}
 
-		// Check what the word count is.
-		if (word_count == 1)
+	for (i = 0; i < threads; i++)
+	{
+		if (pthread_create(&shards[i].thread, NULL, buildShard, &shards[i]) != 0)
 		{
-			// simply insert the first word into the trie.
-			strcpy(current, buffer);
-			// printf("(%d)first word on line: %s\n\n", word_count, current);
-			root = insertString(root, current);
-
+			fprintf(stderr, "Error: could not start a thread in buildTrieParallel().\n");
+			exit(1);
 		}
-		else
-		{
-			// check if the word is the last in its sentence.
-			if (sentenceEnded) 
-			{	
-				// If it is the last word.
-				// simply insert the last word into the trie.
-				strcpy(current, buffer);
-				// printf("(%d)last word on line: %s\n", word_count, current);
-				root = insertString(root, current);
+	}
 
-				// Set the the terminal node of the last word's
-				// subtrie equal to NULL.
-				last_node = getNode(root, current);
-				last_node->subtrie = NULL;
+	for (i = 0; i < threads; i++)
+		pthread_join(shards[i].thread, NULL);
 
+	closeCorpus(&reader);
 
-				// Reset word_count back to zero for next line
-				word_count = 0;
-			}
-			else 
+	for (step = 1; step < threads; step *= 2)
+	{
+		for (i = 0; i + step < threads; i += 2 * step)
+		{
+			shards[i].next = &shards[i + step];
+			if (pthread_create(&shards[i].thread, NULL, mergeShard, &shards[i]) != 0)
 			{
-				// The word is not the last in the sentence.
-				// Insert it into the trie.
-				strcpy(current, buffer);
-				// printf("(%d)prev word on line: %s\n", word_count, prev);
-				// printf("(%d)current word on line: %s\n", word_count, current);
-				root = insertString(root, current);
-
-				// // Insert the word into the subtrie of the prev word.
-				last_node = getNode(root, prev);
-				if (last_node != NULL)
-				{
-					// printf("Last_node = TERMINAL NODE OF (%s)\n", prev);
-				}
-				last_node->subtrie = insertString(last_node->subtrie, current);
-				// printf("\n\n===============\n");
-				// printf("SubTrie of (%s)\n", prev);
-				// printf("===============\n\n");
-				// printTrie(last_node->subtrie, 1);
-				// printf("\n----------------\n\n");
+				fprintf(stderr, "Error: could not start a thread in buildTrieParallel().\n");
+				exit(1);
 			}
 		}
 
+		for (i = 0; i + step < threads; i += 2 * step)
+			pthread_join(shards[i].thread, NULL);
+	}
 
-		// The new word is no longer needed, now put in previous.
-		strcpy(prev, current); 
+	// Everything was merged into the first shard
+	trie = shards[0].trie;
+	if (trie->root != 0)
+		computeBest(trie, trie->root);
 
-	}
-	fclose(ifp);
-	return root;
+	for (i = 0; i < threads; i++)
+		free(shards[i].cleared);
+	free(shards);
+
+	return trie;
 }
 
-int processInputFile(TrieNode *root, char *filename) // :(
+int processInputFile(Trie *trie, char *filename) // :(
 {
 	int n, len, increment = 0;
 	int signal = 0;
 	char buffer[MAX_WORD_LENGTH];
 	char strBuffer[MAX_WORD_LENGTH + 1];
 	char digitsBuffer[MAX_WORD_LENGTH];
-	TrieNode *terminal = NULL;
+	unsigned int root = (trie == NULL)? 0:trie->root;
+	unsigned int terminal = 0;
 
 	FILE *fp;
 
@@ -476,7 +840,7 @@ int processInputFile(TrieNode *root, char *filename) // :(
 		{
 			// '!'
 			//printf("Read input.....%s\n", buffer);
-			printTrie(root, 0);
+			printTrie(trie, root, 0);
 		}
 		// String has puncuators "@ str n"
 		else if ((strcmp(buffer, "@") == 0))
@@ -489,16 +853,16 @@ int processInputFile(TrieNode *root, char *filename) // :(
 		{
 
 			
-			if (!containsWord(root, buffer))
+			if (!containsWord(trie, root, buffer))
 			{
 				printf("%s\n", buffer);
 				printf("(INVALID STRING)\n");
 			}
 			// Search for the string in the trie
-			else if(containsWord(root, buffer))
+			else if(containsWord(trie, root, buffer))
 			{
-				terminal = getNode(root, buffer);
-				if (terminal->subtrie == NULL)
+				terminal = getNode(trie, root, buffer);
+				if (trieNode(trie, terminal)->subtrie == 0)
 				{
 					printf("%s", buffer);
 					printf("(EMPTY)");
@@ -506,7 +870,7 @@ int processInputFile(TrieNode *root, char *filename) // :(
 				else 
 				{
 					printf("%s\n", buffer);
-					printTrie(terminal->subtrie, 1);
+					printTrie(trie, trieNode(trie, terminal)->subtrie, 1);
 				}					
 			}
 			// -------------------------------
@@ -516,85 +880,196 @@ int processInputFile(TrieNode *root, char *filename) // :(
 	return 0;
 }
 
-TrieNode *destroyTrie(TrieNode *root) 
+// Frees every node of the trie and of its subtries, a chunk at a time.
+Trie *destroyTrie(Trie *trie) 
 {
-	int i;
-	if (root == NULL)
+	unsigned int i;
+
+	if (trie == NULL)
 		return NULL;
 
+	for (i = 0; i < trie->chunkCount; i++)
+		free(trie->chunks[i]);
 
-	for (i = 0; i < 26; i++)
-	{
-		destroyTrie(root->children[i]);
-		
-	}
-	destroyTrie(root->subtrie);
-	free(root);
+	free(trie->chunks);
+	free(trie);
 	return NULL;
 }
 
-TrieNode *getNode(TrieNode *root, char *str) 
+unsigned int getNode(Trie *trie, unsigned int root, char *str) 
 {
-	int i;
-	int idx;
-	int len = strlen(str);
-	TrieNode *temp_root;
-	TrieNode *terminal;
+	unsigned int terminal = getPrefixNode(trie, root, str);
 
-	// Check if root passed is NULL
-	if (root == NULL)
-		return NULL;
+	// The prefix must be a word of the trie
+	if (terminal == 0 || trieNode(trie, terminal)->count < 1)
+		return 0;
 
-	// Assign root to a temporay variable
-	temp_root = root;
+	return terminal;
+}
 
-	for (i = 0; i < len; i++)
-	{
-		// Find index of children[] corresponding to character
-		idx = tolower(str[i]) - 'a';
+// Writes the most frequent word of a (sub)trie into str, the alphabetically
+// first one on ties, and returns its count (0 and "" if the trie is empty).
+// The root may also be the node of a prefix, str then gets the most
+// frequent word that starts with it.
+int getMostFrequentWord(Trie *trie, unsigned int root, char *str) // :)
+{
+	unsigned int best = (trie == NULL || root == 0)? 0:trieNode(trie, root)->best;
 
-		// Move temp_root to that index
-		temp_root = temp_root->children[idx];
+	strcpy(str, "");
+	if (best == 0)
+		return 0;
 
-		// Check its count
-		if ( temp_root->count >= 1)
-			terminal = temp_root;
-		else 
-			terminal = NULL;
+	getWord(trie, best, str);
+	return trieNode(trie, root)->bestCount;
+}
+
+// Returns the number of letters between a node and the root of its (sub)trie.
+int nodeDepth(Trie *trie, unsigned int node)
+{
+	int depth = 0;
+
+	for (; trieNode(trie, node)->parent != 0; depth++)
+		node = trieNode(trie, node)->parent;
+
+	return depth;
+}
+
+// Compares the words of two nodes of the same (sub)trie alphabetically, the
+// way strcmp() does, without spelling them: the deeper node is brought up
+// to the depth of the other one, then both go up to the letters where the
+// words part.
+int compareNodeWords(Trie *trie, unsigned int a, unsigned int b)
+{
+	int depth_a = nodeDepth(trie, a), depth_b = nodeDepth(trie, b), result = 0;
+
+	// If a word is a prefix of the other one, it comes first
+	for (; depth_a > depth_b; depth_a--, result = 1)
+		a = trieNode(trie, a)->parent;
+	for (; depth_b > depth_a; depth_b--, result = -1)
+		b = trieNode(trie, b)->parent;
+
+	if (a == b)
+		return result;
+
+	while (trieNode(trie, a)->parent != trieNode(trie, b)->parent)
+	{
+		a = trieNode(trie, a)->parent;
+		b = trieNode(trie, b)->parent;
 	}
-	return terminal;
+
+	return edgeLetter(trie, a) - edgeLetter(trie, b);
 }
 
-void getMostFrequentWord(TrieNode *root, char *str) // :(
+// Returns the node whose string starts every word of a candidate.
+unsigned int completionAnchor(Completion *candidate)
 {
-	int i; 
-	char buffer[MAX_WORD_LENGTH];
+	return (candidate->root != 0)? candidate->root:candidate->best;
+}
 
-	// Check if the root is NULL
-	if (root == NULL)
+// Adds a candidate to a list sorted from the most frequent word, keeping
+// at most capacity of them. A candidate whose word would not make the
+// list, and the rest of its subtree with it, is dropped: the words in the
+// list already come before all of them.
+//
+// The candidates never hold the same words and none is inside another
+// one, so on a tie their words come in the order of their anchors, which
+// are closer to the root than the words.
+void addCompletion(Trie *trie, Completion *list, int *size, int capacity, unsigned int root, unsigned int best, int count)
+{
+	int i;
+	unsigned int anchor = (root != 0)? root:best;
+
+	if (*size == capacity && (capacity == 0 || list[*size - 1].count > count ||
+	    (list[*size - 1].count == count && compareNodeWords(trie, completionAnchor(&list[*size - 1]), anchor) < 0)))
 		return;
 
-	// Check if the root of trie passed is empty
-	if (isSubtrieEmpty(root))
-		strcpy(str, "");
+	i = (*size < capacity)? (*size)++ : *size - 1;
+	while (i > 0 && (list[i - 1].count < count ||
+	       (list[i - 1].count == count && compareNodeWords(trie, anchor, completionAnchor(&list[i - 1])) < 0)))
+	{
+		list[i] = list[i - 1];
+		i--;
+	}
+
+	list[i].root = root;
+	list[i].best = best;
+	list[i].count = count;
+}
+
+// Adds the subtree of a child to the list of candidates.
+void addChildCompletion(Trie *trie, Completion *list, int *size, int capacity, unsigned int child)
+{
+	TrieNode *node = trieNode(trie, child);
+
+	addCompletion(trie, list, size, capacity, child, node->best, node->bestCount);
+}
+
+// Writes the terminal nodes of the k most frequent words of a (sub)trie or
+// of the words starting with a prefix into words[], most frequent first and
+// alphabetically on ties, and returns how many there are (at most k, and at
+// most MAX_COMPLETIONS). getWord() spells them.
+//
+// The list starts with the whole subtree, whose best word is known. The
+// best candidate of the list is taken out and its word is the next one.
+// The rest of its subtree is split into the words on the path down to that
+// word, the subtrees beside the path and the subtrees below the word, and
+// those go into the list, each with its own best word.
+int getMostFrequentWords(Trie *trie, unsigned int root, int k, unsigned int *words)
+{
+	int i, size = 0, found = 0;
+	unsigned int child, parent;
+	Completion list[MAX_COMPLETIONS], top;
+	TrieNode *node;
+
+	if (k > MAX_COMPLETIONS)
+		k = MAX_COMPLETIONS;
+
+	if (trie == NULL || root == 0 || k <= 0 || trieNode(trie, root)->best == 0)
+		return 0;
+
+	addCompletion(trie, list, &size, k, root, trieNode(trie, root)->best, trieNode(trie, root)->bestCount);
+
+	while (size > 0 && found < k)
+	{
+		top = list[0];
+		memmove(list, list + 1, sizeof(Completion) * --size);
+		words[found++] = top.best;
+
+		// A candidate without root is a single word
+		if (top.root == 0)
+			continue;
 
-	// First Check if the str passed is NON-empty.
-	if (strcmp(str, "") != 0)
-		strcpy(str, "");
+		node = trieNode(trie, top.best);
+		for (i = 0; i < 26; i++)
+			if (node->children[i] != 0)
+				addChildCompletion(trie, list, &size, k - found, node->children[i]);
 
-	getMostFreqHelper(root, str, buffer, 0, 0);
-	printf("Most Frequent Word: %s\n", str);
+		for (child = top.best; child != top.root; child = parent)
+		{
+			parent = trieNode(trie, child)->parent;
+			node = trieNode(trie, parent);
+
+			if (node->count > 0)
+				addCompletion(trie, list, &size, k - found, 0, parent, node->count);
+
+			for (i = 0; i < 26; i++)
+				if (node->children[i] != 0 && node->children[i] != child)
+					addChildCompletion(trie, list, &size, k - found, node->children[i]);
+		}
+	}
+
+	return found;
 }
 
-int containsWord(TrieNode *root, char *str) 
+int containsWord(Trie *trie, unsigned int root, char *str) 
 {
-	TrieNode *last = getNode(root, str);
-	return ( last == NULL)? 0:1;
+	unsigned int last = getNode(trie, root, str);
+	return ( last == 0)? 0:1;
 }
 
-int prefixCount(TrieNode *root, char *str) 
+int prefixCount(Trie *trie, unsigned int root, char *str) 
 {
-	TrieNode *wizard, *terminal = NULL;
+	unsigned int wizard, terminal = 0;
 	int i;
 	int len = strlen(str);
 	int index;
@@ -608,13 +1083,13 @@ int prefixCount(TrieNode *root, char *str)
 	char *aux = malloc(sizeof(char) * len);
 
 	//Check if the word itself is contained in the trie.
-	if (containsWord(wizard, str))
+	if (containsWord(trie, wizard, str))
 	{
-		terminal = getNode(wizard, str);
-		count += terminal->count;
+		terminal = getNode(trie, wizard, str);
+		count += trieNode(trie, terminal)->count;
 
 		// Now check the last node and test for any active children
-		prefix_branches = activeChildren(terminal);
+		prefix_branches = activeChildren(trieNode(trie, terminal));
 		// If there are no active children,
 		// This word that is contained is the only common prefix 
 		// It is not shared with any other words, return its count.
@@ -638,7 +1113,7 @@ int prefixCount(TrieNode *root, char *str)
 			// Find the corresponding index for each prefix character.
 			index = tolower(str[i]) - 'a';
 
-			if (wizard->children[index] == NULL)
+			if (wizard == 0 || trieNode(trie, wizard)->children[index] == 0)
 			{
 				count = 0;
 				printf("prefix(%s) NOT FOUND.\n", str);
@@ -651,8 +1126,8 @@ int prefixCount(TrieNode *root, char *str)
 			// Add to the count and return it.
 			if (i == (len - 1))
 			{
-				terminal = getPrefixNode(root, str);
-				if (activeChildren(terminal) == 1)
+				terminal = getPrefixNode(trie, root, str);
+				if (terminal != 0 && activeChildren(trieNode(trie, terminal)) == 1)
 				{
 					count += 1;
 					break;
@@ -661,11 +1136,11 @@ int prefixCount(TrieNode *root, char *str)
 
 			// Continue entering this loop while the node at index exists
 			// And its count value is equal to zero.
-			while (wizard->children[index] != NULL &&  wizard->children[index]->count < 1)
+			while (trieNode(trie, wizard)->children[index] != 0 &&  trieNode(trie, trieNode(trie, wizard)->children[index])->count < 1)
 			{
 
-				// Find its number of active (NON-NULL) children nodes
-				prefix_branches = activeChildren(wizard->children[index]);
+				// Find its number of active (NON-ZERO) children nodes
+				prefix_branches = activeChildren(trieNode(trie, trieNode(trie, wizard)->children[index]));
 
 				// If the number of active child nodes exceeds 1, 
 				// Then we know that there are multiple words that
@@ -677,7 +1152,7 @@ int prefixCount(TrieNode *root, char *str)
 				}
 				else 
 					// Move the temporary root to the prefix character node
-					wizard = wizard->children[index];
+					wizard = trieNode(trie, wizard)->children[index];
 
 			}
 		}
@@ -687,10 +1162,349 @@ int prefixCount(TrieNode *root, char *str)
 	return count;
 }
 
+// Sets the best word of a node from those of its children, which are
+// known. The node itself comes first alphabetically, then its children in
+// the order of their letters, so only a higher count replaces a word.
+void setCompactBest(CompactTrie *trie, unsigned int at)
+{
+	int i;
+	CompactTrieNode *node = &trie->nodes[at], *child;
+
+	node->best = (node->count > 0)? at:0;
+	node->bestCount = node->count;
+
+	for (i = 0; i < __builtin_popcount(node->childMask); i++)
+	{
+		child = &trie->nodes[node->firstChild + i];
+		if (child->bestCount > node->bestCount)
+		{
+			node->best = child->best;
+			node->bestCount = child->bestCount;
+		}
+	}
+}
+
+// Copies a node into trie->nodes[at]. The children are given the next
+// free indices as a block, then each of them is copied with its own
+// children, so a node and its children end up close together.
+void freezeNode(Trie *source, unsigned int source_node, CompactTrie *trie, unsigned int at, unsigned int *order)
+{
+	int i;
+	unsigned int next;
+	TrieNode *node = trieNode(source, source_node);
+	CompactTrieNode *compact = &trie->nodes[at];
+
+	compact->count = node->count;
+	compact->childMask = 0;
+	compact->firstChild = trie->nodeCount;
+	compact->subtrie = 0;
+	compact->order = (*order)++;
+
+	for (i = 0; i < 26; i++)
+	{
+		if (node->children[i] != 0)
+		{
+			compact->childMask |= 1u << i;
+			trie->nodeCount++;
+		}
+	}
+
+	if (node->subtrie != 0)
+		compact->subtrie = trie->nodeCount++;
+
+	next = compact->firstChild;
+	for (i = 0; i < 26; i++)
+	{
+		if (node->children[i] != 0)
+		{
+			trie->nodes[next].parent = at;
+			freezeNode(source, node->children[i], trie, next++, order);
+		}
+	}
+
+	if (node->subtrie != 0)
+		freezeNode(source, node->subtrie, trie, trie->nodes[at].subtrie, order);
+
+	setCompactBest(trie, at);
+}
+
+// Converts a trie built by buildTrie() into its compact read-only form.
+// The nodes of the main trie and of every subtrie go into one array,
+// sizeof(CompactTrieNode) bytes each instead of sizeof(TrieNode). The
+// trie passed is not changed, it can be destroyed afterwards.
+CompactTrie *freezeTrie(Trie *source)
+{
+	CompactTrie *trie = malloc(sizeof(CompactTrie));
+	unsigned int order = 0;
+
+	if (trie == NULL)
+		return NULL;
+
+	// Every node is reached from the root, so source->nodeCount indices
+	// are enough, with one more when the source trie is empty.
+	trie->nodes = calloc(source->nodeCount + 1, sizeof(CompactTrieNode));
+	if (trie->nodes == NULL)
+	{
+		free(trie);
+		return NULL;
+	}
+
+	// An empty trie is a root without children or count.
+	trie->nodeCount = 2;
+	if (source->root != 0)
+		freezeNode(source, source->root, trie, 1, &order);
+
+	return trie;
+}
+
+CompactTrie *destroyCompactTrie(CompactTrie *trie)
+{
+	if (trie == NULL)
+		return NULL;
+
+	free(trie->nodes);
+	free(trie);
+	return NULL;
+}
+
+// Returns the index of the node of a prefix, whether or not a word ends
+// there, or 0 if no word starts with it.
+unsigned int getCompactPrefixNode(CompactTrie *trie, unsigned int root, char *str)
+{
+	int i, idx;
+	unsigned int mask;
+
+	for (i = 0; root != 0 && str[i] != '\0'; i++)
+	{
+		if (!isalpha(str[i]))
+			return 0;
+
+		idx = tolower(str[i]) - 'a';
+		mask = trie->nodes[root].childMask;
+
+		if (!(mask & (1u << idx)))
+			return 0;
+
+		root = trie->nodes[root].firstChild + __builtin_popcount(mask & ((1u << idx) - 1));
+	}
+	return root;
+}
+
+// Same as getNode(): returns the index of the terminal node of str, or 0
+// if str is not a word of the trie.
+unsigned int getCompactNode(CompactTrie *trie, unsigned int root, char *str)
+{
+	unsigned int terminal = getCompactPrefixNode(trie, root, str);
+
+	return (terminal != 0 && trie->nodes[terminal].count >= 1) ? terminal : 0;
+}
+
+int containsCompactWord(CompactTrie *trie, unsigned int root, char *str)
+{
+	return (getCompactNode(trie, root, str) == 0) ? 0 : 1;
+}
+
+// Counts the words in the subtree of a node, the node itself included.
+int countCompactStrings(CompactTrie *trie, unsigned int root)
+{
+	int i, count;
+	CompactTrieNode *node = &trie->nodes[root];
+
+	count = (node->count > 0) ? 1 : 0;
+
+	for (i = 0; i < __builtin_popcount(node->childMask); i++)
+		count += countCompactStrings(trie, node->firstChild + i);
+
+	return count;
+}
+
+// Counts the distinct words that begin with str, str included if it is a
+// word itself.
+int compactPrefixCount(CompactTrie *trie, unsigned int root, char *str)
+{
+	unsigned int prefix = getCompactPrefixNode(trie, root, str);
+
+	return (prefix == 0) ? 0 : countCompactStrings(trie, prefix);
+}
+
+// Helper function called by printCompactTrie(), same as printTrieHelper().
+void printCompactTrieHelper(CompactTrie *trie, unsigned int root, char *buffer, int k)
+{
+	int i;
+	unsigned int child;
+	CompactTrieNode *node = &trie->nodes[root];
+
+	if (node->count > 0)
+		printf("%s (%d)\n", buffer, node->count);
+
+	buffer[k + 1] = '\0';
+
+	child = node->firstChild;
+	for (i = 0; i < 26; i++)
+	{
+		if (node->childMask & (1u << i))
+		{
+			buffer[k] = 'a' + i;
+			printCompactTrieHelper(trie, child++, buffer, k + 1);
+		}
+	}
+
+	buffer[k] = '\0';
+}
+
+// Returns the letter of the edge between a node and its parent: the one
+// of its bit in the mask of the parent, found by counting older siblings.
+char compactEdgeLetter(CompactTrie *trie, unsigned int node)
+{
+	CompactTrieNode *parent = &trie->nodes[trie->nodes[node].parent];
+	unsigned int mask = parent->childMask;
+	int rank = node - parent->firstChild;
+
+	// Drop the lowest set bits of the older siblings
+	while (rank-- > 0)
+		mask &= mask - 1;
+
+	return 'a' + __builtin_ctz(mask);
+}
+
+// Same as getWord().
+void getCompactWord(CompactTrie *trie, unsigned int node, char *str)
+{
+	int i, len = 0;
+	char letter;
+
+	while (trie->nodes[node].parent != 0)
+	{
+		str[len++] = compactEdgeLetter(trie, node);
+		node = trie->nodes[node].parent;
+	}
+	str[len] = '\0';
+
+	for (i = 0; i < len / 2; i++)
+	{
+		letter = str[i];
+		str[i] = str[len - 1 - i];
+		str[len - 1 - i] = letter;
+	}
+}
+
+// Same as getMostFrequentWord().
+int getMostFrequentCompactWord(CompactTrie *trie, unsigned int root, char *str)
+{
+	unsigned int best = (root == 0)? 0:trie->nodes[root].best;
+
+	strcpy(str, "");
+	if (best == 0)
+		return 0;
+
+	getCompactWord(trie, best, str);
+	return trie->nodes[root].bestCount;
+}
+
+// Same as compareNodeWords(), the order of the nodes gives it directly.
+int compareCompactNodeWords(CompactTrie *trie, unsigned int a, unsigned int b)
+{
+	return (trie->nodes[a].order > trie->nodes[b].order) - (trie->nodes[a].order < trie->nodes[b].order);
+}
+
+// Same as addCompletion().
+void addCompactCompletion(CompactTrie *trie, Completion *list, int *size, int capacity, unsigned int root, unsigned int best, int count)
+{
+	int i;
+
+	if (*size == capacity && (capacity == 0 || list[*size - 1].count > count ||
+	    (list[*size - 1].count == count && compareCompactNodeWords(trie, list[*size - 1].best, best) < 0)))
+		return;
+
+	i = (*size < capacity)? (*size)++ : *size - 1;
+	while (i > 0 && (list[i - 1].count < count ||
+	       (list[i - 1].count == count && compareCompactNodeWords(trie, best, list[i - 1].best) < 0)))
+	{
+		list[i] = list[i - 1];
+		i--;
+	}
+
+	list[i].root = root;
+	list[i].best = best;
+	list[i].count = count;
+}
+
+// Same as getMostFrequentWords().
+int getMostFrequentCompactWords(CompactTrie *trie, unsigned int root, int k, unsigned int *words)
+{
+	int i, size = 0, found = 0;
+	unsigned int child, parent, next;
+	Completion list[MAX_COMPLETIONS], top;
+	CompactTrieNode *node;
+
+	if (k > MAX_COMPLETIONS)
+		k = MAX_COMPLETIONS;
+
+	if (root == 0 || k <= 0 || trie->nodes[root].best == 0)
+		return 0;
+
+	addCompactCompletion(trie, list, &size, k, root, trie->nodes[root].best, trie->nodes[root].bestCount);
+
+	while (size > 0 && found < k)
+	{
+		top = list[0];
+		memmove(list, list + 1, sizeof(Completion) * --size);
+		words[found++] = top.best;
+
+		if (top.root == 0)
+			continue;
+
+		node = &trie->nodes[top.best];
+		for (i = 0; i < __builtin_popcount(node->childMask); i++)
+		{
+			next = node->firstChild + i;
+			addCompactCompletion(trie, list, &size, k - found, next, trie->nodes[next].best, trie->nodes[next].bestCount);
+		}
+
+		for (child = top.best; child != top.root; child = parent)
+		{
+			parent = trie->nodes[child].parent;
+			node = &trie->nodes[parent];
+
+			if (node->count > 0)
+				addCompactCompletion(trie, list, &size, k - found, 0, parent, node->count);
+
+			for (i = 0; i < __builtin_popcount(node->childMask); i++)
+			{
+				next = node->firstChild + i;
+				if (next != child)
+					addCompactCompletion(trie, list, &size, k - found, next, trie->nodes[next].best, trie->nodes[next].bestCount);
+			}
+		}
+	}
+
+	return found;
+}
+
+// Prints the same lines as printTrie() for the trie rooted at the given index.
+void printCompactTrie(CompactTrie *trie, unsigned int root, int useSubtrieFormatting)
+{
+	char buffer[1026];
+
+	if (root == 0)
+		return;
+
+	if (useSubtrieFormatting)
+	{
+		strcpy(buffer, "- ");
+		printCompactTrieHelper(trie, root, buffer, 2);
+	}
+	else
+	{
+		strcpy(buffer, "");
+		printCompactTrieHelper(trie, root, buffer, 0);
+	}
+}
+
 int main(int argc, char **argv)
 {
 
-	TrieNode *root = NULL, *last_node;
+	Trie *trie = NULL;
 	char corpus[100];
 	char input[100];
 	int result;
@@ -703,8 +1517,9 @@ int main(int argc, char **argv)
 	strcpy(corpus, argv[1]);
 	strcpy(input, argv[2]);
 
-	root = buildTrie(corpus);
-	result = processInputFile(root, input);
-	root = destroyTrie(root);
+	// An optional third argument builds the trie with that many threads
+	trie = (argc > 3)? buildTrieParallel(corpus, atoi(argv[3])):buildTrie(corpus);
+	result = processInputFile(trie, input);
+	trie = destroyTrie(trie);
 	return 0;
 }
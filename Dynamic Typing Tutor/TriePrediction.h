@@ -1,8 +1,14 @@
 #ifndef __TRIE_PREDICTION_H
 #define __TRIE_PREDICTION_H
 
+#include <stdio.h>
+#include <pthread.h>
+
 #define MAX_WORDS_PER_LINE 30
 #define MAX_CHARACTERS_PER_WORD 1023
+#define TRIE_CHUNK_BITS 12
+#define TRIE_CHUNK_NODES (1u << TRIE_CHUNK_BITS)
+#define MAX_COMPLETIONS 64
 
 
 // Magic Unit Test Directive
@@ -18,34 +24,190 @@
 //#define main __hidden_main__
 
 
+// Nodes refer to each other by their index in the Trie that owns them.
+// Index 0 is never given to a node, so it means "no node".
 typedef struct TrieNode
 {
 	// number of times this string occurs in the corpus
 	int count;
 
-	// 26 TrieNode pointers, one for each letter of the alphabet
-	struct TrieNode *children[26];
+	// 26 node indices, one for each letter of the alphabet
+	unsigned int children[26];
 
 	// the co-occurrence subtrie for this string
-	struct TrieNode *subtrie;
+	unsigned int subtrie;
+
+	// the node this one is a child of, 0 for the root of a (sub)trie
+	unsigned int parent;
+
+	// the terminal node of the most frequent word starting with this
+	// string (the alphabetically first on ties), 0 if there is none
+	unsigned int best;
+
+	// the count of that word
+	int bestCount;
 } TrieNode;
 
+// The nodes of a trie and of all of its co-occurrence subtries, allocated
+// TRIE_CHUNK_NODES at a time. A chunk never moves, so a TrieNode pointer
+// stays valid while nodes are added.
+typedef struct Trie
+{
+	TrieNode **chunks;
+	unsigned int chunkCount;
+	unsigned int chunkCapacity;
+
+	// number of indices given out, including the unused index 0
+	unsigned int nodeCount;
+
+	// index of the root of the main trie, 0 if the trie is empty
+	unsigned int root;
+} Trie;
+
+// Read-only form of a trie and all of its subtries, made by freezeTrie().
+// The children of a node are stored next to each other in alphabetical
+// order, so a node only keeps the index of the first one and a bit per
+// letter. The child for a letter is found by counting the bits below it.
+typedef struct CompactTrieNode
+{
+	// number of times this string occurs in the corpus
+	int count;
+
+	// bit i is set if the node has a child for the letter 'a' + i
+	unsigned int childMask;
+
+	// index of the first child
+	unsigned int firstChild;
+
+	// index of the root of the co-occurrence subtrie, 0 if there is none
+	unsigned int subtrie;
+
+	// same as in TrieNode
+	unsigned int parent;
+	unsigned int best;
+	int bestCount;
+
+	// rank of the node in the alphabetical order of the words of its
+	// (sub)trie, so that two words are compared without spelling them
+	unsigned int order;
+} CompactTrieNode;
+
+typedef struct CompactTrie
+{
+	// nodes[0] is not used, so that index 0 means "no node"; the root of
+	// the main trie is nodes[1]
+	CompactTrieNode *nodes;
+	unsigned int nodeCount;
+} CompactTrie;
+
+// A corpus file mapped into memory by openCorpus(), read a word at a time
+// by nextWord().
+typedef struct CorpusReader
+{
+	char *data;
+	long size;
+
+	// offset of the next character to read, and of the end of the part
+	// to read
+	long pos;
+	long end;
+} CorpusReader;
+
+// A part of the corpus read by one of the threads of buildTrieParallel().
+typedef struct TrieShard
+{
+	CorpusReader reader;
+
+	Trie *trie;
+	pthread_t thread;
+
+	// the nodes whose subtrie was removed, because their word ended a
+	// sentence (the same node may be listed more than once)
+	unsigned int *cleared;
+	unsigned int clearedCount;
+	unsigned int clearedCapacity;
+
+	// the shard to merge into this one
+	struct TrieShard *next;
+} TrieShard;
+
+// A subtree whose words have not been ranked yet by getMostFrequentWords(),
+// or a single word if root is 0.
+typedef struct Completion
+{
+	unsigned int root;
+
+	// the most frequent word of the subtree, and its count
+	unsigned int best;
+	int count;
+} Completion;
+
 
 // Functional Prototypes
 
-TrieNode *buildTrie(char *filename);
+Trie *createTrie(void);
+
+TrieNode *trieNode(Trie *trie, unsigned int node);
+
+unsigned int insertString(Trie *trie, unsigned int root, char *str);
+
+Trie *buildTrie(char *filename);
+
+Trie *buildTrieParallel(char *filename, int threads);
+
+int openCorpus(CorpusReader *reader, char *filename);
+
+void closeCorpus(CorpusReader *reader);
+
+char *nextWord(CorpusReader *reader, int *len, int *sentenceEnded);
+
+void readCorpus(Trie *trie, CorpusReader *reader, TrieShard *shard);
+
+unsigned int insertWord(Trie *trie, unsigned int *root, char *word, int len);
+
+void computeBest(Trie *trie, unsigned int root);
+
+int processInputFile(Trie *trie, char *filename);
+
+Trie *destroyTrie(Trie *trie);
+
+unsigned int getNode(Trie *trie, unsigned int root, char *str);
+
+unsigned int getPrefixNode(Trie *trie, unsigned int root, char *str);
+
+int getMostFrequentWord(Trie *trie, unsigned int root, char *str);
+
+int getMostFrequentWords(Trie *trie, unsigned int root, int k, unsigned int *words);
+
+void getWord(Trie *trie, unsigned int node, char *str);
+
+int containsWord(Trie *trie, unsigned int root, char *str);
+
+int prefixCount(Trie *trie, unsigned int root, char *str);
+
+void printTrie(Trie *trie, unsigned int root, int useSubtrieFormatting);
+
+CompactTrie *freezeTrie(Trie *trie);
+
+CompactTrie *destroyCompactTrie(CompactTrie *trie);
+
+unsigned int getCompactNode(CompactTrie *trie, unsigned int root, char *str);
+
+unsigned int getCompactPrefixNode(CompactTrie *trie, unsigned int root, char *str);
+
+int containsCompactWord(CompactTrie *trie, unsigned int root, char *str);
 
-int processInputFile(TrieNode *root, char *filename);
+int compactPrefixCount(CompactTrie *trie, unsigned int root, char *str);
 
-TrieNode *destroyTrie(TrieNode *root);
+int getMostFrequentCompactWord(CompactTrie *trie, unsigned int root, char *str);
 
-TrieNode *getNode(TrieNode *root, char *str);
+int getMostFrequentCompactWords(CompactTrie *trie, unsigned int root, int k, unsigned int *words);
 
-void getMostFrequentWord(TrieNode *root, char *str);
+void getCompactWord(CompactTrie *trie, unsigned int node, char *str);
 
-int containsWord(TrieNode *root, char *str);
+void printCompactTrie(CompactTrie *trie, unsigned int root, int useSubtrieFormatting);
 
-int prefixCount(TrieNode *root, char *str);
+int countStrings(Trie *trie, unsigned int root);
 
 double difficultyRating(void);
 
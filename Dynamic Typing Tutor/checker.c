@@ -1,42 +1,181 @@
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdbool.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <unistd.h>
 
-#define CONSOLE_INPUT_LENGTH 64 // Standart input buffer max length
-#define MAX_DIST_ALLOWED 3      // Maximum edit distance allowed for 2 words to be considered similar
-#define SUBSTITUTION_COST 1     // Distance value for substitution. For Levenshtein Distance, change this setting to 2
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "checker.h"
 
 const char hashedDictFile[] = "dictionary.bin";                             // Hashed Dictionary File
+SearchMode_t searchMode = SEARCH_BKTREE;                                    // Strategy used by findMostSimilarWord
+int deleteIndexDistance = SYMSPELL_MAX_DELETES;                             // Deletions per word for new deletion indexes, 0 disables them
+SearchPool_t* searchPool = NULL;                                            // Threads used by SEARCH_PARALLEL, created once in main
+DistanceMetric_t distanceMetric = METRIC_UNIT;                              // Distance the words are ranked by
+SuggestionCache_t* suggestionCache = NULL;                                  // Corrections of the words checked before, NULL if disabled
+atomic_uint lastTableGeneration = 0;                                        // Generation of the most recently created HashTable
+const char wordLogFile[] = "dictionary.log";                                // Words added at run time, replayed on every start
+
+// Position of every letter on a QWERTY keyboard: its row, and twice its
+// column plus its row. The rows are staggered by about half a key, so keys
+// next to each other are 2 apart on the same row and 1 apart between rows.
+#define KEY_q 0, 0
+#define KEY_w 0, 2
+#define KEY_e 0, 4
+#define KEY_r 0, 6
+#define KEY_t 0, 8
+#define KEY_y 0, 10
+#define KEY_u 0, 12
+#define KEY_i 0, 14
+#define KEY_o 0, 16
+#define KEY_p 0, 18
+#define KEY_a 1, 1
+#define KEY_s 1, 3
+#define KEY_d 1, 5
+#define KEY_f 1, 7
+#define KEY_g 1, 9
+#define KEY_h 1, 11
+#define KEY_j 1, 13
+#define KEY_k 1, 15
+#define KEY_l 1, 17
+#define KEY_z 2, 2
+#define KEY_x 2, 4
+#define KEY_c 2, 6
+#define KEY_v 2, 8
+#define KEY_b 2, 10
+#define KEY_n 2, 12
+#define KEY_m 2, 14
+
+#define KEY_DIFF(a, b) ((a) > (b) ? (a) - (b) : (b) - (a))
+#define KEY_COST_AT(row1, x1, row2, x2) \
+    (((row1) == (row2) && (x1) == (x2)) ? 0 : \
+     (((row1) == (row2) && KEY_DIFF(x1, x2) == 2) || (KEY_DIFF(row1, row2) == 1 && KEY_DIFF(x1, x2) == 1)) ? KEY_COST_SLIP : KEY_COST_UNIT)
+#define KEY_COST_OF(pos1, pos2) KEY_COST_AT(pos1, pos2)
+#define KEY_COST(from, to) KEY_COST_OF(KEY_##from, KEY_##to)
+#define KEY_COST_ROW(from) \
+    KEY_COST(from, a), KEY_COST(from, b), KEY_COST(from, c), KEY_COST(from, d), KEY_COST(from, e), KEY_COST(from, f), \
+    KEY_COST(from, g), KEY_COST(from, h), KEY_COST(from, i), KEY_COST(from, j), KEY_COST(from, k), KEY_COST(from, l), \
+    KEY_COST(from, m), KEY_COST(from, n), KEY_COST(from, o), KEY_COST(from, p), KEY_COST(from, q), KEY_COST(from, r), \
+    KEY_COST(from, s), KEY_COST(from, t), KEY_COST(from, u), KEY_COST(from, v), KEY_COST(from, w), KEY_COST(from, x), \
+    KEY_COST(from, y), KEY_COST(from, z)
+
+// Cost of typing the second letter instead of the first, at [first * 26 + second].
+// The compiler evaluates every entry, nothing is computed at run time.
+const unsigned char keyboardCosts[26 * 26] = {
+    KEY_COST_ROW(a), KEY_COST_ROW(b), KEY_COST_ROW(c), KEY_COST_ROW(d), KEY_COST_ROW(e), KEY_COST_ROW(f), KEY_COST_ROW(g),
+    KEY_COST_ROW(h), KEY_COST_ROW(i), KEY_COST_ROW(j), KEY_COST_ROW(k), KEY_COST_ROW(l), KEY_COST_ROW(m), KEY_COST_ROW(n),
+    KEY_COST_ROW(o), KEY_COST_ROW(p), KEY_COST_ROW(q), KEY_COST_ROW(r), KEY_COST_ROW(s), KEY_COST_ROW(t), KEY_COST_ROW(u),
+    KEY_COST_ROW(v), KEY_COST_ROW(w), KEY_COST_ROW(x), KEY_COST_ROW(y), KEY_COST_ROW(z)
+};
+
+int main(int argc, char** argv) {
+
+    //      PARSING COMMAND LINE OPTIONS
+    char* convertFrom = NULL;
+    char* convertTo = NULL;
+    char* batchFile = NULL;
+    char* dawgFile = NULL;
+    OutputFormat_t outputFormat = OUTPUT_TEXT;
+    int suggestionCount = 1;
+    int cacheSize = SUGGESTION_CACHE_SIZE;
+    int threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+    int arg;
+    for(arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "--linear") == 0) {
+            searchMode = SEARCH_LINEAR;
+        } else if(strcmp(argv[arg], "--bktree") == 0) {
+            searchMode = SEARCH_BKTREE;
+        } else if(strcmp(argv[arg], "--symspell") == 0) {
+            searchMode = SEARCH_SYMSPELL;
+        } else if(strcmp(argv[arg], "--parallel") == 0) {
+            searchMode = SEARCH_PARALLEL;
+        } else if(strcmp(argv[arg], "--qgram") == 0) {
+            searchMode = SEARCH_QGRAM;
+        } else if(strcmp(argv[arg], "--keyboard") == 0) {
+            distanceMetric = METRIC_KEYBOARD;
+        } else if(strcmp(argv[arg], "--damerau") == 0) {
+            distanceMetric = METRIC_DAMERAU;
+        } else if(strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc) {
+            threadCount = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--deletes") == 0 && arg + 1 < argc) {
+            deleteIndexDistance = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--convert") == 0 && arg + 2 < argc) {
+            convertFrom = argv[++arg];
+            convertTo = argv[++arg];
+        } else if(strcmp(argv[arg], "--cache") == 0 && arg + 1 < argc) {
+            cacheSize = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--suggestions") == 0 && arg + 1 < argc) {
+            suggestionCount = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--batch") == 0 && arg + 1 < argc) {
+            batchFile = argv[++arg];
+        } else if(strcmp(argv[arg], "--dawg") == 0 && arg + 1 < argc) {
+            dawgFile = argv[++arg];
+        } else if(strcmp(argv[arg], "--format") == 0 && arg + 1 < argc && strcmp(argv[arg + 1], "text") == 0) {
+            outputFormat = OUTPUT_TEXT;
+            arg++;
+        } else if(strcmp(argv[arg], "--format") == 0 && arg + 1 < argc && strcmp(argv[arg + 1], "json") == 0) {
+            outputFormat = OUTPUT_JSON;
+            arg++;
+        } else {
+            printf("Usage: %s [--linear | --bktree | --symspell | --parallel | --qgram] [--keyboard | --damerau] [--threads N] [--deletes N] [--convert OLD.bin NEW.bin]\n"
+                   "       [--batch FILE | --batch -] [--format text | --format json] [--suggestions N] [--cache N] [--dawg FILE]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
 
-typedef struct {
+    //      CONVERTING A DICTIONARY FILE TO THE CURRENT FORMAT
+    if(convertFrom != NULL) {
+        FILE* fOld = fopen(convertFrom, "rb");
 
-    char** table;
-    int size;
+        if(fOld == NULL) {
+            printf("ERROR: Could not read file: %s\n", convertFrom);
+            return EXIT_FAILURE;
+        }
 
-} HashTable_t;
+        HashTable_t* converted = hashTableLoadFromBinary(fOld);
+        fclose(fOld);
 
-HashTable_t* hashTableLoadFromText(FILE* fp);                               // Returns the given ASCII formatted dictionary file as a hashtable in memory
-HashTable_t* hashTableLoadFromBinary(FILE* fp);                             // Copies a given hashtable binary file into memory and returns its pointer
-void hashTableFree(HashTable_t* hm);                                        // Deallocates a hashtable
-void hashTableSaveAsBinary(HashTable_t* hashTable, const char* filePath);   // Saves the given hashtable into the disk as a binary file
-int hashTableFindKey(HashTable_t* hashTable, char* key, int keyLen);        // Finds and returns the index of the given key in the hashtable, or -1 if the key does not exist
-int hashTableCalculateOptimalSize(int numberOfElements);                    // Determines the size that the hashtable should have to store the given number of elements
-int hashTableGetHash(HashTable_t* hashTable, char* key, int keyLen);        // Returns the hash value of the given key in the hashtable
+        if(converted->deleteIndex == NULL && deleteIndexDistance > 0) {
+            converted->deleteIndex = deleteIndexBuild(converted, deleteIndexDistance);
+        }
+        if(converted->qgramIndex == NULL) {
+            converted->qgramIndex = qgramIndexBuild(converted);
+        }
+        hashTableSaveAsBinary(converted, convertTo);
+        hashTableFree(converted);
 
-int getLineCount(FILE* fp);                                     // Returns the number of lines in the given file
+        printf("Dictionary has been converted: %s\n", convertTo);
+        return 0;
+    }
 
-int getMin(int x, int y, int z);                                // Returns the smallest number among the 3 given numbers
-bool isPrime(int x);                                            // Returns true if the given number is a prime, false otherwise.
-bool hasInvalidChars(char* string);                             // Returns true if the given string has characters other than a-z, false otherwise
-void toLower(char string[], int len);                           // Converts all characters to lowercase
+    //      CHECKING WITH THE WORD AUTOMATON
+    // The automaton replaces the hashtable and its indexes, it is built
+    // from the dictionary file once and mapped afterwards.
+    if(dawgFile != NULL) {
+        if(batchFile != NULL || distanceMetric == METRIC_KEYBOARD) {
+            printf("ERROR: --dawg only checks words typed in, with the unit or the Damerau metric.\n");
+            return EXIT_FAILURE;
+        }
 
-short findMostSimilarWord(HashTable_t* hashTable, char* key, char** wordFound);     // Finds the most similar word in the table to the given string using EditDistance algorithm
-short getEditDistance(char* str1, char* str2);                                      // Returns the edit distance value between 2 given strings
-char* getEditPath(char* str1, char* str2);                                          // Returns the shortest transformation path between 2 given strings
-short** getEditDistanceMatrix(char* str1, short len1, char* str2, short len2);      // Returns the edit distance matrix for 2 given strings
+        Dawg_t* dawg = dawgOpen(dawgFile, hashedDictFile);
 
-int main() {
+        if(dawg == NULL) {
+            return EXIT_FAILURE;
+        }
+        dawgCheckInput(dawg);
+        dawgFree(dawg);
+        return 0;
+    }
 
     //      CREATING DICTIONARY HASHTABLE
     FILE* fDictHashed = fopen(hashedDictFile, "rb");
@@ -71,13 +210,78 @@ int main() {
         hashedDict = hashTableLoadFromBinary(fDictHashed);
 
         fclose(fDictHashed);
+
+        bool outdated = (hashedDict->mapping == NULL);
+
+        // Files saved without a deletion index get one, so it is only built once.
+        if(searchMode == SEARCH_SYMSPELL && hashedDict->deleteIndex == NULL && deleteIndexDistance > 0) {
+            hashedDict->deleteIndex = deleteIndexBuild(hashedDict, deleteIndexDistance);
+            outdated = true;
+        }
+        if(searchMode == SEARCH_QGRAM && hashedDict->qgramIndex == NULL) {
+            hashedDict->qgramIndex = qgramIndexBuild(hashedDict);
+            outdated = true;
+        }
+
+        // Files of older versions are rewritten, so the next start can map them.
+        if(outdated) {
+            hashTableSaveAsBinary(hashedDict, hashedDictFile);
+        }
+    }
+
+    // Words added in earlier sessions, saved into the dictionary file once there are enough of them.
+    int loggedWords = wordLogReplay(hashedDict, wordLogFile);
+
+    if(loggedWords >= WORD_LOG_COMPACT_SIZE) {
+        wordLogCompact(hashedDict, hashedDictFile, wordLogFile);
+        loggedWords = 0;
+    }
+
+    if(searchMode == SEARCH_PARALLEL) {
+        searchPool = searchPoolCreate(threadCount > 0 ? threadCount : 1);
+    }
+
+    //      CHECKING A WHOLE FILE OR THE STANDARD INPUT
+    if(batchFile != NULL) {
+        FILE* fBatch = (strcmp(batchFile, "-") == 0) ? stdin : fopen(batchFile, "rb");
+
+        if(fBatch == NULL) {
+            printf("ERROR: Could not read file: %s\n", batchFile);
+            return EXIT_FAILURE;
+        }
+
+        checkBatch(hashedDict, fBatch, stdout, outputFormat, suggestionCount);
+
+        if(fBatch != stdin) {
+            fclose(fBatch);
+        }
+        if(searchPool != NULL) {
+            searchPoolFree(searchPool);
+        }
+        hashTableFree(hashedDict);
+        return 0;
+    }
+
+    if(cacheSize > 0) {
+        suggestionCache = suggestionCacheCreate(cacheSize);
     }
 
     printf("Dictionary has been loaded into the memory.\n");
     printf("Enter -1 to exit the program.\n");
+    printf("Enter +word to add a word to the dictionary.\n");
 
     //      PROCESSING USER INPUTS
     bool cmdQuit = false;
+    Suggestion_t* suggestions = NULL;
+
+    if(suggestionCount > 1) {
+        suggestions = malloc( suggestionCount * sizeof(Suggestion_t) );
+
+        if(suggestions == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
 
     while(!cmdQuit) {
         printf("Enter a word: ");
@@ -91,21 +295,52 @@ int main() {
 
         toLower(word, strlen(word));
 
+        if(word[0] == '+') {
+            char* newWord = word + 1;
+            int len = strlen(newWord);
+
+            if(len == 0 || hasInvalidChars(newWord)) {
+                printf("Only the letters from a to z can be added.\n\n");
+            } else if(hashTableFindKey(hashedDict, newWord, len) != -1) {
+                printf("Word \"%s\" is already in the dictionary.\n\n", newWord);
+            } else {
+                hashTableAddWord(hashedDict, newWord, len);
+
+                if(!wordLogAppend(wordLogFile, newWord, len)) {
+                    printf("ERROR: Could not write file: %s\n", wordLogFile);
+                } else if(++loggedWords >= WORD_LOG_COMPACT_SIZE) {
+                    wordLogCompact(hashedDict, hashedDictFile, wordLogFile);
+                    loggedWords = 0;
+                }
+                printf("Word \"%s\" has been added to the dictionary.\n\n", newWord);
+            }
+            continue;
+        }
+
         if(hashTableFindKey(hashedDict, word, strlen(word)) != -1) {
             printf("Word \"%s\" is correct.\n\n", word);
 
         } else {
             char* mostSimilarWord;
-            short dist = findMostSimilarWord(hashedDict, word, &mostSimilarWord);
-            if(dist <= MAX_DIST_ALLOWED) {
-                char* path = getEditPath(mostSimilarWord, word);
-
+            char path[EDIT_PATH_LENGTH];
+            short dist = correctWord(hashedDict, word, &mostSimilarWord, path);
+            if(dist <= getDistanceLimit()) {
                 printf("Word \"%s\" is incorrect.\n"
                        "The most similar word found is: \"%s\"\n"
                        "Edit Distance: %d\n"
-                       "Transformation steps: %s\n\n", word, mostSimilarWord, dist, path);
+                       "Transformation steps: %s\n", word, mostSimilarWord, dist, path);
+
+                if(suggestions != NULL) {
+                    int count = findMostSimilarWords(hashedDict, word, suggestionCount, getDistanceLimit(), suggestions);
+                    int i;
 
-                free(path);
+                    printf("Suggestions:");
+                    for(i=0; i<count; i++) {
+                        printf(" \"%s\" (%d)%s", suggestions[i].word, suggestions[i].distance, (i < count - 1) ? "," : "");
+                    }
+                    printf("\n");
+                }
+                printf("\n");
 
             } else {
                 printf("Word \"%s\" does not exist.\n\n", word);
@@ -113,6 +348,14 @@ int main() {
         }
     }
     
+    if(suggestionCache != NULL) {
+        printf("Suggestion cache: %llu hits, %llu misses\n", suggestionCache->hits, suggestionCache->misses);
+        suggestionCacheFree(suggestionCache);
+    }
+    if(searchPool != NULL) {
+        searchPoolFree(searchPool);
+    }
+    free(suggestions);
     hashTableFree(hashedDict);
     return 0;
 }
@@ -123,56 +366,158 @@ int main() {
 *
 *   INFO: Creates a HashTable in memory using the information in 
 *         the ASCII formatted dictionary file. Each word in the 
-*         file must be the first word in each line.
+*         file must be the first word in each line. A number after the
+*         word is taken as its frequency, which ranks the suggestions of
+*         findMostSimilarWords.
+*         The file is mapped and split into lines with memchr, which
+*         the C library implements with vector instructions. The first
+*         word of each line is lowercased and validated while it is
+*         copied, in a single pass. The words are collected before the
+*         table is created, so it is sized from the number of valid
+*         words instead of the number of lines. Repeated words are only
+*         stored once.
 */
 HashTable_t* hashTableLoadFromText(FILE* fp) {
-    
-    HashTable_t* hashTable = (HashTable_t*) malloc( sizeof(HashTable_t) );
-    if(hashTable == NULL) {
+    size_t length;
+    char* text = mapFile(fp, &length);
+
+    // The words are copied one after another, each followed by '\0'.
+    // Every word is followed by a newline or the end of the file in the
+    // text, so they take at most length + 1 bytes.
+    char* words = malloc(length + 1);
+    size_t wordsLength = 0;
+    int wordCount = 0;
+
+    // Frequencies of the collected words, only kept if the file has any
+    int frequencyCapacity = 1024;
+    unsigned int* frequencies = malloc( frequencyCapacity * sizeof(unsigned int) );
+    bool hasFrequencies = false;
+
+    if(words == NULL || frequencies == NULL) {
         printf("ERROR: Could not allocate memory.\n");
         exit(EXIT_FAILURE);
     }
 
-    hashTable->size = hashTableCalculateOptimalSize( getLineCount(fp) );
+    char* line = text;
+    char* end = text + length;
+
+    while(line < end) {
+        char* lineEnd = memchr(line, '\n', end - line);
+        if(lineEnd == NULL) lineEnd = end;
+
+        // Skip the spaces before the word
+        while(line < lineEnd && (*line == ' ' || *line == '\t' || *line == '\r')) line++;
+
+        // Copy the word in lowercase, stop at the first character other than a-z
+        char* word = words + wordsLength;
+        int len = 0;
+
+        while(line + len < lineEnd) {
+            char c = line[len];
+
+            if(c >= 'A' && c <= 'Z') c += 32;
+            if(c < 'a' || c > 'z') break;
+
+            word[len++] = c;
+        }
+
+        // Keep the word if nothing but a space follows it
+        char next = (line + len < lineEnd) ? line[len] : ' ';
+
+        if(len > 0 && len < CONSOLE_INPUT_LENGTH && (next == ' ' || next == '\t' || next == '\r')) {
+            word[len] = '\0';
+            wordsLength += len + 1;
+
+            // Read the frequency, if the next column is a number
+            char* column = line + len;
+            unsigned long long frequency = 0;
+
+            while(column < lineEnd && (*column == ' ' || *column == '\t')) column++;
+            while(column < lineEnd && *column >= '0' && *column <= '9') {
+                frequency = frequency * 10 + (*column - '0');
+                if(frequency > 0xFFFFFFFFULL) frequency = 0xFFFFFFFFULL;
+                column++;
+            }
+
+            if(wordCount == frequencyCapacity) {
+                frequencyCapacity *= 2;
+                frequencies = realloc(frequencies, frequencyCapacity * sizeof(unsigned int));
+
+                if(frequencies == NULL) {
+                    printf("ERROR: Could not allocate memory.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            frequencies[wordCount++] = frequency;
+            if(frequency != 0) hasFrequencies = true;
+        }
+        line = lineEnd + 1;
+    }
+    unmapFile(text, length);
+
+    HashTable_t* hashTable = hashTableCreate( hashTableCalculateOptimalSize(wordCount) );
 
-    hashTable->table = calloc(hashTable->size, sizeof(char*));
+    // The arena will not hold more than the collected words.
+    hashTable->wordsCapacity = wordsLength + 1;
+    hashTable->words = realloc(hashTable->words, hashTable->wordsCapacity);
 
-    if(hashTable->table == NULL) {
+    if(hashTable->words == NULL) {
         printf("ERROR: Could not allocate memory.\n");
         exit(EXIT_FAILURE);
     }
 
-    char buffer[64];
-    int index;
+    if(hasFrequencies) {
+        hashTable->frequencies = calloc(hashTable->size, sizeof(unsigned int));
 
-    while(!feof(fp)) {
-        // Read the first string seperated by a space, ignore the rest of the line
-        fscanf(fp, "%s%*[^\n]", buffer); 
-        
-        // Make all letters lowercase
-        toLower(buffer, strlen(buffer));
+        if(hashTable->frequencies == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // The slots of consecutive words are far apart, so while a word is
+    // inserted, the slots of the word TEXT_PREFETCH_DISTANCE positions
+    // ahead are prefetched.
+    char* word = words;
+    char* ahead = words;
+    int mask = hashTable->size - 1;
+    int i;
+
+    for(i=0; i<TEXT_PREFETCH_DISTANCE && i<wordCount; i++) {
+        ahead += strlen(ahead) + 1;
+    }
 
-        // Skip the line if the string is not a word (Contains characters other than a-z)
-        if(hasInvalidChars(buffer)) continue; 
+    for(i=0; i<wordCount; i++) {
+        int len = strlen(word);
 
-        // Calculate the hash value
-        index = hashTableGetHash(hashTable, buffer, strlen(buffer)); 
+        if(i + TEXT_PREFETCH_DISTANCE < wordCount) {
+            int aheadLen = strlen(ahead);
+            int addr = hashTableGetHash(ahead, aheadLen) & mask;
 
-        // If the generated index is full, find the next available space (Open-Addressing)
-        while(hashTable->table[index] != NULL) { 
-            index = (++index) % hashTable->size;
+            __builtin_prefetch(hashTable->control + addr);
+            __builtin_prefetch(hashTable->slots + addr);
+            ahead += aheadLen + 1;
         }
-        
-        // An empty cell is found, fill it with the new element.
-        hashTable->table[index] = calloc( (strlen(buffer) + 1), sizeof(char) );
 
-        if(hashTable->table[index] == NULL) {
-            printf("ERROR: Could not allocate memory.\n");
-            exit(EXIT_FAILURE);
+        int addr = hashTableInsert(hashTable, word, len);
+
+        // The frequencies of a repeated word add up
+        if(hasFrequencies) {
+            hashTable->frequencies[addr] += frequencies[i];
         }
+        word += len + 1;
+    }
+    free(words);
+    free(frequencies);
+
+    hashTable->bkTree = bkTreeBuild(hashTable);
+    hashTable->deleteIndex = NULL;
 
-        strcpy(hashTable->table[index], buffer);
+    // The deletion index is large, it is only built for --symspell.
+    if(searchMode == SEARCH_SYMSPELL && deleteIndexDistance > 0) {
+        hashTable->deleteIndex = deleteIndexBuild(hashTable, deleteIndexDistance);
     }
+    hashTable->qgramIndex = qgramIndexBuild(hashTable);
 
     return hashTable;
 }
@@ -182,290 +527,4371 @@ HashTable_t* hashTableLoadFromText(FILE* fp) {
 *   @returns a pointer to the read HashTable
 *
 *   INFO: Creates a HashTable in memory using the information in the
-*         given binary file.
+*         given binary file. Files with a section directory (version 3
+*         and later) are handled by hashTableMapBinary. Older files are
+*         read into the heap: version 2 files start with DICT_FILE_MAGIC
+*         and may end with a deletion index, unversioned files only hold
+*         the words. Their words are inserted into a new table, as they
+*         were placed with the previous hash function, and the deletion
+*         index is built again with the same number of deletions.
 */
 HashTable_t* hashTableLoadFromBinary(FILE* fp) {
-    int size, wordCount;
+    int size, wordCount, version = 1;
+    char magic[4];
 
-    fread(&size, sizeof(int), 1, fp); // Size of the HashTable.
-    fread(&wordCount, sizeof(int), 1, fp); // Number of elements in the HashTable
+    fread(magic, sizeof(char), 4, fp);
 
-    HashTable_t* hashTable = malloc( sizeof(HashTable_t) );
+    if(memcmp(magic, DICT_FILE_MAGIC, 4) == 0) {
+        fread(&version, sizeof(int), 1, fp);
 
-    if(hashTable == NULL) {
-        printf("ERROR: Could not allocate memory.\n");
-        exit(EXIT_FAILURE);
+        if(version > DICT_FILE_VERSION) {
+            printf("ERROR: Unsupported dictionary file version: %d\n", version);
+            exit(EXIT_FAILURE);
+        }
+        if(version >= 3) {
+            return hashTableMapBinary(fp);
+        }
+    } else {
+        // Unversioned file, the first bytes were the size of the table.
+        fseek(fp, 0, SEEK_SET);
     }
 
-    hashTable->size = size;
-    hashTable->table = calloc(size, sizeof(char*));
+    fread(&size, sizeof(int), 1, fp); // Size of the HashTable.
+    fread(&wordCount, sizeof(int), 1, fp); // Number of elements in the HashTable
 
-    if(hashTable->table == NULL) {
-        printf("ERROR: Could not allocate memory.\n");
-        exit(EXIT_FAILURE);
-    }
+    HashTable_t* hashTable = hashTableCreate( hashTableCalculateOptimalSize(wordCount) );
 
     int i, addr, len;
-    
+    char buffer[CONSOLE_INPUT_LENGTH];
+
     for(i=0; i<wordCount; i++) {
 
         fread(&addr, sizeof(int), 1, fp);
-        fread(&len, sizeof(int), 1, fp);
-        
-        hashTable->table[addr] = calloc(len, sizeof(char));
+        fread(&len, sizeof(int), 1, fp); // +1 for the string terminator
 
-        if(hashTable->table[addr] == NULL) {
-            printf("ERROR: Could not allocate memory.\n");
+        if(len < 1 || len > CONSOLE_INPUT_LENGTH || addr < 0 || addr >= size) {
+            printf("ERROR: Corrupted dictionary file.\n");
             exit(EXIT_FAILURE);
         }
 
-        fread(hashTable->table[addr], sizeof(char), len, fp);
+        fread(buffer, sizeof(char), len, fp);
+        hashTableInsert(hashTable, buffer, len - 1);
     }
-    return hashTable;
-
-}
-/*
-*   FUNCTION: hashTableSaveAsBinary
-*   @param1 hashedDict: Pointer to the HashTable
-*   @param2 filePath: Path of the file to write
-*   @returns nothing
-*
-*   INFO: Saves the given HashTable into the disk as a binary file.   
-*/
-void hashTableSaveAsBinary(HashTable_t* hashTable, const char* filePath) {
-    FILE* fp = fopen(filePath, "wb");
 
-    int size = hashTable->size;
-    int wordCount = 0;
-    int i=0, len;
+    hashTable->bkTree = bkTreeBuild(hashTable);
+    hashTable->deleteIndex = NULL;
 
-    for(i=0; i<size; i++) {
-        if(hashTable->table[i] != NULL) {
-            wordCount++;
-        }
+    int maxDeletes;
+    if(version == 2 && fread(&maxDeletes, sizeof(int), 1, fp) == 1 && maxDeletes > 0) {
+        hashTable->deleteIndex = deleteIndexBuild(hashTable, maxDeletes);
     }
 
-    fwrite(&size, sizeof(int), 1, fp); // Size of the HashTable
-    fwrite(&wordCount, sizeof(int), 1, fp); // Number of elements in the HashTable
-    
-    for(i=0; i<size; i++) {
-        if(hashTable->table[i] != NULL) {
-            fwrite(&i, sizeof(int), 1, fp); // Address of the word
-
-            len = strlen(hashTable->table[i]) + 1; // +1 for the string terminator
-            fwrite(&len, sizeof(int), 1, fp); // Length of the word
+    return hashTable;
 
-            fwrite(hashTable->table[i], sizeof(char), len, fp); // word
-        }
-    }
-    fclose(fp);
 }
 /*
-*   FUNCTION: hashTableFindKey
-*   @param1 hashTable: Pointer to the HashTable
-*   @param2 key: Key word to look for
-*   @param3 keyLen: Length of the word
-*   @returns the address if the key exists, -1 otherwise
+*   FUNCTION: hashTableMapBinary
+*   @param1 fp: Pointer to the binary file
+*   @returns a pointer to the HashTable
 *
-*   INFO: Looks for a given key in the given HashTable.
+*   INFO: Maps a dictionary file of the current version into memory and
+*         points the HashTable and its indexes into it, so loading takes
+*         a single mmap, nothing is copied and the pages are shared by
+*         every process that maps the same file. The file consists of a
+*         DictFileHeader_t followed by the sections it lists.
+*         Version 3 files have the same layout, but their words were
+*         placed with the previous hash function, so they are passed to
+*         hashTableRehash.
+*         The length of every section is checked against the header, and
+*         the contents against each other by hashTableValidate, before
+*         anything is used in place. A file that fails a check is
+*         rejected.
 */
-int hashTableFindKey(HashTable_t* hashTable, char* key, int keyLen) {
-    int addr = hashTableGetHash(hashTable, key, keyLen);
-    int count = 0;
+HashTable_t* hashTableMapBinary(FILE* fp) {
+    size_t length;
+    char* mapping = mapFile(fp, &length);
 
-    while(hashTable->table[addr] != NULL && count < hashTable->size) {
-        if(strcmp(hashTable->table[addr], key) == 0) {
-            return addr;
-        }
-        addr = (++addr) % hashTable->size;
-        count++;
-    }
-    return -1;
-}
-/*
-*   FUNCTION: hashTableGetHash
-*   @param1 hashTable: Pointer to the HashTable
-*   @param2 key: Key to be calculated
-*   @param3 keyLen: Length of the key
-*   @returns the hash value
-*
-*   INFO: Calculates the given keys hash value, using Horner's Method.
-*         THIS IS DESIGNED TO HASH ONLY LOWERCASE LETTERS
-*/
-int hashTableGetHash(HashTable_t* hashTable, char* key, int keyLen) {
-    const int constant = 31;
-    int addr = 0, i;
+    DictFileHeader_t* header = (DictFileHeader_t*) mapping;
 
-    for(i=0; i<keyLen; i++) {
-        addr = (addr * constant + (key[i] - 96)) % hashTable->size;
-    }
-    return addr;
-}
-void hashTableFree(HashTable_t* hashTable) {
-    int i;
-    for(i=0; i<hashTable->size; i++) {
-        free(hashTable->table[i]);
-    }
-    free(hashTable->table);
-    free(hashTable);
-}
-int hashTableCalculateOptimalSize(int numberOfElements) {
-    // Find the nearest prime that is greater than 2x(Number of Elements)
-    int M = numberOfElements * 2;
-    while(!isPrime(M)) M++;
-    return M;
-}
-/*
-*   FUNCTION: findMostSimilarWord
-*   @param1 hashTable: Pointer to the dictionary HashTable
-*   @param2 key: The word that is being searched 
-*   @param3(return parameter) wordFound: The pointer that the address 
-*                                       of the most similar word found 
-*                                       will be copied into
-*   @returns the distance
-*
-*   INFO: Finds the most similar word to the given key and returns the
-*         distance between them. Also returns the word found through 
-*         @param3.
-*/
-short findMostSimilarWord(HashTable_t* hashTable, char* key, char** wordFound) {
-    char* word;
-    short min, dist;
-    int i = 0;
-    
-    // Advance in the dictionary until a non-null element found.
-    while( (word = hashTable->table[i]) == NULL && i < hashTable->size) {
-        i++;
+    if(length < sizeof(DictFileHeader_t) || header->sectionCount > DICT_MAX_SECTIONS ||
+       header->size < 1 || header->wordCount < 0 || header->wordCount > header->size) {
+        printf("ERROR: Corrupted dictionary file.\n");
+        exit(EXIT_FAILURE);
     }
 
-    // Verify that the dictionary is not empty.
-    if(i == hashTable->size) {
-        *wordFound = NULL;
-        return -1;
+    // The probes of the current version take the address from the bits of the hash.
+    if(header->version >= DICT_FILE_VERSION && (header->size < HASH_GROUP_WIDTH || (header->size & (header->size - 1)) != 0)) {
+        printf("ERROR: Corrupted dictionary file.\n");
+        exit(EXIT_FAILURE);
     }
 
-    // Select the first element as minimum.
-    min = getEditDistance(word, key);
-    *wordFound = word;
-
-    // Find the minimum
-    i++;
-    for( ; i<hashTable->size; i++) {
-        word = hashTable->table[i];
-        if(word == NULL) continue;
-
-        dist = getEditDistance(word, key);
+    HashTable_t* hashTable = malloc( sizeof(HashTable_t) );
 
-        if(dist < min) {
-            min = dist;
-            *wordFound = word;
-        }
+    if(hashTable == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
     }
-    return min;
-}
-/*
-*   FUNCTION: getEditPath
-*   @param1 str1: First string
-*   @param2 str2: Second string
-*   @returns a string that describes the transformation
-*
-*   INFO: Finds the necessary operations to transform the second string into 
-*         first string and returns it as a string in a human readable form.
-*/
-char* getEditPath(char* str1, char* str2) {
-
-    short len1 = strlen(str1);
-    short len2 = strlen(str2);
 
-    short** ED = getEditDistanceMatrix(str1, len1, str2, len2);
+    hashTable->size = header->size;
+    hashTable->wordCount = header->wordCount;
+    hashTable->slots = NULL;
+    hashTable->control = NULL;
+    hashTable->frequencies = NULL;
+    hashTable->words = NULL;
+    hashTable->wordsLength = 0;
+    hashTable->wordsCapacity = 0;
+    hashTable->bkTree = NULL;
+    hashTable->deleteIndex = NULL;
+    hashTable->qgramIndex = NULL;
+    hashTable->mapping = mapping;
+    hashTable->mappingLength = length;
+    hashTable->generation = atomic_fetch_add(&lastTableGeneration, 1) + 1;
+    hashTable->nextSlots = NULL;
+    hashTable->nextControl = NULL;
+    hashTable->nextFrequencies = NULL;
+    hashTable->nextSize = 0;
+    hashTable->nextAddresses = NULL;
+    hashTable->moved = 0;
+    hashTable->oldAddresses = NULL;
 
-    int bufLen = 0;
-    char* path = malloc( 64 * sizeof(char) );
+    unsigned int* deleteHashes = NULL;
+    int* deleteWords = NULL;
+    int deleteCount = 0, maxDeletes = 0;
+    long long deleteWordsLength = 0;
+    long long size = header->size;
+    int i;
 
-    if(path == NULL) {
-        printf("ERROR: Could not allocate memory.\n");
-        exit(EXIT_FAILURE);
-    }
+    for(i=0; i<header->sectionCount; i++) {
+        DictSection_t* section = &header->sections[i];
+        void* data = mapping + section->offset;
 
-    short i,j;
+        if(section->offset < 0 || section->length < 0 || section->offset + section->length > (long long) length) {
+            printf("ERROR: Corrupted dictionary file.\n");
+            exit(EXIT_FAILURE);
+        }
 
-    i = len1;
-    j = len2;
-    char opHistory[64]; // 0: Copy 1: Del 2: Insert 3: Substitute
-    char iOpHistory = 0;
+        // The arrays of the table have an element per slot
+        if((section->id == SECTION_SLOTS && section->length != size * (long long) sizeof(HashSlot_t)) ||
+           (section->id == SECTION_CONTROL && section->length != size + HASH_GROUP_WIDTH) ||
+           (section->id == SECTION_FREQUENCIES && section->length != size * (long long) sizeof(unsigned int)) ||
+           (section->id == SECTION_BKTREE && section->length % sizeof(BKNode_t) != 0) ||
+           (section->id == SECTION_DELETE_HASHES && (section->length % sizeof(unsigned int) != 0 ||
+                                                     section->param < 1 || section->param >= CONSOLE_INPUT_LENGTH))) {
+            printf("ERROR: Corrupted dictionary file.\n");
+            exit(EXIT_FAILURE);
+        }
 
-    
-    // Trace back the path
-    while(i != 0 && j != 0) {
-        if(str1[i-1] == str2[j-1]) { // Characters are equal: Copy
-            opHistory[iOpHistory++] = 0;
-            i--;
-            j--;
-        } else { // Characters are different
-            if(ED[i-1][j-1] < ED[i-1][j]) { 
-                if(ED[i-1][j-1] < ED[i][j-1]) { // Substitute
-                    opHistory[iOpHistory++] = 3;
-                    i--;
-                    j--;
-                } else { // Delete
-                    opHistory[iOpHistory++] = 1;
-                    j--;
-                }
-            } else {
-                if(ED[i-1][j] < ED[i][j-1]) { // Insert
-                    opHistory[iOpHistory++] = 2;
-                    i--;
-                } else { // Delete
-                    opHistory[iOpHistory++] = 1;
-                    j--;
-                }
+        switch(section->id) {
+            case SECTION_SLOTS:{
+                hashTable->slots = data;
+                break;
             }
-        }
-    }
-    while(i != 0) {
-        opHistory[iOpHistory++] = 2;
-        i--;
-    }
-    while(j != 0) {
-        opHistory[iOpHistory++] = 1;
-        j--;
-    }
+            case SECTION_WORDS:{
+                hashTable->words = data;
+                hashTable->wordsLength = section->length;
+                break;
+            }
+            case SECTION_BKTREE:{
+                hashTable->bkTree = malloc( sizeof(BKTree_t) );
 
-    // Produce the output
-    i = 1;
-    for(iOpHistory -= 1; iOpHistory>=0; iOpHistory--) {
+                if(hashTable->bkTree == NULL) {
+                    printf("ERROR: Could not allocate memory.\n");
+                    exit(EXIT_FAILURE);
+                }
 
-        switch(opHistory[iOpHistory]) {
-            case 0:{
-                bufLen += sprintf( path + bufLen, "%c ", str1[i-1]);
-                i++;
+                hashTable->bkTree->nodes = data;
+                hashTable->bkTree->count = section->length / sizeof(BKNode_t);
+                hashTable->bkTree->capacity = 0;
+                hashTable->bkTree->renumbered = 0;
+                hashTable->bkTree->renumberEnd = 0;
                 break;
             }
-            case 1:{
-                bufLen += sprintf( path + bufLen, "(d) ");
-                
+            case SECTION_DELETE_HASHES:{
+                deleteHashes = data;
+                deleteCount = section->length / sizeof(unsigned int);
+                maxDeletes = section->param;
                 break;
             }
-            case 2:{
-                bufLen += sprintf( path + bufLen, "%c(i) ", str1[i-1]);
-                i++;
+            case SECTION_DELETE_WORDS:{
+                deleteWords = data;
+                deleteWordsLength = section->length;
                 break;
             }
-            case 3:{
-                bufLen += sprintf( path + bufLen, "%c(s) ", str1[i-1]);
-                i++;
+            case SECTION_CONTROL:{
+                hashTable->control = data;
                 break;
             }
-        }
-    }
-
-    for(i = 0;i <= len1; i++) {
-        free(ED[i]);
+            case SECTION_FREQUENCIES:{
+                hashTable->frequencies = data;
+                break;
+            }
+            case SECTION_QGRAMS:{
+                // Lists of another word length limit are left out and built again if needed
+                size_t offsetsLength = (QGRAM_LISTS + 1) * sizeof(unsigned int);
+
+                if(section->param != QGRAM_LISTS || section->length < (long long) offsetsLength ||
+                   ((unsigned int*) data)[QGRAM_LISTS] != section->length - offsetsLength) {
+                    break;
+                }
+
+                hashTable->qgramIndex = malloc( sizeof(QGramIndex_t) );
+
+                if(hashTable->qgramIndex == NULL) {
+                    printf("ERROR: Could not allocate memory.\n");
+                    exit(EXIT_FAILURE);
+                }
+
+                hashTable->qgramIndex->listOffsets = data;
+                hashTable->qgramIndex->postings = (unsigned char*) data + offsetsLength;
+                hashTable->qgramIndex->postingsLength = section->length - offsetsLength;
+                hashTable->qgramIndex->pending = NULL;
+                hashTable->qgramIndex->pendingCount = 0;
+                hashTable->qgramIndex->pendingCapacity = 0;
+                hashTable->qgramIndex->mapped = true;
+                hashTable->qgramIndex->renumbering = false;
+                hashTable->qgramIndex->sealed = 0;
+                hashTable->qgramIndex->batchOffsets = NULL;
+                hashTable->qgramIndex->batchIds = NULL;
+                hashTable->qgramIndex->mergeBlock = NULL;
+                hashTable->qgramIndex->mergeLength = 0;
+                hashTable->qgramIndex->mergeList = 0;
+                hashTable->qgramIndex->mergeStep = 0;
+                break;
+            }
+        }
+    }
+
+    if(hashTable->slots == NULL || hashTable->words == NULL ||
+       (header->version >= DICT_FILE_VERSION && hashTable->control == NULL) ||
+       (deleteHashes != NULL) != (deleteWords != NULL) || deleteWordsLength != deleteCount * (long long) sizeof(int)) {
+        printf("ERROR: Corrupted dictionary file.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if(deleteHashes != NULL) {
+        DeleteRun_t run = {deleteHashes, deleteWords, deleteCount, 0, 0, 0};
+
+        hashTable->deleteIndex = deleteIndexCreate(maxDeletes, &run);
+    }
+
+    if(!hashTableValidate(hashTable)) {
+        printf("ERROR: Corrupted dictionary file.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if(header->version < DICT_FILE_VERSION) {
+        return hashTableRehash(hashTable);
+    }
+
+    if(hashTable->bkTree == NULL) {
+        hashTable->bkTree = bkTreeBuild(hashTable);
+    }
+
+    return hashTable;
+}
+/*
+*   FUNCTION: hashTableValidate
+*   @param1 hashTable: Pointer to a HashTable mapped from a file
+*   @returns true if the table and its indexes can be used, false otherwise
+*
+*   INFO: Checks every address and offset of a mapped file before a
+*         search follows it. Each word must lie inside the string arena
+*         and end with a terminator. The control bytes must match the
+*         slots. The BK-Tree and the q-gram index may only refer to
+*         slots that hold a word. The BK-Tree must be a tree that reaches
+*         every word, so that a search stays inside its array and does
+*         not loop. A posting list of the q-gram index must hold whole
+*         varints. The deletion index is most of the file, so its entries
+*         are checked by deleteIndexGetCandidates when they are looked up
+*         instead of all at every start.
+*/
+bool hashTableValidate(HashTable_t* hashTable) {
+    int i, words = 0;
+
+    for(i=0; i<hashTable->size; i++) {
+        HashSlot_t* slot = &hashTable->slots[i];
+
+        if(slot->length == 0) {
+            if(hashTable->control != NULL && hashTable->control[i] != HASH_EMPTY) return false;
+            continue;
+        }
+
+        if(slot->length >= CONSOLE_INPUT_LENGTH || (long long) slot->offset + slot->length >= hashTable->wordsLength ||
+           hashTable->words[slot->offset + slot->length] != '\0') return false;
+
+        if(hashTable->control != NULL && (slot->fingerprint >= HASH_EMPTY || hashTable->control[i] != slot->fingerprint)) return false;
+
+        words++;
+    }
+
+    if(words != hashTable->wordCount) return false;
+
+    if(hashTable->control != NULL && memcmp(hashTable->control + hashTable->size, hashTable->control, HASH_GROUP_WIDTH) != 0) return false;
+
+    BKTree_t* tree = hashTable->bkTree;
+
+    if(tree != NULL && tree->count > 0) {
+        if(tree->count != hashTable->wordCount) return false;
+
+        // Each node may only be reached once from the root
+        bool* reached = calloc(tree->count, sizeof(bool));
+        int* stack = malloc( tree->count * sizeof(int) );
+        int top = 0, reachedCount = 1;
+        bool valid = true;
+
+        if(reached == NULL || stack == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        reached[0] = true;
+        stack[top++] = 0;
+
+        while(top > 0 && valid) {
+            BKNode_t* node = &tree->nodes[ stack[--top] ];
+            int next[2] = {node->firstChild, node->nextSibling};
+
+            if(node->wordIndex < 0 || node->wordIndex >= hashTable->size || hashTable->slots[node->wordIndex].length == 0) {
+                valid = false;
+            }
+
+            for(i=0; i<2 && valid; i++) {
+                if(next[i] == -1) continue;
+
+                if(next[i] < 0 || next[i] >= tree->count || reached[ next[i] ]) {
+                    valid = false;
+                } else {
+                    reached[ next[i] ] = true;
+                    reachedCount++;
+                    stack[top++] = next[i];
+                }
+            }
+        }
+        free(reached);
+        free(stack);
+
+        // The root has no sibling
+        if(!valid || reachedCount != tree->count || tree->nodes[0].nextSibling != -1) return false;
+    }
+
+    QGramIndex_t* qgramIndex = hashTable->qgramIndex;
+
+    if(qgramIndex != NULL) {
+        unsigned int* offsets = qgramIndex->listOffsets;
+
+        for(i=0; i<QGRAM_LISTS; i++) {
+            unsigned char* p = qgramIndex->postings + offsets[i];
+            unsigned char* end = qgramIndex->postings + offsets[i + 1];
+            unsigned long long value = 0;
+            int count = 0;
+
+            if(offsets[i] > offsets[i + 1]) return false;
+
+            // The addresses of a list are increasing and each fits in 5 bytes
+            while(p < end) {
+                unsigned long long delta = *p & 0x7F;
+                int shift = 7;
+
+                while(*p++ & 0x80) {
+                    if(p == end || shift > 28) return false;
+                    delta |= (unsigned long long) (*p & 0x7F) << shift;
+                    shift += 7;
+                }
+                if(count++ > 0 && delta == 0) return false;
+
+                value += delta;
+                if(value >= (unsigned long long) hashTable->size || hashTable->slots[value].length == 0) return false;
+            }
+        }
+    }
+
+    return true;
+}
+/*
+*   FUNCTION: hashTableCreate
+*   @param1 size: Number of slots
+*   @returns a pointer to the created HashTable
+*
+*   INFO: Creates an empty HashTable on the heap, with no indexes. The
+*         size is rounded up to a power of two, so that addresses are
+*         taken from the bits of the hash instead of a division.
+*/
+HashTable_t* hashTableCreate(int size) {
+    HashTable_t* hashTable = malloc( sizeof(HashTable_t) );
+
+    if(hashTable == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    hashTable->size = HASH_GROUP_WIDTH;
+    while(hashTable->size < size) hashTable->size *= 2;
+
+    hashTable->wordCount = 0;
+    hashTable->slots = calloc(hashTable->size, sizeof(HashSlot_t));
+    hashTable->control = malloc(hashTable->size + HASH_GROUP_WIDTH);
+    hashTable->frequencies = NULL;
+    hashTable->wordsLength = 0;
+    hashTable->wordsCapacity = 1 << 16;
+    hashTable->words = malloc(hashTable->wordsCapacity);
+    hashTable->bkTree = NULL;
+    hashTable->deleteIndex = NULL;
+    hashTable->qgramIndex = NULL;
+    hashTable->mapping = NULL;
+    hashTable->mappingLength = 0;
+    hashTable->generation = atomic_fetch_add(&lastTableGeneration, 1) + 1;
+    hashTable->nextSlots = NULL;
+    hashTable->nextControl = NULL;
+    hashTable->nextFrequencies = NULL;
+    hashTable->nextSize = 0;
+    hashTable->nextAddresses = NULL;
+    hashTable->moved = 0;
+    hashTable->oldAddresses = NULL;
+
+    if(hashTable->slots == NULL || hashTable->control == NULL || hashTable->words == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(hashTable->control, HASH_EMPTY, hashTable->size + HASH_GROUP_WIDTH);
+
+    return hashTable;
+}
+/*
+*   FUNCTION: hashTableRehash
+*   @param1 hashTable: Pointer to a HashTable read from an older file
+*   @returns a pointer to the new HashTable
+*
+*   INFO: Inserts the words of the given table into a new one, in the
+*         order of their old addresses, and frees the given table. The
+*         indexes refer to the addresses of the words, so the BK-Tree is
+*         built again, and so are the deletion and q-gram indexes if
+*         there were any.
+*/
+HashTable_t* hashTableRehash(HashTable_t* old) {
+    HashTable_t* hashTable = hashTableCreate( hashTableCalculateOptimalSize(old->wordCount) );
+    int i;
+
+    for(i=0; i<old->size; i++) {
+        char* word = hashTableGetWord(old, i);
+
+        if(word != NULL) {
+            hashTableInsert(hashTable, word, old->slots[i].length);
+        }
+    }
+
+    if(old->frequencies != NULL) {
+        hashTable->frequencies = calloc(hashTable->size, sizeof(unsigned int));
+
+        if(hashTable->frequencies == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for(i=0; i<old->size; i++) {
+            char* word = hashTableGetWord(old, i);
+
+            if(word != NULL) {
+                hashTable->frequencies[ hashTableFindKey(hashTable, word, old->slots[i].length) ] = old->frequencies[i];
+            }
+        }
+    }
+
+    hashTable->bkTree = bkTreeBuild(hashTable);
+
+    if(old->deleteIndex != NULL) {
+        hashTable->deleteIndex = deleteIndexBuild(hashTable, old->deleteIndex->maxDeletes);
+    }
+    if(old->qgramIndex != NULL) {
+        hashTable->qgramIndex = qgramIndexBuild(hashTable);
+    }
+
+    hashTableFree(old);
+    return hashTable;
+}
+/*
+*   FUNCTION: hashTableSaveAsBinary
+*   @param1 hashedDict: Pointer to the HashTable
+*   @param2 filePath: Path of the file to write
+*   @returns true if the file was written, false otherwise
+*
+*   INFO: Saves the given HashTable into the disk as a binary file, in
+*         the layout hashTableMapBinary uses in place: a header, then the
+*         slots, their control bytes, the string arena, the frequencies, the BK-Tree, the deletion index and
+*         the q-gram index (if the table has them) as sections. The file is written next to
+*         the destination and renamed over it, so processes that have
+*         the old file mapped keep reading a complete file. A table that
+*         is growing is switched to its larger arrays first, the runs
+*         of the deletion index are merged into one and the words added
+*         to the q-gram index are merged into its lists.
+*/
+bool hashTableSaveAsBinary(HashTable_t* hashTable, const char* filePath) {
+    char tmpPath[FILENAME_MAX];
+
+    if(hashTable->nextSlots != NULL) {
+        hashTableGrowFinish(hashTable);
+    }
+    // The words added at run time are put into the lists before they are saved.
+    if(hashTable->qgramIndex != NULL) {
+        qgramIndexMerge(hashTable->qgramIndex, hashTable);
+    }
+    if(hashTable->oldAddresses != NULL) {
+        hashTableRenumberStep(hashTable, INT_MAX);
+    }
+
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", filePath);
+
+    FILE* fp = fopen(tmpPath, "wb");
+
+    if(fp == NULL) {
+        printf("ERROR: Could not write file: %s\n", tmpPath);
+        return false;
+    }
+
+    DictFileHeader_t header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, DICT_FILE_MAGIC, 4);
+    header.version = DICT_FILE_VERSION;
+    header.size = hashTable->size;
+    header.wordCount = hashTable->wordCount;
+
+    // The header is written again once the sections are placed.
+    fwrite(&header, sizeof(header), 1, fp);
+
+    writeSection(fp, &header, SECTION_SLOTS, 0, hashTable->slots, (long long) hashTable->size * sizeof(HashSlot_t));
+    writeSection(fp, &header, SECTION_CONTROL, 0, hashTable->control, hashTable->size + HASH_GROUP_WIDTH);
+    writeSection(fp, &header, SECTION_WORDS, 0, hashTable->words, hashTable->wordsLength);
+
+    if(hashTable->frequencies != NULL) {
+        writeSection(fp, &header, SECTION_FREQUENCIES, 0, hashTable->frequencies, (long long) hashTable->size * sizeof(unsigned int));
+    }
+
+    if(hashTable->bkTree != NULL) {
+        writeSection(fp, &header, SECTION_BKTREE, 0, hashTable->bkTree->nodes, (long long) hashTable->bkTree->count * sizeof(BKNode_t));
+    }
+
+    DeleteIndex_t* index = hashTable->deleteIndex;
+    if(index != NULL) {
+        DeleteRun_t* run = deleteIndexMerge(index, hashTable);
+        long long count = (run != NULL) ? run->count : 0;
+
+        writeSection(fp, &header, SECTION_DELETE_HASHES, index->maxDeletes, (run != NULL) ? run->hashes : NULL, count * sizeof(unsigned int));
+        writeSection(fp, &header, SECTION_DELETE_WORDS, 0, (run != NULL) ? run->wordIndices : NULL, count * sizeof(int));
+    }
+
+    if(hashTable->qgramIndex != NULL) {
+        writeSection(fp, &header, SECTION_QGRAMS, QGRAM_LISTS, hashTable->qgramIndex->listOffsets,
+                     (long long) (QGRAM_LISTS + 1) * sizeof(unsigned int) + hashTable->qgramIndex->postingsLength);
+    }
+
+    fseek(fp, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp);
+
+    if(fclose(fp) != 0) {
+        printf("ERROR: Could not write file: %s\n", tmpPath);
+        remove(tmpPath);
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(filePath);
+#endif
+    if(rename(tmpPath, filePath) != 0) {
+        printf("ERROR: Could not write file: %s\n", filePath);
+        return false;
+    }
+    return true;
+}
+// Appends a section, padded to a multiple of 8 bytes, and records it in the header
+void writeSection(FILE* fp, DictFileHeader_t* header, int id, int param, void* data, long long length) {
+    const char padding[8] = {0};
+    long long offset = ftell(fp);
+
+    if(offset % 8 != 0) {
+        fwrite(padding, sizeof(char), 8 - offset % 8, fp);
+        offset += 8 - offset % 8;
+    }
+
+    DictSection_t* section = &header->sections[header->sectionCount++];
+    section->id = id;
+    section->param = param;
+    section->offset = offset;
+    section->length = length;
+
+    fwrite(data, sizeof(char), length, fp);
+}
+/*
+*   FUNCTION: wordLogReplay
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 path: Path of the log
+*   @returns the number of words in the log, 0 if there is no log
+*
+*   INFO: The log has one word per line, in the order they were added.
+*         A last line without its newline was cut by a crash while it
+*         was written and is ignored, as are lines that are not words.
+*/
+int wordLogReplay(HashTable_t* hashTable, const char* path) {
+    FILE* fp = fopen(path, "r");
+    char line[CONSOLE_INPUT_LENGTH + 1];
+    int count = 0;
+
+    if(fp == NULL) {
+        return 0;
+    }
+
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        int len = strlen(line);
+
+        if(len == 0 || line[len - 1] != '\n') {
+            // Too long for a word, skip the rest of the line
+            int c;
+            while(len == CONSOLE_INPUT_LENGTH && (c = fgetc(fp)) != EOF && c != '\n');
+            continue;
+        }
+        line[--len] = '\0';
+
+        if(len == 0 || hasInvalidChars(line)) continue;
+
+        hashTableAddWord(hashTable, line, len);
+        count++;
+    }
+    fclose(fp);
+
+    return count;
+}
+// Appends a word and a newline to the log and flushes it, so the word survives the process
+bool wordLogAppend(const char* path, char* word, int len) {
+    FILE* fp = fopen(path, "a");
+
+    if(fp == NULL) {
+        return false;
+    }
+
+    bool written = fwrite(word, sizeof(char), len, fp) == (size_t) len && fputc('\n', fp) != EOF;
+
+    return fclose(fp) == 0 && written;
+}
+/*
+*   FUNCTION: wordLogCompact
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 filePath: Path of the binary dictionary file
+*   @param3 logPath: Path of the log
+*   @returns nothing
+*
+*   INFO: The dictionary file is replaced first and the log is only
+*         removed if that worked. If the process stops in between, the
+*         log is replayed once more and adds no word.
+*/
+void wordLogCompact(HashTable_t* hashTable, const char* filePath, const char* logPath) {
+    if(hashTableSaveAsBinary(hashTable, filePath)) {
+        remove(logPath);
+    }
+}
+/*
+*   FUNCTION: hashTableFindKey
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 key: Key word to look for
+*   @param3 keyLen: Length of the word
+*   @returns the address if the key exists, -1 otherwise
+*
+*   INFO: Looks for a given key in the given HashTable. The lower bits
+*         of the hash select the first group of HASH_GROUP_WIDTH slots,
+*         and its control bytes are compared with the fingerprint of the
+*         key all at once. Only the slots whose fingerprint matches are
+*         compared by length and characters. A group with an empty slot
+*         ends the search, otherwise the next group is probed at a
+*         growing distance (triangular probing visits every group of a
+*         power of two sized table).
+*/
+int hashTableFindKey(HashTable_t* hashTable, char* key, int keyLen) {
+    unsigned long long hash = hashTableGetHash(key, keyLen);
+    unsigned char fingerprint = hash >> 57;
+    int mask = hashTable->size - 1;
+    int pos = hash & mask;
+    int stride = 0;
+
+    while(stride <= hashTable->size) {
+        unsigned char* group = hashTable->control + pos;
+        unsigned int match = hashTableMatchGroup(group, fingerprint);
+
+        while(match != 0) {
+            int addr = (pos + __builtin_ctz(match)) & mask;
+            HashSlot_t* slot = &hashTable->slots[addr];
+
+            if(slot->length == keyLen && memcmp(hashTable->words + slot->offset, key, keyLen) == 0) {
+                return addr;
+            }
+            match &= match - 1;
+        }
+
+        if(hashTableMatchGroup(group, HASH_EMPTY) != 0) {
+            return -1;
+        }
+        stride += HASH_GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+    return -1;
+}
+/*
+*   FUNCTION: hashTableInsert
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 word: The word
+*   @param3 len: Length of the word
+*   @returns the address the word is stored at
+*
+*   INFO: Follows the probe sequence of hashTableFindKey. If the word
+*         is not found, it is stored into the first empty slot of the
+*         sequence, so looking it up and inserting it take one probe.
+*/
+int hashTableInsert(HashTable_t* hashTable, char* word, int len) {
+    unsigned long long hash = hashTableGetHash(word, len);
+    unsigned char fingerprint = hash >> 57;
+    int mask = hashTable->size - 1;
+    int pos = hash & mask;
+    int stride = 0;
+
+    while(stride <= hashTable->size) {
+        unsigned char* group = hashTable->control + pos;
+        unsigned int match = hashTableMatchGroup(group, fingerprint);
+
+        while(match != 0) {
+            int addr = (pos + __builtin_ctz(match)) & mask;
+            HashSlot_t* slot = &hashTable->slots[addr];
+
+            if(slot->length == len && memcmp(hashTable->words + slot->offset, word, len) == 0) {
+                return addr;
+            }
+            match &= match - 1;
+        }
+
+        unsigned int empty = hashTableMatchGroup(group, HASH_EMPTY);
+
+        if(empty != 0) {
+            int addr = (pos + __builtin_ctz(empty)) & mask;
+            hashTableStoreWord(hashTable, addr, word, len);
+            return addr;
+        }
+        stride += HASH_GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+
+    printf("ERROR: The hashtable is full.\n");
+    exit(EXIT_FAILURE);
+}
+/*
+*   FUNCTION: hashTableAddWord
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 word: The word
+*   @param3 len: Length of the word
+*   @returns the address the word is stored at
+*
+*   INFO: Adds a word to a table that is already in use. Past
+*         HASH_GROW_LOAD_PERCENT a table twice as large is allocated,
+*         and every word added afterwards also moves the words of the
+*         next HASH_GROW_STEP slots into it, so the cost of growing is
+*         spread over the words added instead of paid at once. The
+*         remaining free slots are enough for the last slot to be moved
+*         before the current table is full. Once the larger table is in
+*         use, every word added also gives HASH_RENUMBER_STEP entries of
+*         each index their new address. The word is inserted into the
+*         BK-Tree and the deletion index, and the generation of the
+*         table changes, so cached corrections are found again. The
+*         q-gram index verifies the new words apart from its compressed
+*         lists. Once there are QGRAM_PENDING_SIZE of them they are
+*         merged into the lists, a few lists per word added.
+*/
+int hashTableAddWord(HashTable_t* hashTable, char* word, int len) {
+    int addr = hashTableFindKey(hashTable, word, len);
+
+    if(addr != -1) {
+        return addr;
+    }
+
+    if(hashTable->mapping != NULL) {
+        hashTableDetach(hashTable);
+    }
+
+    if(hashTable->nextSlots == NULL && (long long) (hashTable->wordCount + 1) * 100 > (long long) hashTable->size * HASH_GROW_LOAD_PERCENT) {
+        hashTableGrowStart(hashTable);
+    }
+
+    addr = hashTableInsert(hashTable, word, len);
+
+    if(hashTable->frequencies != NULL) {
+        hashTable->frequencies[addr] = 0;
+    }
+
+    // The slots before the cursor are already moved, so the word is put into the larger table too.
+    if(hashTable->nextSlots != NULL && addr < hashTable->moved) {
+        hashTable->nextAddresses[addr] = hashTablePlaceSlot(hashTable, addr, hashTable->nextSlots, hashTable->nextControl, hashTable->nextSize);
+    }
+
+    if(hashTable->bkTree != NULL) {
+        bkTreeInsert(hashTable->bkTree, hashTable, addr);
+    }
+    if(hashTable->deleteIndex != NULL) {
+        deleteIndexInsert(hashTable->deleteIndex, hashTable, addr);
+    }
+    QGramIndex_t* qgrams = hashTable->qgramIndex;
+    if(qgrams != NULL) {
+        qgramIndexInsert(qgrams, addr);
+
+        if(qgrams->mergeBlock == NULL && qgrams->pendingCount >= QGRAM_PENDING_SIZE) {
+            qgramIndexSeal(qgrams, hashTable);
+        }
+        qgramIndexMergeStep(qgrams, hashTable, qgrams->mergeStep);
+    }
+
+    hashTable->generation = atomic_fetch_add(&lastTableGeneration, 1) + 1;
+
+    if(hashTable->nextSlots != NULL) {
+        hashTableGrowStep(hashTable, HASH_GROW_STEP);
+
+        // The last step switches to the larger table
+        if(hashTable->nextSlots == NULL) {
+            addr = hashTableFindKey(hashTable, word, len);
+        }
+    } else if(hashTable->oldAddresses != NULL) {
+        hashTableRenumberStep(hashTable, HASH_RENUMBER_STEP);
+    }
+    return addr;
+}
+/*
+*   FUNCTION: hashTableDetach
+*   @param1 hashTable: Pointer to a HashTable used from a mapped file
+*   @returns nothing
+*
+*   INFO: Copies the slots, the control bytes, the string arena, the
+*         frequencies and the indexes onto the heap and unmaps the file,
+*         the table is then the same as one built from a text file.
+*/
+void hashTableDetach(HashTable_t* hashTable) {
+    HashSlot_t* slots = malloc( hashTable->size * sizeof(HashSlot_t) );
+    unsigned char* control = malloc( hashTable->size + HASH_GROUP_WIDTH );
+    unsigned int wordsCapacity = (hashTable->wordsLength > (1 << 16)) ? hashTable->wordsLength : (1 << 16);
+    char* words = malloc( wordsCapacity );
+
+    if(slots == NULL || control == NULL || words == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(slots, hashTable->slots, hashTable->size * sizeof(HashSlot_t));
+    memcpy(control, hashTable->control, hashTable->size + HASH_GROUP_WIDTH);
+    memcpy(words, hashTable->words, hashTable->wordsLength);
+
+    hashTable->slots = slots;
+    hashTable->control = control;
+    hashTable->words = words;
+    hashTable->wordsCapacity = wordsCapacity;
+
+    if(hashTable->frequencies != NULL) {
+        unsigned int* frequencies = malloc( hashTable->size * sizeof(unsigned int) );
+
+        if(frequencies == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(frequencies, hashTable->frequencies, hashTable->size * sizeof(unsigned int));
+        hashTable->frequencies = frequencies;
+    }
+
+    BKTree_t* tree = hashTable->bkTree;
+    if(tree != NULL && tree->capacity == 0) {
+        tree->capacity = (tree->count > 1024) ? tree->count : 1024;
+        BKNode_t* nodes = malloc( tree->capacity * sizeof(BKNode_t) );
+
+        if(nodes == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(nodes, tree->nodes, tree->count * sizeof(BKNode_t));
+        tree->nodes = nodes;
+    }
+
+    if(hashTable->deleteIndex != NULL) {
+        DeleteRun_t* runs[1 + 3 * DELETE_INDEX_LEVELS];
+        int runCount = deleteIndexGetRuns(hashTable->deleteIndex, runs, true), i;
+
+        for(i=0; i<runCount; i++) {
+            DeleteRun_t* run = runs[i];
+            if(run->capacity != 0) continue;
+
+            unsigned int* hashes = malloc( (run->count + 1) * sizeof(unsigned int) );
+            int* wordIndices = malloc( (run->count + 1) * sizeof(int) );
+
+            if(hashes == NULL || wordIndices == NULL) {
+                printf("ERROR: Could not allocate memory.\n");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(hashes, run->hashes, run->count * sizeof(unsigned int));
+            memcpy(wordIndices, run->wordIndices, run->count * sizeof(int));
+            run->hashes = hashes;
+            run->wordIndices = wordIndices;
+            run->capacity = run->count + 1;
+        }
+    }
+
+    QGramIndex_t* qgrams = hashTable->qgramIndex;
+    if(qgrams != NULL && qgrams->mapped) {
+        size_t blockLength = (QGRAM_LISTS + 1) * sizeof(unsigned int) + qgrams->postingsLength;
+        unsigned char* block = malloc( blockLength );
+
+        if(block == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(block, qgrams->listOffsets, blockLength);
+        qgrams->listOffsets = (unsigned int*) block;
+        qgrams->postings = block + (QGRAM_LISTS + 1) * sizeof(unsigned int);
+        qgrams->mapped = false;
+    }
+
+    unmapFile(hashTable->mapping, hashTable->mappingLength);
+    hashTable->mapping = NULL;
+    hashTable->mappingLength = 0;
+}
+void hashTableGrowStart(HashTable_t* hashTable) {
+    // The indexes are renumbered long before the table is full again, this is only a safeguard
+    if(hashTable->oldAddresses != NULL) {
+        if(hashTable->qgramIndex != NULL) {
+            qgramIndexMergeStep(hashTable->qgramIndex, hashTable, LLONG_MAX);
+        }
+        hashTableRenumberStep(hashTable, INT_MAX);
+    }
+
+    hashTable->nextSize = hashTable->size * 2;
+    hashTable->nextSlots = calloc(hashTable->nextSize, sizeof(HashSlot_t));
+    hashTable->nextControl = malloc(hashTable->nextSize + HASH_GROUP_WIDTH);
+    hashTable->nextAddresses = malloc(hashTable->size * sizeof(int));
+    hashTable->nextFrequencies = NULL;
+    hashTable->moved = 0;
+
+    if(hashTable->frequencies != NULL) {
+        hashTable->nextFrequencies = calloc(hashTable->nextSize, sizeof(unsigned int));
+    }
+
+    if(hashTable->nextSlots == NULL || hashTable->nextControl == NULL || hashTable->nextAddresses == NULL ||
+       (hashTable->frequencies != NULL && hashTable->nextFrequencies == NULL)) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(hashTable->nextControl, HASH_EMPTY, hashTable->nextSize + HASH_GROUP_WIDTH);
+}
+void hashTableGrowStep(HashTable_t* hashTable, int count) {
+    int end = hashTable->moved + count;
+    if(end > hashTable->size) end = hashTable->size;
+
+    for( ; hashTable->moved < end; hashTable->moved++) {
+        int addr = hashTable->moved;
+        if(hashTable->slots[addr].length == 0) continue;
+
+        int nextAddr = hashTablePlaceSlot(hashTable, addr, hashTable->nextSlots, hashTable->nextControl, hashTable->nextSize);
+        hashTable->nextAddresses[addr] = nextAddr;
+
+        if(hashTable->nextFrequencies != NULL) {
+            hashTable->nextFrequencies[nextAddr] = hashTable->frequencies[addr];
+        }
+    }
+
+    if(hashTable->moved == hashTable->size) {
+        hashTableGrowFinish(hashTable);
+    }
+}
+/*
+*   FUNCTION: hashTableGrowFinish
+*   @param1 hashTable: Pointer to a growing HashTable
+*   @returns nothing
+*
+*   INFO: Moves the slots that are left and replaces the arrays of the
+*         table with the larger ones. The string arena is shared by both
+*         tables, so no word is copied. The indexes refer to the words
+*         by address, so the new address of every old slot is kept and
+*         the entries are renumbered a few at a time by
+*         hashTableRenumberStep, until then they are looked up in it.
+*         Only the small run the deletion index inserts into and the
+*         words the q-gram index keeps apart are renumbered here. The
+*         lists of the q-gram index are ordered by address, so they are
+*         merged again with the new addresses, which also restarts a
+*         merge that was in progress.
+*/
+void hashTableGrowFinish(HashTable_t* hashTable) {
+    int* nextAddresses = hashTable->nextAddresses;
+    int i, j;
+
+    // hashTableGrowStep comes back here once the last slot is moved
+    if(hashTable->moved < hashTable->size) {
+        hashTableGrowStep(hashTable, hashTable->size - hashTable->moved);
+        return;
+    }
+
+    free(hashTable->slots);
+    free(hashTable->control);
+    free(hashTable->frequencies);
+
+    hashTable->slots = hashTable->nextSlots;
+    hashTable->control = hashTable->nextControl;
+    hashTable->frequencies = hashTable->nextFrequencies;
+    hashTable->size = hashTable->nextSize;
+    hashTable->oldAddresses = nextAddresses;
+
+    BKTree_t* tree = hashTable->bkTree;
+    if(tree != NULL) {
+        tree->renumbered = 0;
+        tree->renumberEnd = tree->count;
+    }
+
+    DeleteIndex_t* index = hashTable->deleteIndex;
+    if(index != NULL) {
+        DeleteRun_t* runs[1 + 3 * DELETE_INDEX_LEVELS];
+        int runCount = deleteIndexGetRuns(index, runs, true);
+
+        for(i=0; i<runCount; i++) {
+            runs[i]->renumbered = 0;
+            runs[i]->renumberEnd = runs[i]->count;
+        }
+
+        // Words are inserted into this run, which moves its entries, so it is renumbered at once
+        for(j=0; j<index->insertRun.count; j++) {
+            index->insertRun.wordIndices[j] = nextAddresses[ index->insertRun.wordIndices[j] ];
+        }
+        index->insertRun.renumberEnd = 0;
+    }
+
+    QGramIndex_t* qgrams = hashTable->qgramIndex;
+    if(qgrams != NULL) {
+        free(qgrams->batchOffsets);
+        free(qgrams->batchIds);
+        free(qgrams->mergeBlock);
+        qgrams->batchOffsets = NULL;
+        qgrams->batchIds = NULL;
+        qgrams->mergeBlock = NULL;
+        qgrams->sealed = 0;
+
+        for(j=0; j<qgrams->pendingCount; j++) {
+            qgrams->pending[j] = nextAddresses[ qgrams->pending[j] ];
+        }
+        qgrams->renumbering = true;
+        qgramIndexSeal(qgrams, hashTable);
+    }
+
+    hashTable->nextSlots = NULL;
+    hashTable->nextControl = NULL;
+    hashTable->nextFrequencies = NULL;
+    hashTable->nextAddresses = NULL;
+    hashTable->nextSize = 0;
+    hashTable->moved = 0;
+    hashTable->generation = atomic_fetch_add(&lastTableGeneration, 1) + 1;
+
+    hashTableRenumberStep(hashTable, 0);
+}
+/*
+*   FUNCTION: hashTableRenumberStep
+*   @param1 hashTable: Pointer to a HashTable that has grown
+*   @param2 count: Largest number of entries renumbered in each index
+*   @returns nothing
+*
+*   INFO: Replaces the addresses the BK-Tree nodes and the runs of the
+*         deletion index still hold from the table before it grew with
+*         their new ones, in the order of the entries. The q-gram index
+*         is renumbered by its merge. The new addresses of the old slots
+*         are freed once no entry needs them.
+*/
+void hashTableRenumberStep(HashTable_t* hashTable, int count) {
+    int* oldAddresses = hashTable->oldAddresses;
+    bool done = true;
+    int i, n;
+
+    BKTree_t* tree = hashTable->bkTree;
+    if(tree != NULL) {
+        for(n=0; n<count && tree->renumbered < tree->renumberEnd; n++, tree->renumbered++) {
+            tree->nodes[tree->renumbered].wordIndex = oldAddresses[ tree->nodes[tree->renumbered].wordIndex ];
+        }
+        done = (tree->renumbered >= tree->renumberEnd);
+    }
+
+    if(hashTable->deleteIndex != NULL) {
+        DeleteRun_t* runs[1 + 3 * DELETE_INDEX_LEVELS];
+        int runCount = deleteIndexGetRuns(hashTable->deleteIndex, runs, true);
+
+        for(i=0, n=0; i<runCount; i++) {
+            DeleteRun_t* run = runs[i];
+
+            for( ; n<count && run->renumbered < run->renumberEnd; n++, run->renumbered++) {
+                run->wordIndices[run->renumbered] = oldAddresses[ run->wordIndices[run->renumbered] ];
+            }
+            if(run->renumbered < run->renumberEnd) done = false;
+        }
+    }
+
+    if(hashTable->qgramIndex != NULL && hashTable->qgramIndex->renumbering) {
+        done = false;
+    }
+
+    if(done) {
+        free(hashTable->oldAddresses);
+        hashTable->oldAddresses = NULL;
+    }
+}
+// Copies the slot at the given address into the first empty slot of its probe sequence in the given arrays and returns its address there
+int hashTablePlaceSlot(HashTable_t* hashTable, int addr, HashSlot_t* slots, unsigned char* control, int size) {
+    HashSlot_t* slot = &hashTable->slots[addr];
+    unsigned long long hash = hashTableGetHash(hashTable->words + slot->offset, slot->length);
+    int mask = size - 1;
+    int pos = hash & mask;
+    int stride = 0;
+
+    while(1) {
+        unsigned int empty = hashTableMatchGroup(control + pos, HASH_EMPTY);
+
+        if(empty != 0) {
+            int nextAddr = (pos + __builtin_ctz(empty)) & mask;
+
+            slots[nextAddr] = *slot;
+            control[nextAddr] = slot->fingerprint;
+            if(nextAddr < HASH_GROUP_WIDTH) {
+                control[size + nextAddr] = slot->fingerprint;
+            }
+            return nextAddr;
+        }
+        stride += HASH_GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+/*
+*   FUNCTION: hashTableGetHash
+*   @param1 key: Key to be calculated
+*   @param2 keyLen: Length of the key
+*   @returns the hash value
+*
+*   INFO: Mixes the key 8 characters at a time with multiplications and
+*         shifts, then applies the finalizer of MurmurHash3, so that both
+*         the lower bits (the address) and the top 7 bits (the
+*         fingerprint) depend on every character.
+*/
+unsigned long long hashTableGetHash(char* key, int keyLen) {
+    unsigned long long hash = 0x9E3779B97F4A7C15ULL ^ (unsigned long long) keyLen;
+    unsigned long long chunk;
+
+    while(keyLen >= 8) {
+        memcpy(&chunk, key, 8);
+        hash = (hash ^ chunk) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+        key += 8;
+        keyLen -= 8;
+    }
+
+    chunk = 0;
+    memcpy(&chunk, key, keyLen);
+    hash = (hash ^ chunk) * 0xFF51AFD7ED558CCDULL;
+
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+/*
+*   FUNCTION: hashTableMatchGroup
+*   @param1 group: Address of HASH_GROUP_WIDTH control bytes
+*   @param2 byte: The byte to look for
+*   @returns a mask whose bit i is set if group[i] is equal to the byte
+*
+*   INFO: Compares the whole group with a single SSE2 instruction where
+*         it is available, byte by byte otherwise.
+*/
+unsigned int hashTableMatchGroup(unsigned char* group, unsigned char byte) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((__m128i*) group);
+    return _mm_movemask_epi8( _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) byte)) );
+#else
+    unsigned int mask = 0;
+    int i;
+
+    for(i=0; i<HASH_GROUP_WIDTH; i++) {
+        if(group[i] == byte) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+// Returns the word at the given address, or NULL if the slot is empty
+char* hashTableGetWord(HashTable_t* hashTable, int addr) {
+    HashSlot_t* slot = &hashTable->slots[addr];
+    return (slot->length != 0) ? hashTable->words + slot->offset : NULL;
+}
+unsigned int hashTableGetFrequency(HashTable_t* hashTable, int addr) {
+    return (hashTable->frequencies != NULL) ? hashTable->frequencies[addr] : 0;
+}
+// Ties between words at the same distance go to the more frequent one, then to the alphabetically first one, as in the ranking of the suggestions
+bool hashTableRanksBefore(HashTable_t* hashTable, int addr, int other) {
+    if(other == -1) {
+        return true;
+    }
+
+    unsigned int frequency = hashTableGetFrequency(hashTable, addr);
+    unsigned int otherFrequency = hashTableGetFrequency(hashTable, other);
+
+    if(frequency != otherFrequency) {
+        return frequency > otherFrequency;
+    }
+    return strcmp(hashTableGetWord(hashTable, addr), hashTableGetWord(hashTable, other)) < 0;
+}
+/*
+*   FUNCTION: hashTableStoreWord
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 addr: Address of the slot to fill
+*   @param3 word: The word
+*   @param4 len: Length of the word
+*   @returns nothing
+*
+*   INFO: Appends the word to the string arena, growing it if needed,
+*         and fills the slot with its position, length and fingerprint.
+*         The first HASH_GROUP_WIDTH control bytes are also copied after
+*         the last one, so a group can be loaded at any address.
+*/
+void hashTableStoreWord(HashTable_t* hashTable, int addr, char* word, int len) {
+
+    if(hashTable->wordsLength + len + 1 > hashTable->wordsCapacity) {
+        while(hashTable->wordsLength + len + 1 > hashTable->wordsCapacity) {
+            hashTable->wordsCapacity *= 2;
+        }
+        hashTable->words = realloc(hashTable->words, hashTable->wordsCapacity);
+
+        if(hashTable->words == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    HashSlot_t* slot = &hashTable->slots[addr];
+    slot->offset = hashTable->wordsLength;
+    slot->length = len;
+    slot->fingerprint = hashTableGetHash(word, len) >> 57;
+    slot->reserved = 0;
+
+    hashTable->control[addr] = slot->fingerprint;
+    if(addr < HASH_GROUP_WIDTH) {
+        hashTable->control[hashTable->size + addr] = slot->fingerprint;
+    }
+
+    memcpy(hashTable->words + hashTable->wordsLength, word, len);
+    hashTable->words[hashTable->wordsLength + len] = '\0';
+    hashTable->wordsLength += len + 1;
+    hashTable->wordCount++;
+}
+void hashTableFree(HashTable_t* hashTable) {
+    if(hashTable->mapping != NULL) {
+        unmapFile(hashTable->mapping, hashTable->mappingLength);
+    } else {
+        free(hashTable->slots);
+        free(hashTable->control);
+        free(hashTable->frequencies);
+        free(hashTable->words);
+    }
+    free(hashTable->nextSlots);
+    free(hashTable->nextControl);
+    free(hashTable->nextFrequencies);
+    free(hashTable->nextAddresses);
+    free(hashTable->oldAddresses);
+    bkTreeFree(hashTable->bkTree);
+    deleteIndexFree(hashTable->deleteIndex);
+    qgramIndexFree(hashTable->qgramIndex);
+    free(hashTable);
+}
+int hashTableCalculateOptimalSize(int numberOfElements) {
+    // Find the smallest power of two that keeps the table at most 7/8 full
+    int M = HASH_GROUP_WIDTH;
+    while(M / 8 * 7 < numberOfElements) M *= 2;
+    return M;
+}
+/*
+*   FUNCTION: findMostSimilarWord
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched 
+*   @param3(return parameter) wordFound: The pointer that the address 
+*                                       of the most similar word found 
+*                                       will be copied into
+*   @returns the distance
+*
+*   INFO: Finds the most similar word to the given key and returns the
+*         distance between them, using the strategy selected by
+*         searchMode. Also returns the word found through @param3.
+*         Every strategy breaks ties by frequency, then alphabetically,
+*         as findMostSimilarWords ranks its suggestions, so the word
+*         found is the first suggestion and does not depend on the
+*         addresses of the words. The indexes only hold unit cost distances, so the keyboard
+*         metric takes the best suggestion of a scan instead. Swaps keep
+*         the deletion index complete (a swap is one deletion from each
+*         word), but the BK-Tree needs the triangle inequality, which
+*         the optimal string alignment distance does not have, so the
+*         Damerau metric scans the table in its place.
+*/
+short findMostSimilarWord(HashTable_t* hashTable, char* key, char** wordFound) {
+    if(distanceMetric == METRIC_KEYBOARD) {
+        Suggestion_t best;
+
+        if(findMostSimilarWords(hashTable, key, 1, getDistanceLimit(), &best) == 0) {
+            *wordFound = NULL;
+            return getDistanceLimit() + 1;
+        }
+        *wordFound = best.word;
+        return best.distance;
+    }
+    if(searchMode == SEARCH_PARALLEL && searchPool != NULL) {
+        return findMostSimilarWordParallel(hashTable, key, wordFound);
+    }
+    if(searchMode == SEARCH_QGRAM && hashTable->qgramIndex != NULL) {
+        return findMostSimilarWordQGram(hashTable, key, wordFound);
+    }
+    if(searchMode == SEARCH_SYMSPELL && hashTable->deleteIndex != NULL) {
+        return findMostSimilarWordSymSpell(hashTable, key, wordFound);
+    }
+    if((searchMode == SEARCH_BKTREE || searchMode == SEARCH_SYMSPELL) && hashTable->bkTree != NULL && distanceMetric == METRIC_UNIT) {
+        return findMostSimilarWordBKTree(hashTable, key, wordFound);
+    }
+    return findMostSimilarWordLinear(hashTable, key, wordFound);
+}
+/*
+*   FUNCTION: findMostSimilarWordLinear
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched 
+*   @param3(return parameter) wordFound: The pointer that the address 
+*                                       of the most similar word found 
+*                                       will be copied into
+*   @returns the distance
+*
+*   INFO: Finds the most similar word to the given key and returns the
+*         distance between them. Also returns the word found through 
+*         @param3. Every word in the table is compared against the key,
+*         ties are broken by hashTableRanksBefore. Once a candidate is
+*         found, the remaining words only need to be checked for being as
+*         close (if they rank before it) or strictly closer, so the bound
+*         given to getEditDistanceBounded tightens as the scan goes on.
+*/
+short findMostSimilarWordLinear(HashTable_t* hashTable, char* key, char** wordFound) {
+    char* word;
+    short min, dist;
+    int i = 0, minIndex;
+    
+    // Advance in the dictionary until a non-null element found.
+    while(i < hashTable->size && (word = hashTableGetWord(hashTable, i)) == NULL) {
+        i++;
+    }
+
+    // Verify that the dictionary is not empty.
+    if(i == hashTable->size) {
+        *wordFound = NULL;
+        return -1;
+    }
+
+    // Select the first element as minimum.
+    min = (distanceMetric == METRIC_DAMERAU) ? getEditDistanceDamerau(word, key) : getEditDistance(word, key);
+    minIndex = i;
+    *wordFound = word;
+
+    // Find the minimum
+    i++;
+    for( ; i<hashTable->size && min > 0; i++) {
+        word = hashTableGetWord(hashTable, i);
+        if(word == NULL) continue;
+
+        short bound = hashTableRanksBefore(hashTable, i, minIndex) ? min : min - 1;
+        dist = getEditDistanceMetric(word, key, bound);
+
+        if(dist <= bound) {
+            min = dist;
+            minIndex = i;
+            *wordFound = word;
+        }
+    }
+    return min;
+}
+/*
+*   FUNCTION: findMostSimilarWordParallel
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3(return parameter) wordFound: The pointer that the address
+*                                       of the most similar word found
+*                                       will be copied into
+*   @returns the distance, or MAX_DIST_ALLOWED + 1 if no word is
+*            within MAX_DIST_ALLOWED of the key
+*
+*   INFO: Posts the key to searchPool and waits for its threads, which
+*         scan consecutive ranges of the table. The best distance found
+*         by any thread bounds the others. Ties between the results of
+*         the threads are broken by hashTableRanksBefore, as in
+*         findMostSimilarWordLinear.
+*/
+short findMostSimilarWordParallel(HashTable_t* hashTable, char* key, char** wordFound) {
+    SearchPool_t* pool = searchPool;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->hashTable = hashTable;
+    pool->key = key;
+    pool->k = 0;
+    atomic_store(&pool->bound, MAX_DIST_ALLOWED);
+    pool->pending = pool->threadCount;
+    pool->generation++;
+
+    pthread_cond_broadcast(&pool->workReady);
+
+    while(pool->pending > 0) {
+        pthread_cond_wait(&pool->workDone, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    short min = MAX_DIST_ALLOWED + 1;
+    int minIndex = -1;
+
+    for(i=0; i<pool->threadCount; i++) {
+        SearchWorker_t* worker = &pool->workers[i];
+
+        if(worker->minIndex != -1 && (worker->min < min || (worker->min == min &&
+           hashTableRanksBefore(hashTable, worker->minIndex, minIndex)))) {
+            min = worker->min;
+            minIndex = worker->minIndex;
+        }
+    }
+
+    *wordFound = (minIndex != -1) ? hashTableGetWord(hashTable, minIndex) : NULL;
+    return min;
+}
+/*
+*   FUNCTION: searchPoolWorker
+*   @param1 arg: Pointer to the SearchWorker_t of the thread
+*   @returns NULL
+*
+*   INFO: Waits for queries and scans the worker's share of the table
+*         for each one. A word only matters if it is within the shared
+*         bound (ties included, another thread may hold a word that ranks
+*         after it) and as close as the worker's own best.
+*         For findMostSimilarWordsParallel the worker keeps the k best
+*         words of its range in its own heap instead.
+*/
+void* searchPoolWorker(void* arg) {
+    SearchWorker_t* worker = arg;
+    SearchPool_t* pool = worker->pool;
+    unsigned int seen = 0;
+
+    while(1) {
+        pthread_mutex_lock(&pool->lock);
+
+        while(!pool->quit && pool->generation == seen) {
+            pthread_cond_wait(&pool->workReady, &pool->lock);
+        }
+        if(pool->quit) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+
+        HashTable_t* hashTable = pool->hashTable;
+        char* key = pool->key;
+
+        pthread_mutex_unlock(&pool->lock);
+
+        int begin = (long long) hashTable->size * worker->id / pool->threadCount;
+        int end = (long long) hashTable->size * (worker->id + 1) / pool->threadCount;
+        short min = MAX_DIST_ALLOWED + 1;
+        int minIndex = -1;
+        int i;
+
+        if(pool->k > 0) {
+            SuggestionHeap_t heap = {worker->suggestions, 0, pool->k, pool->maxDist};
+
+            for(i = begin; i < end; i++) {
+                char* word = hashTableGetWord(hashTable, i);
+                if(word == NULL) continue;
+
+                short k = suggestionHeapBound(&heap);
+                short shared = atomic_load_explicit(&pool->bound, memory_order_relaxed);
+                if(k > shared) k = shared;
+
+                short dist = getEditDistanceMetric(word, key, k);
+
+                if(dist <= k) {
+                    suggestionHeapPush(&heap, hashTable, i, dist);
+
+                    // A full heap bounds every worker: the k best overall are at least this close.
+                    if(heap.count == heap.capacity) {
+                        short full = suggestionHeapBound(&heap);
+                        int bound = atomic_load(&pool->bound);
+                        while(full < bound && !atomic_compare_exchange_weak(&pool->bound, &bound, full));
+                    }
+                }
+            }
+            worker->suggestionCount = heap.count;
+        } else {
+            for(i = begin; i < end; i++) {
+                char* word = hashTableGetWord(hashTable, i);
+                if(word == NULL) continue;
+
+                if(min == 0) break;
+
+                // A word that ranks after the worker's best must be strictly closer
+                short k = atomic_load_explicit(&pool->bound, memory_order_relaxed);
+                short own = hashTableRanksBefore(hashTable, i, minIndex) ? min : min - 1;
+                if(k > own) k = own;
+
+                short dist = getEditDistanceMetric(word, key, k);
+
+                if(dist <= k) {
+                    min = dist;
+                    minIndex = i;
+
+                    // Lower the shared bound
+                    int bound = atomic_load(&pool->bound);
+                    while(dist < bound && !atomic_compare_exchange_weak(&pool->bound, &bound, dist));
+                }
+            }
+        }
+
+        pthread_mutex_lock(&pool->lock);
+
+        worker->min = min;
+        worker->minIndex = minIndex;
+
+        if(--pool->pending == 0) {
+            pthread_cond_signal(&pool->workDone);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+/*
+*   FUNCTION: searchPoolCreate
+*   @param1 threadCount: Number of threads
+*   @returns a pointer to the created pool
+*
+*   INFO: Starts the threads once, they wait for the queries posted by
+*         findMostSimilarWordParallel until searchPoolFree stops them.
+*/
+SearchPool_t* searchPoolCreate(int threadCount) {
+    SearchPool_t* pool = malloc( sizeof(SearchPool_t) );
+
+    if(pool == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pool->threadCount = threadCount;
+    pool->threads = malloc( threadCount * sizeof(pthread_t) );
+    pool->workers = malloc( threadCount * sizeof(SearchWorker_t) );
+
+    if(pool->threads == NULL || pool->workers == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->workReady, NULL);
+    pthread_cond_init(&pool->workDone, NULL);
+    pool->generation = 0;
+    pool->pending = 0;
+    pool->quit = false;
+    atomic_init(&pool->bound, MAX_DIST_ALLOWED);
+
+    int i;
+    for(i=0; i<threadCount; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        pool->workers[i].minIndex = -1;
+        pool->workers[i].suggestions = NULL;
+        pool->workers[i].suggestionCount = 0;
+        pool->workers[i].suggestionCapacity = 0;
+
+        if(pthread_create(&pool->threads[i], NULL, searchPoolWorker, &pool->workers[i]) != 0) {
+            printf("ERROR: Could not create a thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return pool;
+}
+void searchPoolFree(SearchPool_t* pool) {
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(i=0; i<pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+        free(pool->workers[i].suggestions);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->workReady);
+    pthread_cond_destroy(&pool->workDone);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
+/*
+*   FUNCTION: findMostSimilarWordBKTree
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched 
+*   @param3(return parameter) wordFound: The pointer that the address 
+*                                       of the most similar word found 
+*                                       will be copied into
+*   @returns the distance, or MAX_DIST_ALLOWED + 1 if no word is
+*            within MAX_DIST_ALLOWED of the key
+*
+*   INFO: Queries the BK-Tree of the table for the most similar word.
+*         By the triangle inequality, only the children whose edge is
+*         within [d - radius, d + radius] of a node at distance d can
+*         hold a match, so most of the tree is never visited. The radius
+*         shrinks to the best distance found so far. Ties are broken by
+*         hashTableRanksBefore, so whenever the result is within
+*         MAX_DIST_ALLOWED it is the same as findMostSimilarWordLinear's.
+*/
+short findMostSimilarWordBKTree(HashTable_t* hashTable, char* key, char** wordFound) {
+    BKTree_t* tree = hashTable->bkTree;
+    short min = MAX_DIST_ALLOWED + 1;
+    int minIndex = -1;
+
+    *wordFound = NULL;
+
+    // Verify that the dictionary is not empty.
+    if(tree->count == 0) {
+        return -1;
+    }
+
+    int* stack = malloc( tree->count * sizeof(int) );
+
+    if(stack == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    EditPattern_t pattern;
+    editPatternInit(&pattern, key);
+
+    int top = 0;
+    stack[top++] = 0;
+
+    while(top > 0) {
+        int current = stack[--top];
+        BKNode_t* node = &tree->nodes[current];
+        int addr = bkTreeGetAddress(tree, hashTable, current);
+        short dist = getEditDistancePattern(&pattern, hashTableGetWord(hashTable, addr));
+
+        if(dist < min || (dist == min && minIndex != -1 && hashTableRanksBefore(hashTable, addr, minIndex))) {
+            min = dist;
+            minIndex = addr;
+        }
+
+        // Words with an equal distance must still be reached to break ties.
+        short radius = (min <= MAX_DIST_ALLOWED) ? min : MAX_DIST_ALLOWED;
+        int child;
+
+        for(child = node->firstChild; child != -1; child = tree->nodes[child].nextSibling) {
+            short edge = tree->nodes[child].edge;
+            if(edge >= dist - radius && edge <= dist + radius) {
+                stack[top++] = child;
+            }
+        }
+    }
+    free(stack);
+    editPatternRelease(&pattern);
+
+    *wordFound = (minIndex != -1) ? hashTableGetWord(hashTable, minIndex) : NULL;
+    return min;
+}
+/*
+*   FUNCTION: findMostSimilarWords
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3 k: Number of suggestions wanted
+*   @param4 maxDist: Largest distance a suggestion may have
+*   @param5(return parameter) suggestions: Array of at least k elements
+*                                         the suggestions are written into
+*   @returns the number of suggestions found, at most k
+*
+*   INFO: Finds the k words closest to the key, using the strategy
+*         selected by searchMode, and writes them best first: by
+*         distance, then by frequency, then alphabetically. The caller's
+*         array holds the bounded heap of the search, so no memory is
+*         allocated per candidate. While the heap is not full, any word
+*         within maxDist may enter it; once it is full, the distance of
+*         its worst suggestion bounds the search instead of the best.
+*/
+int findMostSimilarWords(HashTable_t* hashTable, char* key, int k, short maxDist, Suggestion_t* suggestions) {
+    SuggestionHeap_t heap = {suggestions, 0, k, maxDist};
+
+    if(k <= 0) {
+        return 0;
+    }
+
+    if(searchMode == SEARCH_PARALLEL && searchPool != NULL) {
+        findMostSimilarWordsParallel(hashTable, key, &heap);
+    } else if(distanceMetric == METRIC_KEYBOARD) {
+        findMostSimilarWordsLinear(hashTable, key, &heap);
+    } else if(searchMode == SEARCH_QGRAM && hashTable->qgramIndex != NULL) {
+        findMostSimilarWordsQGram(hashTable, key, &heap);
+    } else if(searchMode == SEARCH_SYMSPELL && hashTable->deleteIndex != NULL) {
+        findMostSimilarWordsSymSpell(hashTable, key, &heap);
+    } else if((searchMode == SEARCH_BKTREE || searchMode == SEARCH_SYMSPELL) && hashTable->bkTree != NULL && distanceMetric == METRIC_UNIT) {
+        findMostSimilarWordsBKTree(hashTable, key, &heap);
+    } else {
+        findMostSimilarWordsLinear(hashTable, key, &heap);
+    }
+
+    // Sort the heap in place: the worst suggestion is moved to the end each time.
+    int n = heap.count;
+
+    while(n > 1) {
+        Suggestion_t worst = suggestions[0];
+        suggestions[0] = suggestions[--n];
+        suggestions[n] = worst;
+
+        int parent = 0;
+        while(1) {
+            int child = 2 * parent + 1;
+            if(child >= n) break;
+            if(child + 1 < n && suggestionIsWorse(&suggestions[child + 1], &suggestions[child])) child++;
+            if(!suggestionIsWorse(&suggestions[child], &suggestions[parent])) break;
+
+            Suggestion_t tmp = suggestions[parent];
+            suggestions[parent] = suggestions[child];
+            suggestions[child] = tmp;
+            parent = child;
+        }
+    }
+    return heap.count;
+}
+// Offers every word of the table to the heap, bounded by the heap's current k-th distance
+void findMostSimilarWordsLinear(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap) {
+    int i;
+
+    for(i=0; i<hashTable->size; i++) {
+        char* word = hashTableGetWord(hashTable, i);
+        if(word == NULL) continue;
+
+        short bound = suggestionHeapBound(heap);
+        short dist = getEditDistanceMetric(word, key, bound);
+
+        if(dist <= bound) {
+            suggestionHeapPush(heap, hashTable, i, dist);
+        }
+    }
+}
+/*
+*   FUNCTION: findMostSimilarWordsBKTree
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3 heap: The heap the words found are offered to
+*   @returns nothing
+*
+*   INFO: Same walk as findMostSimilarWordBKTree, with the bound of the
+*         heap as the radius.
+*/
+void findMostSimilarWordsBKTree(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap) {
+    BKTree_t* tree = hashTable->bkTree;
+
+    if(tree->count == 0) {
+        return;
+    }
+
+    int* stack = malloc( tree->count * sizeof(int) );
+
+    if(stack == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    EditPattern_t pattern;
+    editPatternInit(&pattern, key);
+
+    int top = 0;
+    stack[top++] = 0;
+
+    while(top > 0) {
+        int current = stack[--top];
+        BKNode_t* node = &tree->nodes[current];
+        int addr = bkTreeGetAddress(tree, hashTable, current);
+        short dist = getEditDistancePattern(&pattern, hashTableGetWord(hashTable, addr));
+
+        if(dist <= suggestionHeapBound(heap)) {
+            suggestionHeapPush(heap, hashTable, addr, dist);
+        }
+
+        short radius = suggestionHeapBound(heap);
+        int child;
+
+        for(child = node->firstChild; child != -1; child = tree->nodes[child].nextSibling) {
+            short edge = tree->nodes[child].edge;
+            if(edge >= dist - radius && edge <= dist + radius) {
+                stack[top++] = child;
+            }
+        }
+    }
+    free(stack);
+    editPatternRelease(&pattern);
+}
+/*
+*   FUNCTION: findMostSimilarWordsSymSpell
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3 heap: The heap the words found are offered to
+*   @returns nothing
+*
+*   INFO: Offers the candidates of the deletion index to the heap. They
+*         include every word within the deletion distance of the index,
+*         so the BK-Tree is only queried when the heap may still take
+*         words that are farther than that.
+*/
+void findMostSimilarWordsSymSpell(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap) {
+    DeleteIndex_t* index = hashTable->deleteIndex;
+
+    int candidateCapacity = 256;
+    int* candidates = malloc( candidateCapacity * sizeof(int) );
+
+    if(candidates == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int candidateCount = deleteIndexGetCandidates(hashTable, key, &candidates, &candidateCapacity);
+    int i;
+
+    for(i=0; i<candidateCount; i++) {
+        short bound = suggestionHeapBound(heap);
+        short dist = getEditDistanceMetric(hashTableGetWord(hashTable, candidates[i]), key, bound);
+
+        if(dist <= bound) {
+            suggestionHeapPush(heap, hashTable, candidates[i], dist);
+        }
+    }
+    free(candidates);
+
+    if(suggestionHeapBound(heap) > index->maxDeletes) {
+        if(distanceMetric == METRIC_UNIT && hashTable->bkTree != NULL) {
+            findMostSimilarWordsBKTree(hashTable, key, heap);
+        } else {
+            findMostSimilarWordsLinear(hashTable, key, heap);
+        }
+    }
+}
+/*
+*   FUNCTION: findMostSimilarWordsParallel
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3 heap: The heap the words found are offered to
+*   @returns nothing
+*
+*   INFO: Posts the query to searchPool. Each thread keeps the best k
+*         words of its range in its own heap, and a full heap lowers the
+*         bound shared by all of them. The heaps of the threads are then
+*         merged into the given one.
+*/
+void findMostSimilarWordsParallel(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap) {
+    SearchPool_t* pool = searchPool;
+    int i, j;
+
+    pthread_mutex_lock(&pool->lock);
+
+    // The threads are waiting, their heaps can be grown safely.
+    for(i=0; i<pool->threadCount; i++) {
+        SearchWorker_t* worker = &pool->workers[i];
+
+        if(worker->suggestionCapacity < heap->capacity) {
+            worker->suggestionCapacity = heap->capacity;
+            worker->suggestions = realloc(worker->suggestions, worker->suggestionCapacity * sizeof(Suggestion_t));
+
+            if(worker->suggestions == NULL) {
+                printf("ERROR: Could not allocate memory.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    pool->hashTable = hashTable;
+    pool->key = key;
+    pool->k = heap->capacity;
+    pool->maxDist = heap->maxDist;
+    atomic_store(&pool->bound, heap->maxDist);
+    pool->pending = pool->threadCount;
+    pool->generation++;
+
+    pthread_cond_broadcast(&pool->workReady);
+
+    while(pool->pending > 0) {
+        pthread_cond_wait(&pool->workDone, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    for(i=0; i<pool->threadCount; i++) {
+        SearchWorker_t* worker = &pool->workers[i];
+
+        for(j=0; j<worker->suggestionCount; j++) {
+            suggestionHeapPush(heap, hashTable, worker->suggestions[j].wordIndex, worker->suggestions[j].distance);
+        }
+    }
+}
+/*
+*   FUNCTION: suggestionHeapPush
+*   @param1 heap: Pointer to the heap
+*   @param2 hashTable: Pointer to the dictionary HashTable
+*   @param3 wordIndex: Address of the word
+*   @param4 distance: Distance between the word and the key
+*   @returns nothing
+*
+*   INFO: Adds the word while the heap is not full, afterwards it
+*         replaces the worst suggestion if it ranks above it. A word
+*         that is already in the heap is ignored, as strategies that are
+*         combined may find the same word twice.
+*/
+void suggestionHeapPush(SuggestionHeap_t* heap, HashTable_t* hashTable, int wordIndex, short distance) {
+    Suggestion_t suggestion;
+    int i;
+
+    if(distance > heap->maxDist) {
+        return;
+    }
+
+    for(i=0; i<heap->count; i++) {
+        if(heap->items[i].wordIndex == wordIndex) return;
+    }
+
+    suggestion.word = hashTableGetWord(hashTable, wordIndex);
+    suggestion.wordIndex = wordIndex;
+    suggestion.distance = distance;
+    suggestion.frequency = hashTableGetFrequency(hashTable, wordIndex);
+
+    Suggestion_t* items = heap->items;
+
+    if(heap->count < heap->capacity) {
+        // Sift up from the new leaf
+        i = heap->count++;
+        while(i > 0 && suggestionIsWorse(&suggestion, &items[(i - 1) / 2])) {
+            items[i] = items[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        items[i] = suggestion;
+        return;
+    }
+
+    if(!suggestionIsWorse(&items[0], &suggestion)) {
+        return;
+    }
+
+    // Sift down from the root
+    i = 0;
+    while(1) {
+        int child = 2 * i + 1;
+        if(child >= heap->count) break;
+        if(child + 1 < heap->count && suggestionIsWorse(&items[child + 1], &items[child])) child++;
+        if(!suggestionIsWorse(&items[child], &suggestion)) break;
+
+        items[i] = items[child];
+        i = child;
+    }
+    items[i] = suggestion;
+}
+short suggestionHeapBound(SuggestionHeap_t* heap) {
+    return (heap->count == heap->capacity) ? heap->items[0].distance : heap->maxDist;
+}
+bool suggestionIsWorse(Suggestion_t* a, Suggestion_t* b) {
+    if(a->distance != b->distance) return a->distance > b->distance;
+    if(a->frequency != b->frequency) return a->frequency < b->frequency;
+    return strcmp(a->word, b->word) > 0;
+}
+/*
+*   FUNCTION: bkTreeBuild
+*   @param1 hashTable: Pointer to the HashTable
+*   @returns a pointer to the created BK-Tree
+*
+*   INFO: Creates a BK-Tree (Burkhard-Keller Tree) over the words in the
+*         HashTable. Each child of a node is labelled with its edit
+*         distance to the node, which lets queries skip whole subtrees.
+*         Words are inserted in the order of their addresses.
+*/
+BKTree_t* bkTreeBuild(HashTable_t* hashTable) {
+    BKTree_t* tree = malloc( sizeof(BKTree_t) );
+
+    if(tree == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tree->count = 0;
+    tree->capacity = 1024;
+    tree->renumbered = 0;
+    tree->renumberEnd = 0;
+    tree->nodes = malloc( tree->capacity * sizeof(BKNode_t) );
+
+    if(tree->nodes == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    for(i=0; i<hashTable->size; i++) {
+        if(hashTable->slots[i].length != 0) {
+            bkTreeInsert(tree, hashTable, i);
+        }
+    }
+    return tree;
+}
+/*
+*   FUNCTION: bkTreeInsert
+*   @param1 tree: Pointer to the BK-Tree
+*   @param2 hashTable: Pointer to the HashTable that holds the words
+*   @param3 wordIndex: Address of the word to insert
+*   @returns nothing
+*
+*   INFO: Walks down the tree following the edges that are equal to the
+*         distance between the new word and each visited node, then
+*         attaches the word as a new leaf.
+*/
+void bkTreeInsert(BKTree_t* tree, HashTable_t* hashTable, int wordIndex) {
+
+    if(tree->count == tree->capacity) {
+        tree->capacity *= 2;
+        tree->nodes = realloc(tree->nodes, tree->capacity * sizeof(BKNode_t));
+
+        if(tree->nodes == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int newNode = tree->count++;
+    tree->nodes[newNode].wordIndex = wordIndex;
+    tree->nodes[newNode].firstChild = -1;
+    tree->nodes[newNode].nextSibling = -1;
+    tree->nodes[newNode].edge = 0;
+
+    // The first word becomes the root.
+    if(newNode == 0) return;
+
+    EditPattern_t pattern;
+    editPatternInit(&pattern, hashTableGetWord(hashTable, wordIndex));
+
+    int current = 0;
+
+    while(1) {
+        short dist = getEditDistancePattern(&pattern, hashTableGetWord(hashTable, bkTreeGetAddress(tree, hashTable, current)));
+        int child = tree->nodes[current].firstChild;
+
+        while(child != -1 && tree->nodes[child].edge != dist) {
+            child = tree->nodes[child].nextSibling;
+        }
+
+        if(child == -1) {
+            // No child at this distance yet, attach the word here.
+            tree->nodes[newNode].edge = dist;
+            tree->nodes[newNode].nextSibling = tree->nodes[current].firstChild;
+            tree->nodes[current].firstChild = newNode;
+            editPatternRelease(&pattern);
+            return;
+        }
+        current = child;
+    }
+}
+// The nodes that hold an address of the table before it grew are looked up in the new addresses of its slots
+int bkTreeGetAddress(BKTree_t* tree, HashTable_t* hashTable, int node) {
+    int addr = tree->nodes[node].wordIndex;
+
+    if(node >= tree->renumbered && node < tree->renumberEnd) {
+        addr = hashTable->oldAddresses[addr];
+    }
+    return addr;
+}
+void bkTreeFree(BKTree_t* tree) {
+    if(tree == NULL) return;
+    if(tree->capacity != 0) free(tree->nodes);
+    free(tree);
+}
+/*
+*   FUNCTION: findMostSimilarWordSymSpell
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3(return parameter) wordFound: The pointer that the address
+*                                       of the most similar word found
+*                                       will be copied into
+*   @returns the distance, or MAX_DIST_ALLOWED + 1 if no word is
+*            within MAX_DIST_ALLOWED of the key
+*
+*   INFO: Symmetric deletion search (SymSpell). Two words within edit
+*         distance n always share a string that is obtained from each of
+*         them by at most n deletions, so the words whose deletions
+*         collide with a deletion of the key are the only candidates
+*         within the index's distance. Ties between the candidates are
+*         broken by hashTableRanksBefore, as in findMostSimilarWordLinear. When
+*         nothing is found within the
+*         index's distance the BK-Tree covers the rest of MAX_DIST_ALLOWED.
+*/
+short findMostSimilarWordSymSpell(HashTable_t* hashTable, char* key, char** wordFound) {
+    DeleteIndex_t* index = hashTable->deleteIndex;
+
+    int candidateCapacity = 256;
+    int* candidates = malloc( candidateCapacity * sizeof(int) );
+
+    if(candidates == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int candidateCount = deleteIndexGetCandidates(hashTable, key, &candidates, &candidateCapacity);
+
+    short min = MAX_DIST_ALLOWED + 1, dist;
+    int i, minIndex = -1;
+    *wordFound = NULL;
+
+    for(i=0; i<candidateCount && min > 0; i++) {
+        char* word = hashTableGetWord(hashTable, candidates[i]);
+        short bound = (minIndex != -1 && hashTableRanksBefore(hashTable, candidates[i], minIndex)) ? min : min - 1;
+        dist = getEditDistanceMetric(word, key, bound);
+
+        if(dist <= bound) {
+            min = dist;
+            minIndex = candidates[i];
+            *wordFound = word;
+        }
+    }
+    free(candidates);
+
+    // Closer words that the index can not see may exist only beyond its distance.
+    if(min > index->maxDeletes && index->maxDeletes < MAX_DIST_ALLOWED) {
+        if(distanceMetric == METRIC_UNIT && hashTable->bkTree != NULL) {
+            return findMostSimilarWordBKTree(hashTable, key, wordFound);
+        }
+        return findMostSimilarWordLinear(hashTable, key, wordFound);
+    }
+    return min;
+}
+/*
+*   FUNCTION: deleteIndexGetCandidates
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3(return parameter) candidates: Array the addresses are written
+*                                        into, grown with realloc if needed
+*   @param4(return parameter) capacity: Allocated length of the array
+*   @returns the number of candidates
+*
+*   INFO: Looks up the hash of every deletion of the key in each run of
+*         the deletion index, and returns the addresses of the words
+*         found, sorted and without repetitions. Every word within the
+*         deletion distance of the index is among them.
+*/
+int deleteIndexGetCandidates(HashTable_t* hashTable, char* key, int** candidates, int* capacity) {
+    DeleteIndex_t* index = hashTable->deleteIndex;
+
+    int hashCapacity = 256;
+    unsigned int* hashes = malloc( hashCapacity * sizeof(unsigned int) );
+    int hashCount = getDeletionHashes(key, index->maxDeletes, &hashes, &hashCapacity);
+    int count = 0;
+
+    // The words added at run time are in smaller runs than the words the index was built with.
+    DeleteRun_t* runs[1 + 3 * DELETE_INDEX_LEVELS];
+    int runCount = deleteIndexGetRuns(index, runs, false);
+    int i, j;
+    for(i=0; i<hashCount * runCount; i++) {
+        unsigned int hash = hashes[i / runCount];
+        DeleteRun_t* run = runs[i % runCount];
+
+        // Find the first entry of the hash in the run
+        int lo = 0, hi = run->count;
+        while(lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if(run->hashes[mid] < hash) lo = mid + 1;
+            else hi = mid;
+        }
+
+        for(j = lo; j < run->count && run->hashes[j] == hash; j++) {
+            int addr = deleteRunGetAddress(run, hashTable, j);
+
+            // The entries of a mapped file are only checked here
+            if(addr < 0 || addr >= hashTable->size || hashTable->slots[addr].length == 0) continue;
+
+            if(count == *capacity) {
+                *capacity *= 2;
+                *candidates = realloc(*candidates, *capacity * sizeof(int));
+
+                if(*candidates == NULL) {
+                    printf("ERROR: Could not allocate memory.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (*candidates)[count++] = addr;
+        }
+    }
+    free(hashes);
+
+    qsort(*candidates, count, sizeof(int), compareInts);
+
+    // Drop the repetitions
+    int unique = 0;
+    for(i=0; i<count; i++) {
+        if(unique == 0 || (*candidates)[i] != (*candidates)[unique - 1]) {
+            (*candidates)[unique++] = (*candidates)[i];
+        }
+    }
+    return unique;
+}
+/*
+*   FUNCTION: deleteIndexBuild
+*   @param1 hashTable: Pointer to the HashTable
+*   @param2 maxDeletes: Largest number of deletions to apply to each word
+*   @returns a pointer to the created index
+*
+*   INFO: Generates every string that can be obtained by deleting up to
+*         maxDeletes characters of each word (the word itself included)
+*         and stores the hash of each one along with the address of the
+*         word, sorted by hash. Only the hashes are kept, so a collision
+*         can only add a candidate, which is then verified by its edit
+*         distance.
+*/
+DeleteIndex_t* deleteIndexBuild(HashTable_t* hashTable, int maxDeletes) {
+    int entryCapacity = 1024, count = 0;
+    DeleteEntry_t* entries = malloc( entryCapacity * sizeof(DeleteEntry_t) );
+
+    int capacity = 256;
+    unsigned int* hashes = malloc( capacity * sizeof(unsigned int) );
+
+    if(entries == NULL || hashes == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i, j;
+    for(i=0; i<hashTable->size; i++) {
+        if(hashTable->slots[i].length == 0) continue;
+
+        int hashCount = getDeletionHashes(hashTableGetWord(hashTable, i), maxDeletes, &hashes, &capacity);
+
+        for(j=0; j<hashCount; j++) {
+            if(count == entryCapacity) {
+                entryCapacity *= 2;
+                entries = realloc(entries, entryCapacity * sizeof(DeleteEntry_t));
+
+                if(entries == NULL) {
+                    printf("ERROR: Could not allocate memory.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            entries[count].hash = hashes[j];
+            entries[count].wordIndex = i;
+            count++;
+        }
+    }
+    free(hashes);
+
+    qsort(entries, count, sizeof(DeleteEntry_t), compareDeleteEntries);
+
+    DeleteRun_t run = {malloc( (count + 1) * sizeof(unsigned int) ), malloc( (count + 1) * sizeof(int) ), 0, count + 1, 0, 0};
+
+    if(run.hashes == NULL || run.wordIndices == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Copy the entries, dropping the repeated ones (e.g. "hello" minus either "l")
+    for(i=0; i<count; i++) {
+        if(i > 0 && entries[i].hash == entries[i-1].hash && entries[i].wordIndex == entries[i-1].wordIndex) {
+            continue;
+        }
+        run.hashes[run.count] = entries[i].hash;
+        run.wordIndices[run.count] = entries[i].wordIndex;
+        run.count++;
+    }
+    free(entries);
+
+    return deleteIndexCreate(maxDeletes, &run);
+}
+/*
+*   FUNCTION: deleteIndexCreate
+*   @param1 maxDeletes: Largest number of deletions applied to the words
+*   @param2 run: Sorted entries of the words, built or mapped from a file
+*   @returns a pointer to the created index
+*
+*   INFO: The run is put into the lowest level whose runs may be as
+*         large, so the runs of the words added at run time only reach
+*         it once they are about as large themselves.
+*/
+DeleteIndex_t* deleteIndexCreate(int maxDeletes, DeleteRun_t* run) {
+    DeleteIndex_t* index = calloc(1, sizeof(DeleteIndex_t));
+
+    if(index == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    index->maxDeletes = maxDeletes;
+
+    int level = 0;
+    while(level < DELETE_INDEX_LEVELS - 1 && (long long) DELETE_INDEX_RUN_SIZE << level < run->count) {
+        level++;
+    }
+    deleteIndexAddRun(index, NULL, level, run);
+
+    return index;
+}
+void deleteIndexFree(DeleteIndex_t* index) {
+    if(index == NULL) return;
+
+    DeleteRun_t* runs[1 + 3 * DELETE_INDEX_LEVELS];
+    int runCount = deleteIndexGetRuns(index, runs, true), i;
+
+    for(i=0; i<runCount; i++) {
+        if(runs[i]->capacity != 0) {
+            free(runs[i]->hashes);
+            free(runs[i]->wordIndices);
+        }
+    }
+    free(index);
+}
+// The insertion run comes first, then the runs of each level from the lowest one
+int deleteIndexGetRuns(DeleteIndex_t* index, DeleteRun_t** runs, bool outputs) {
+    int count = 0, level, i;
+
+    if(index->insertRun.count > 0 || (outputs && index->insertRun.capacity != 0)) {
+        runs[count++] = &index->insertRun;
+    }
+    for(level=0; level<DELETE_INDEX_LEVELS; level++) {
+        DeleteLevel_t* l = &index->levels[level];
+
+        for(i=0; i<l->runCount; i++) {
+            runs[count++] = &l->runs[i];
+        }
+        if(outputs && l->runCount == 2) {
+            runs[count++] = &l->output;
+        }
+    }
+    return count;
+}
+int deleteRunGetAddress(DeleteRun_t* run, HashTable_t* hashTable, int entry) {
+    int addr = run->wordIndices[entry];
+
+    if(entry >= run->renumbered && entry < run->renumberEnd) {
+        addr = hashTable->oldAddresses[addr];
+    }
+    return addr;
+}
+/*
+*   FUNCTION: deleteIndexInsert
+*   @param1 index: Pointer to a deletion index on the heap
+*   @param2 hashTable: Pointer to the HashTable that holds the words
+*   @param3 wordIndex: Address of the word
+*   @returns nothing
+*
+*   INFO: Merges the sorted deletion hashes of the word into the
+*         insertion run, from its end, so at most DELETE_INDEX_RUN_SIZE
+*         entries are moved. A full insertion run becomes a run of the
+*         first level. The runs form levels as in a log-structured merge
+*         tree: once a level has two runs, they are merged into a run of
+*         the next level, so each entry is copied once per level, about
+*         log2(entries / DELETE_INDEX_RUN_SIZE) times in all. Each merge
+*         writes DELETE_INDEX_MERGE_PACE entries for every entry inserted
+*         and is done before its level receives another run, so no word
+*         pays for a whole merge.
+*/
+void deleteIndexInsert(DeleteIndex_t* index, HashTable_t* hashTable, int wordIndex) {
+    DeleteRun_t* run = &index->insertRun;
+    int hashCapacity = 256;
+    unsigned int* hashes = malloc( hashCapacity * sizeof(unsigned int) );
+
+    if(hashes == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int count = getDeletionHashes(hashTableGetWord(hashTable, wordIndex), index->maxDeletes, &hashes, &hashCapacity);
+    int i, unique = 0;
+
+    qsort(hashes, count, sizeof(unsigned int), compareUnsignedInts);
+
+    for(i=0; i<count; i++) {
+        if(unique == 0 || hashes[i] != hashes[unique - 1]) {
+            hashes[unique++] = hashes[i];
+        }
+    }
+
+    if(run->count + unique > run->capacity) {
+        while(run->count + unique > run->capacity) {
+            run->capacity = (run->capacity < 1024) ? 1024 : run->capacity * 2;
+        }
+        run->hashes = realloc(run->hashes, run->capacity * sizeof(unsigned int));
+        run->wordIndices = realloc(run->wordIndices, run->capacity * sizeof(int));
+
+        if(run->hashes == NULL || run->wordIndices == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int old = run->count - 1, next = unique - 1, k = run->count + unique - 1;
+
+    while(next >= 0) {
+        if(old >= 0 && run->hashes[old] > hashes[next]) {
+            run->hashes[k] = run->hashes[old];
+            run->wordIndices[k] = run->wordIndices[old];
+            old--;
+        } else {
+            run->hashes[k] = hashes[next];
+            run->wordIndices[k] = wordIndex;
+            next--;
+        }
+        k--;
+    }
+    run->count += unique;
+    free(hashes);
+
+    if(run->count >= DELETE_INDEX_RUN_SIZE) {
+        DeleteRun_t full = *run;
+
+        memset(run, 0, sizeof(DeleteRun_t));
+        deleteIndexAddRun(index, hashTable, 0, &full);
+    }
+
+    int level;
+    for(level=0; level<DELETE_INDEX_LEVELS; level++) {
+        if(index->levels[level].runCount == 2) {
+            deleteIndexMergeStep(index, hashTable, level, unique * DELETE_INDEX_MERGE_PACE);
+        }
+    }
+}
+// Only happens to a level that already merges two runs if the merge fell behind, it is then completed first
+void deleteIndexAddRun(DeleteIndex_t* index, HashTable_t* hashTable, int level, DeleteRun_t* run) {
+    DeleteLevel_t* l = &index->levels[level];
+
+    if(l->runCount == 2) {
+        deleteIndexMergeStep(index, hashTable, level, INT_MAX);
+    }
+    l->runs[l->runCount++] = *run;
+
+    if(l->runCount == 2) {
+        int capacity = l->runs[0].count + l->runs[1].count + 1;
+        DeleteRun_t output = {malloc( capacity * sizeof(unsigned int) ), malloc( capacity * sizeof(int) ), 0, capacity, 0, 0};
+
+        if(output.hashes == NULL || output.wordIndices == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        l->output = output;
+        l->first = 0;
+        l->second = 0;
+    }
+}
+/*
+*   FUNCTION: deleteIndexMergeStep
+*   @param1 index: Pointer to the deletion index
+*   @param2 hashTable: Pointer to the HashTable that holds the words
+*   @param3 level: Level whose two runs are being merged
+*   @param4 count: Largest number of entries to merge
+*   @returns nothing
+*
+*   INFO: The runs are still searched until the merge is complete, the
+*         output is not. Entries that hold an address of the table
+*         before it grew are written with their new address. The
+*         complete output replaces the two runs and moves up a level
+*         (the last level keeps it).
+*/
+void deleteIndexMergeStep(DeleteIndex_t* index, HashTable_t* hashTable, int level, int count) {
+    DeleteLevel_t* l = &index->levels[level];
+    DeleteRun_t *first = &l->runs[0], *second = &l->runs[1], *output = &l->output;
+
+    while(count-- > 0 && (l->first < first->count || l->second < second->count)) {
+        if(l->second == second->count || (l->first < first->count && first->hashes[l->first] <= second->hashes[l->second])) {
+            output->hashes[output->count] = first->hashes[l->first];
+            output->wordIndices[output->count++] = deleteRunGetAddress(first, hashTable, l->first++);
+        } else {
+            output->hashes[output->count] = second->hashes[l->second];
+            output->wordIndices[output->count++] = deleteRunGetAddress(second, hashTable, l->second++);
+        }
+    }
+
+    if(l->first < first->count || l->second < second->count) {
+        return;
+    }
+
+    if(first->capacity != 0) {
+        free(first->hashes);
+        free(first->wordIndices);
+    }
+    if(second->capacity != 0) {
+        free(second->hashes);
+        free(second->wordIndices);
+    }
+
+    DeleteRun_t merged = *output;
+    memset(output, 0, sizeof(DeleteRun_t));
+    l->runCount = 0;
+
+    if(level + 1 < DELETE_INDEX_LEVELS) {
+        deleteIndexAddRun(index, hashTable, level + 1, &merged);
+    } else {
+        l->runs[l->runCount++] = merged;
+    }
+}
+/*
+*   FUNCTION: deleteIndexMerge
+*   @param1 index: Pointer to the deletion index
+*   @param2 hashTable: Pointer to the HashTable that holds the words
+*   @returns the only run left, or NULL if the index has no entry
+*
+*   INFO: Completes the merges in progress and moves each run that is
+*         left alone up to the next run, from the lowest level, so the
+*         smaller runs are merged before the largest one. Used before
+*         the index is saved as a single sorted array.
+*/
+DeleteRun_t* deleteIndexMerge(DeleteIndex_t* index, HashTable_t* hashTable) {
+    DeleteRun_t* last = NULL;
+    int level, above;
+
+    if(index->insertRun.count > 0) {
+        DeleteRun_t full = index->insertRun;
+
+        memset(&index->insertRun, 0, sizeof(DeleteRun_t));
+        deleteIndexAddRun(index, hashTable, 0, &full);
+    } else if(index->insertRun.capacity != 0) {
+        free(index->insertRun.hashes);
+        free(index->insertRun.wordIndices);
+        memset(&index->insertRun, 0, sizeof(DeleteRun_t));
+    }
+
+    for(level=0; level<DELETE_INDEX_LEVELS; level++) {
+        DeleteLevel_t* l = &index->levels[level];
+
+        if(l->runCount == 2) {
+            deleteIndexMergeStep(index, hashTable, level, INT_MAX);
+        }
+        if(l->runCount == 0) continue;
+
+        for(above=level + 1; above<DELETE_INDEX_LEVELS && index->levels[above].runCount == 0; above++);
+
+        if(above == DELETE_INDEX_LEVELS) {
+            last = &l->runs[0];
+            break;
+        }
+
+        // Nothing is left to merge it with below, it joins the next run above
+        DeleteRun_t run = l->runs[0];
+        l->runCount = 0;
+        deleteIndexAddRun(index, hashTable, above, &run);
+        level = above - 1;
+    }
+    return last;
+}
+/*
+*   FUNCTION: findMostSimilarWordQGram
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3(return parameter) wordFound: The pointer that the address
+*                                       of the most similar word found
+*                                       will be copied into
+*   @returns the distance, or MAX_DIST_ALLOWED + 1 if no word is
+*            within MAX_DIST_ALLOWED of the key
+*
+*   INFO: Asks the q-gram index for the words within 1 edit, then 2 and
+*         so on, and stops at the first distance that has a word. The
+*         first filters only let through words of nearly the same length
+*         that share most bigrams with the key, so a common misspelling
+*         is verified against a handful of words. Every word within the
+*         distance of a round is among its candidates, and ties between
+*         them are broken by hashTableRanksBefore, as in
+*         findMostSimilarWordLinear.
+*/
+short findMostSimilarWordQGram(HashTable_t* hashTable, char* key, char** wordFound) {
+    int candidateCapacity = 256;
+    int* candidates = malloc( candidateCapacity * sizeof(int) );
+
+    if(candidates == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    short min = MAX_DIST_ALLOWED + 1, dist, round;
+    int i, minIndex;
+
+    for(round = 1; round <= MAX_DIST_ALLOWED; round++) {
+        int candidateCount = qgramIndexGetCandidates(hashTable, key, round, &candidates, &candidateCapacity);
+
+        // Only the words within the distance of the round are sure to be among the candidates
+        min = round + 1;
+        minIndex = -1;
+        *wordFound = NULL;
+
+        for(i=0; i<candidateCount && min > 0; i++) {
+            char* word = hashTableGetWord(hashTable, candidates[i]);
+            short bound = (minIndex != -1 && hashTableRanksBefore(hashTable, candidates[i], minIndex)) ? min : min - 1;
+            dist = getEditDistanceMetric(word, key, bound);
+
+            if(dist <= bound) {
+                min = dist;
+                minIndex = candidates[i];
+                *wordFound = word;
+            }
+        }
+        if(min <= round) break;
+    }
+    free(candidates);
+
+    return min;
+}
+// Offers the candidates of the q-gram index within the bound of the heap to the heap
+void findMostSimilarWordsQGram(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap) {
+    int candidateCapacity = 256;
+    int* candidates = malloc( candidateCapacity * sizeof(int) );
+
+    if(candidates == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int candidateCount = qgramIndexGetCandidates(hashTable, key, suggestionHeapBound(heap), &candidates, &candidateCapacity);
+    int i;
+
+    for(i=0; i<candidateCount; i++) {
+        short bound = suggestionHeapBound(heap);
+        short dist = getEditDistanceMetric(hashTableGetWord(hashTable, candidates[i]), key, bound);
+
+        if(dist <= bound) {
+            suggestionHeapPush(heap, hashTable, candidates[i], dist);
+        }
+    }
+    free(candidates);
+}
+/*
+*   FUNCTION: qgramIndexGetCandidates
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The word that is being searched
+*   @param3 maxDist: Largest distance of interest
+*   @param4(return parameter) candidates: Array the addresses are written
+*                                        into, grown with realloc if needed
+*   @param5(return parameter) capacity: Allocated length of the array
+*   @returns the number of candidates
+*
+*   INFO: Count filtering. The key and the words are padded, so a word
+*         of length n has n + 1 bigrams. An edit changes at most 2 of the
+*         bigrams of the longer string, and a swap at most 3, so a word
+*         within maxDist shares at least
+*             max(keyLen, len) + 1 - maxDist * 2 (or 3)
+*         bigrams with the key. Only the lengths within maxDist of the
+*         key are looked at; for each, the lists of the key's bigrams are
+*         merged from the shortest to the longest, counting the bigrams
+*         every address shares. A bigram the key has twice counts twice,
+*         which can only let more words through. Once the lists left can
+*         not bring an address to the threshold it is dropped, and
+*         addresses only found in the last lists are never added. When
+*         the threshold is not above zero, every word of the length is a
+*         candidate. The words added at run time are always candidates.
+*/
+int qgramIndexGetCandidates(HashTable_t* hashTable, char* key, short maxDist, int** candidates, int* capacity) {
+    QGramIndex_t* index = hashTable->qgramIndex;
+    int keyLen = strlen(key);
+    int count = 0;
+
+    if(keyLen > CONSOLE_INPUT_LENGTH + MAX_DIST_ALLOWED) {
+        return 0;
+    }
+
+    // The distinct bigrams of the key, each with the number of times the key has it
+    int grams[2 * CONSOLE_INPUT_LENGTH], weights[2 * CONSOLE_INPUT_LENGTH];
+    int gramCount = getQGrams(key, keyLen, grams);
+    int distinct = 0, i, j;
+
+    qsort(grams, gramCount, sizeof(int), compareInts);
+
+    for(i=0; i<gramCount; i++) {
+        if(distinct > 0 && grams[distinct - 1] == grams[i]) {
+            weights[distinct - 1]++;
+        } else {
+            grams[distinct] = grams[i];
+            weights[distinct++] = 1;
+        }
+    }
+
+    unsigned int *list = NULL, *ids = NULL, *outIds = NULL;
+    unsigned short *counts = NULL, *outCounts = NULL;
+    int listCapacity = 0, idsCapacity = 0, outIdsCapacity = 0, countsCapacity = 0, outCountsCapacity = 0;
+    int perEdit = (distanceMetric == METRIC_DAMERAU) ? 3 : 2;
+    int len;
+
+    for(len = keyLen - maxDist; len <= keyLen + maxDist; len++) {
+        if(len < 1 || len >= CONSOLE_INPUT_LENGTH) continue;
+
+        int base = len * (QGRAM_COUNT + 1);
+        int threshold = ((len > keyLen) ? len : keyLen) + 1 - maxDist * perEdit;
+        int found = 0;
+
+        if(threshold <= 0) {
+            int listLength = index->listOffsets[base + QGRAM_COUNT + 1] - index->listOffsets[base + QGRAM_COUNT];
+
+            // A varint is at least one byte, so a list has at most as many addresses as bytes
+            editScratchReserve((void**) &ids, &idsCapacity, listLength, sizeof(unsigned int));
+            found = qgramIndexDecodeList(index, base + QGRAM_COUNT, ids);
+
+        } else {
+            // The lists of the bigrams of the key for this length, shortest first
+            int order[2 * CONSOLE_INPUT_LENGTH];
+            int remaining = 0, longest = 0;
+
+            for(i=0; i<distinct; i++) {
+                int listLength = index->listOffsets[base + grams[i] + 1] - index->listOffsets[base + grams[i]];
+                int weight = weights[i];
+
+                for(j=i; j>0 && (int) (index->listOffsets[base + grams[order[j-1]] + 1] - index->listOffsets[base + grams[order[j-1]]]) > listLength; j--) {
+                    order[j] = order[j-1];
+                }
+                order[j] = i;
+
+                remaining += weight;
+                if(listLength > longest) longest = listLength;
+            }
+
+            if(remaining < threshold) continue;
+
+            editScratchReserve((void**) &list, &listCapacity, longest, sizeof(unsigned int));
+
+            for(i=0; i<distinct; i++) {
+                int g = order[i];
+                int listCount = qgramIndexDecodeList(index, base + grams[g], list);
+
+                remaining -= weights[g];
+
+                editScratchReserve((void**) &outIds, &outIdsCapacity, found + listCount, sizeof(unsigned int));
+                editScratchReserve((void**) &outCounts, &outCountsCapacity, found + listCount, sizeof(unsigned short));
+
+                found = qgramMergeList(ids, counts, found, list, listCount, weights[g], remaining, threshold, outIds, outCounts);
+
+                unsigned int* swapIds = ids;
+                ids = outIds;
+                outIds = swapIds;
+
+                unsigned short* swapCounts = counts;
+                counts = outCounts;
+                outCounts = swapCounts;
+
+                int swapCapacity = idsCapacity;
+                idsCapacity = outIdsCapacity;
+                outIdsCapacity = swapCapacity;
+
+                swapCapacity = countsCapacity;
+                countsCapacity = outCountsCapacity;
+                outCountsCapacity = swapCapacity;
+            }
+        }
+
+        if(count + found > *capacity) {
+            while(count + found > *capacity) *capacity *= 2;
+            *candidates = realloc(*candidates, *capacity * sizeof(int));
+
+            if(*candidates == NULL) {
+                printf("ERROR: Could not allocate memory.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        // Lists that still hold the addresses of the table before it grew are counted in those
+        for(i=0; i<found; i++) {
+            (*candidates)[count++] = index->renumbering ? hashTable->oldAddresses[ ids[i] ] : (int) ids[i];
+        }
+    }
+    free(list);
+    free(ids);
+    free(outIds);
+    free(counts);
+    free(outCounts);
+
+    for(i=0; i<index->pendingCount; i++) {
+        int addr = index->pending[i];
+        int lengthDiff = hashTable->slots[addr].length - keyLen;
+
+        if(lengthDiff < -maxDist || lengthDiff > maxDist) continue;
+
+        if(count == *capacity) {
+            *capacity *= 2;
+            *candidates = realloc(*candidates, *capacity * sizeof(int));
+
+            if(*candidates == NULL) {
+                printf("ERROR: Could not allocate memory.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        (*candidates)[count++] = addr;
+    }
+    return count;
+}
+int qgramIndexDecodeList(QGramIndex_t* index, int list, unsigned int* ids) {
+    unsigned char* p = index->postings + index->listOffsets[list];
+    unsigned char* end = index->postings + index->listOffsets[list + 1];
+    unsigned int value = 0;
+    int count = 0;
+
+    while(p < end) {
+        unsigned int delta = *p & 0x7F;
+        int shift = 7;
+
+        while(*p++ & 0x80) {
+            delta |= (unsigned int) (*p & 0x7F) << shift;
+            shift += 7;
+        }
+        value += delta;
+        ids[count++] = value;
+    }
+    return count;
+}
+/*
+*   FUNCTION: qgramMergeList
+*   @param1 ids: Addresses counted so far, in ascending order
+*   @param2 counts: Number of bigrams each address shares with the key
+*   @param3 count: Number of addresses
+*   @param4 list: Addresses of a posting list, in ascending order
+*   @param5 listCount: Number of addresses in the list
+*   @param6 weight: Number of times the key has the bigram of the list
+*   @param7 remaining: Sum of the weights of the lists not merged yet
+*   @param8 threshold: Count an address needs to be a candidate
+*   @param9(return parameter) outIds: At least count + listCount addresses
+*   @param10(return parameter) outCounts: Same as above, for the counts
+*   @returns the number of addresses written
+*
+*   INFO: A merge of two sorted arrays whose loop has no branch besides
+*         its condition: each step writes the smaller address and moves
+*         the output only if its count can still reach the threshold, so
+*         the compiler turns the choices into conditional moves and the
+*         loop is not slowed down by mispredicted branches.
+*/
+int qgramMergeList(unsigned int* ids, unsigned short* counts, int count, unsigned int* list, int listCount, int weight, int remaining, int threshold, unsigned int* outIds, unsigned short* outCounts) {
+    int i = 0, j = 0, n = 0;
+
+    while(i < count && j < listCount) {
+        unsigned int x = ids[i], y = list[j];
+        int fromIds = (x <= y), fromList = (y <= x);
+        int c = (fromIds ? counts[i] : 0) + (fromList ? weight : 0);
+
+        outIds[n] = fromIds ? x : y;
+        outCounts[n] = c;
+        n += (c + remaining >= threshold);
+        i += fromIds;
+        j += fromList;
+    }
+    for( ; i < count; i++) {
+        outIds[n] = ids[i];
+        outCounts[n] = counts[i];
+        n += (counts[i] + remaining >= threshold);
+    }
+    if(weight + remaining >= threshold) {
+        for( ; j < listCount; j++) {
+            outIds[n] = list[j];
+            outCounts[n++] = weight;
+        }
+    }
+    return n;
+}
+/*
+*   FUNCTION: qgramIndexBuild
+*   @param1 hashTable: Pointer to the HashTable
+*   @returns a pointer to the created index
+*
+*   INFO: Every word is put into the list of its length and each of its
+*         distinct bigrams, and into the list of all the words of its
+*         length. The words are visited in the order of their addresses,
+*         so the lists come out sorted and are stored as differences in
+*         varints, mostly one byte per address. The offsets and the
+*         postings are a single block, written as one section of the
+*         dictionary file.
+*/
+QGramIndex_t* qgramIndexBuild(HashTable_t* hashTable) {
+    QGramIndex_t* index = malloc( sizeof(QGramIndex_t) );
+    unsigned int* counts = calloc(QGRAM_LISTS + 1, sizeof(unsigned int));
+
+    if(index == NULL || counts == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int lists[CONSOLE_INPUT_LENGTH + 2];
+    int addr, i;
+
+    // Count the addresses of each list
+    for(addr=0; addr<hashTable->size; addr++) {
+        if(hashTable->slots[addr].length == 0) continue;
+
+        int listCount = qgramGetLists(hashTable, addr, lists);
+
+        for(i=0; i<listCount; i++) {
+            counts[lists[i] + 1]++;
+        }
+    }
+
+    // Place the lists one after another and fill them in the order of the addresses
+    for(i=0; i<QGRAM_LISTS; i++) {
+        counts[i + 1] += counts[i];
+    }
+
+    unsigned int* ids = malloc( (counts[QGRAM_LISTS] + 1) * sizeof(unsigned int) );
+    unsigned int* next = malloc( QGRAM_LISTS * sizeof(unsigned int) );
+
+    if(ids == NULL || next == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(next, counts, QGRAM_LISTS * sizeof(unsigned int));
+
+    for(addr=0; addr<hashTable->size; addr++) {
+        if(hashTable->slots[addr].length == 0) continue;
+
+        int listCount = qgramGetLists(hashTable, addr, lists);
+
+        for(i=0; i<listCount; i++) {
+            ids[ next[lists[i]]++ ] = addr;
+        }
+    }
+    free(next);
+
+    // Encode the differences, the size is known after a first pass
+    unsigned char bytes[5];
+    unsigned int postingsLength = 0, previous = 0, j;
+    int list;
+
+    for(list=0; list<QGRAM_LISTS; list++) {
+        for(j=counts[list], previous=0; j<counts[list + 1]; j++) {
+            postingsLength += varintEncode(ids[j] - previous, bytes);
+            previous = ids[j];
+        }
+    }
+
+    size_t offsetsLength = (QGRAM_LISTS + 1) * sizeof(unsigned int);
+    unsigned char* block = malloc( offsetsLength + postingsLength );
+
+    if(block == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    index->listOffsets = (unsigned int*) block;
+    index->postings = block + offsetsLength;
+    index->postingsLength = postingsLength;
+
+    unsigned int offset = 0;
+
+    for(list=0; list<QGRAM_LISTS; list++) {
+        index->listOffsets[list] = offset;
+
+        for(j=counts[list], previous=0; j<counts[list + 1]; j++) {
+            offset += varintEncode(ids[j] - previous, index->postings + offset);
+            previous = ids[j];
+        }
+    }
+    index->listOffsets[QGRAM_LISTS] = offset;
+
+    free(ids);
+    free(counts);
+
+    index->pending = NULL;
+    index->pendingCount = 0;
+    index->pendingCapacity = 0;
+    index->mapped = false;
+    index->renumbering = false;
+    index->sealed = 0;
+    index->batchOffsets = NULL;
+    index->batchIds = NULL;
+    index->mergeBlock = NULL;
+    index->mergeLength = 0;
+    index->mergeList = 0;
+    index->mergeStep = 0;
+
+    return index;
+}
+// Writes the lists of the q-gram index a word belongs to, one per distinct bigram and the one of every word of its length, and returns their number
+int qgramGetLists(HashTable_t* hashTable, int addr, int* lists) {
+    int len = hashTable->slots[addr].length;
+    int grams[CONSOLE_INPUT_LENGTH + 1];
+    int gramCount = getQGrams(hashTableGetWord(hashTable, addr), len, grams);
+    int count = 0, i, j;
+
+    // A word has few bigrams, an insertion sort is faster than qsort on them
+    for(i=1; i<gramCount; i++) {
+        int gram = grams[i];
+
+        for(j=i; j>0 && grams[j-1] > gram; j--) {
+            grams[j] = grams[j-1];
+        }
+        grams[j] = gram;
+    }
+
+    for(i=0; i<gramCount; i++) {
+        if(i == 0 || grams[i] != grams[i-1]) lists[count++] = len * (QGRAM_COUNT + 1) + grams[i];
+    }
+    lists[count++] = len * (QGRAM_COUNT + 1) + QGRAM_COUNT;
+
+    return count;
+}
+void qgramIndexFree(QGramIndex_t* index) {
+    if(index == NULL) {
+        return;
+    }
+    if(!index->mapped) {
+        free(index->listOffsets);
+    }
+    free(index->pending);
+    free(index->batchOffsets);
+    free(index->batchIds);
+    free(index->mergeBlock);
+    free(index);
+}
+void qgramIndexInsert(QGramIndex_t* index, int wordIndex) {
+    if(index->pendingCount == index->pendingCapacity) {
+        index->pendingCapacity = (index->pendingCapacity == 0) ? 64 : index->pendingCapacity * 2;
+        index->pending = realloc(index->pending, index->pendingCapacity * sizeof(int));
+
+        if(index->pending == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    index->pending[index->pendingCount++] = wordIndex;
+}
+/*
+*   FUNCTION: qgramIndexSeal
+*   @param1 index: Pointer to a q-gram index on the heap, with no merge in progress
+*   @param2 hashTable: Pointer to the HashTable that holds the words
+*   @returns nothing
+*
+*   INFO: The pending words become the sealed ones, which
+*         qgramIndexMergeStep merges into the lists. They are sorted by
+*         address and spread over their lists with a counting sort, so
+*         the addresses of each list of the batch are ascending. The
+*         block of the merged lists is allocated at once: an address
+*         inserted into a list takes at most 5 bytes and never makes the
+*         difference after it longer, and lists that are renumbered take
+*         at most 5 bytes per address, of which there are fewer than
+*         bytes in the current postings. Words added meanwhile stay
+*         pending, and the merge is paced to finish within
+*         QGRAM_PENDING_SIZE / QGRAM_MERGE_PACE added words.
+*/
+void qgramIndexSeal(QGramIndex_t* index, HashTable_t* hashTable) {
+    int i, j;
+
+    qsort(index->pending, index->pendingCount, sizeof(int), compareInts);
+    index->sealed = index->pendingCount;
+
+    // The lists of each word, the ones of word i start at starts[i]
+    int* lists = malloc( (size_t) index->sealed * (CONSOLE_INPUT_LENGTH + 2) * sizeof(int) );
+    int* starts = malloc( (index->sealed + 1) * sizeof(int) );
+    unsigned int* offsets = calloc(QGRAM_LISTS + 1, sizeof(unsigned int));
+    unsigned int* next = malloc( QGRAM_LISTS * sizeof(unsigned int) );
+
+    if(lists == NULL || starts == NULL || offsets == NULL || next == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    starts[0] = 0;
+    for(i=0; i<index->sealed; i++) {
+        starts[i + 1] = starts[i] + qgramGetLists(hashTable, index->pending[i], lists + starts[i]);
+
+        for(j=starts[i]; j<starts[i + 1]; j++) {
+            offsets[lists[j] + 1]++;
+        }
+    }
+    for(i=0; i<QGRAM_LISTS; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    unsigned int batchCount = offsets[QGRAM_LISTS];
+    unsigned int* ids = malloc( (batchCount + 1) * sizeof(unsigned int) );
+
+    if(ids == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(next, offsets, QGRAM_LISTS * sizeof(unsigned int));
+
+    for(i=0; i<index->sealed; i++) {
+        for(j=starts[i]; j<starts[i + 1]; j++) {
+            ids[ next[lists[j]]++ ] = index->pending[i];
+        }
+    }
+    free(next);
+    free(starts);
+    free(lists);
+
+    size_t offsetsLength = (QGRAM_LISTS + 1) * sizeof(unsigned int);
+    size_t postingsBound = (index->renumbering ? 5 * (size_t) index->postingsLength : index->postingsLength) + 5 * (size_t) batchCount;
+
+    index->batchOffsets = offsets;
+    index->batchIds = ids;
+    index->mergeBlock = malloc( offsetsLength + postingsBound );
+    index->mergeLength = 0;
+    index->mergeList = 0;
+    index->mergeStep = (index->postingsLength + batchCount) / (QGRAM_PENDING_SIZE / QGRAM_MERGE_PACE) + 1;
+
+    if(index->mergeBlock == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+/*
+*   FUNCTION: qgramIndexMergeStep
+*   @param1 index: Pointer to a q-gram index
+*   @param2 hashTable: Pointer to the HashTable that holds the words
+*   @param3 count: Bytes of postings and sealed addresses to merge before returning
+*   @returns nothing
+*
+*   INFO: Merges whole lists, the next one after the last one merged,
+*         until count is reached. Each list is decoded, given the new
+*         addresses of its words and sorted again if the table has grown,
+*         merged with the sealed addresses of the list and encoded into
+*         the new block. After the last list the new block replaces the
+*         current one and the sealed words leave the pending ones.
+*         Searches use the current lists until then.
+*/
+void qgramIndexMergeStep(QGramIndex_t* index, HashTable_t* hashTable, long long count) {
+    if(index->mergeBlock == NULL) {
+        return;
+    }
+
+    unsigned int* offsets = (unsigned int*) index->mergeBlock;
+    unsigned char* postings = index->mergeBlock + (QGRAM_LISTS + 1) * sizeof(unsigned int);
+    unsigned int *ids = NULL, *scratch = NULL;
+    int idsCapacity = 0, scratchCapacity = 0;
+    long long merged = 0;
+    int i;
+
+    while(merged < count && index->mergeList < QGRAM_LISTS) {
+        int list = index->mergeList++;
+        int listLength = index->listOffsets[list + 1] - index->listOffsets[list];
+        unsigned int start = index->batchOffsets[list], end = index->batchOffsets[list + 1];
+
+        // A varint is at least one byte, so a list has at most as many addresses as bytes
+        editScratchReserve((void**) &ids, &idsCapacity, listLength, sizeof(unsigned int));
+        int idCount = qgramIndexDecodeList(index, list, ids);
+
+        if(index->renumbering) {
+            for(i=0; i<idCount; i++) {
+                ids[i] = hashTable->oldAddresses[ ids[i] ];
+            }
+            editScratchReserve((void**) &scratch, &scratchCapacity, idCount, sizeof(unsigned int));
+            qgramSortAddresses(ids, scratch, idCount);
+        }
+
+        unsigned int previous = 0, j = start;
+        offsets[list] = index->mergeLength;
+
+        for(i=0; i<idCount || j<end; ) {
+            unsigned int value = (j == end || (i < idCount && ids[i] < index->batchIds[j])) ? ids[i++] : index->batchIds[j++];
+
+            index->mergeLength += varintEncode(value - previous, postings + index->mergeLength);
+            previous = value;
+        }
+        merged += listLength + (end - start);
+    }
+    free(ids);
+    free(scratch);
+
+    if(index->mergeList < QGRAM_LISTS) {
+        return;
+    }
+
+    offsets[QGRAM_LISTS] = index->mergeLength;
+
+    if(!index->mapped) {
+        free(index->listOffsets);
+    }
+    index->listOffsets = offsets;
+    index->postings = postings;
+    index->postingsLength = index->mergeLength;
+    index->mapped = false;
+    index->renumbering = false;
+
+    free(index->batchOffsets);
+    free(index->batchIds);
+    index->batchOffsets = NULL;
+    index->batchIds = NULL;
+    index->mergeBlock = NULL;
+
+    // The sealed words are the first pending ones
+    memmove(index->pending, index->pending + index->sealed, (index->pendingCount - index->sealed) * sizeof(int));
+    index->pendingCount -= index->sealed;
+    index->sealed = 0;
+}
+// Merges the words that are pending, and the merge in progress, into the lists at once
+void qgramIndexMerge(QGramIndex_t* index, HashTable_t* hashTable) {
+    qgramIndexMergeStep(index, hashTable, LLONG_MAX);
+
+    if(index->pendingCount > 0) {
+        qgramIndexSeal(index, hashTable);
+        qgramIndexMergeStep(index, hashTable, LLONG_MAX);
+    }
+}
+// Sorts addresses by their bytes from the lowest, stopping after the highest byte of the largest one
+void qgramSortAddresses(unsigned int* ids, unsigned int* scratch, int count) {
+    unsigned int *from = ids, *to = scratch;
+    unsigned int largest = 0;
+    int shift, i;
+
+    for(i=0; i<count; i++) {
+        if(ids[i] > largest) largest = ids[i];
+    }
+
+    for(shift=0; shift<32 && (largest >> shift) != 0; shift += 8) {
+        int starts[257] = {0};
+
+        for(i=0; i<count; i++) {
+            starts[((from[i] >> shift) & 0xFF) + 1]++;
+        }
+        for(i=0; i<256; i++) {
+            starts[i + 1] += starts[i];
+        }
+        for(i=0; i<count; i++) {
+            to[ starts[(from[i] >> shift) & 0xFF]++ ] = from[i];
+        }
+
+        unsigned int* swap = from;
+        from = to;
+        to = swap;
+    }
+    if(from != ids) {
+        memcpy(ids, from, count * sizeof(unsigned int));
+    }
+}
+/*
+*   FUNCTION: getQGrams
+*   @param1 word: The word
+*   @param2 len: Length of the word
+*   @param3(return parameter) grams: Array of at least len + 1 elements
+*   @returns the number of bigrams, len + 1
+*
+*   INFO: The word is padded with one character on each side, so the
+*         first and the last letter have a bigram of their own. The
+*         letters are numbered from 1, the padding is 0, and so is any
+*         other character, which can only make a key share more bigrams.
+*/
+int getQGrams(char* word, int len, int* grams) {
+    int previous = 0, i;
+
+    for(i=0; i<=len; i++) {
+        int current = (i < len && word[i] >= 'a' && word[i] <= 'z') ? word[i] - 'a' + 1 : 0;
+
+        grams[i] = previous * 27 + current;
+        previous = current;
+    }
+    return len + 1;
+}
+int varintEncode(unsigned int value, unsigned char* out) {
+    int count = 0;
+
+    while(value >= 0x80) {
+        out[count++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[count++] = value;
+
+    return count;
+}
+/*
+*   FUNCTION: dawgBuild
+*   @param1 words: The words, sorted by strcmp and without repetitions
+*   @param2 count: Number of words
+*   @returns a pointer to the created automaton
+*
+*   INFO: Builds the minimal automaton in a single pass (Daciuk et al.).
+*         Only the path of the last word is open. When the next word
+*         leaves it, the states below the common prefix can no longer
+*         change, so they are frozen deepest first: a state equal to an
+*         already frozen one (same finality, same labels to the same
+*         states) is replaced by it, any other state is appended to the
+*         flat arrays. The arrays are the final layout, the automaton is
+*         never copied.
+*/
+Dawg_t* dawgBuild(char** words, int count) {
+    Dawg_t* dawg = malloc( sizeof(Dawg_t) );
+
+    // The open path: the edges of the state at each depth, the last one of which is still being built
+    DawgEdge_t (*openEdges)[256] = malloc( (CONSOLE_INPUT_LENGTH + 1) * sizeof(*openEdges) );
+    int openCount[CONSOLE_INPUT_LENGTH + 1];
+    bool openFinal[CONSOLE_INPUT_LENGTH + 1];
+
+    int registrySize = 1024;
+    int* registry = malloc( registrySize * sizeof(int) );
+
+    if(dawg == NULL || openEdges == NULL || registry == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dawg->stateCount = 0;
+    dawg->edgeCount = 0;
+    dawg->wordCount = 0;
+    dawg->maxLength = 0;
+    dawg->stateCapacity = 1024;
+    dawg->edgeCapacity = 1024;
+    dawg->states = malloc( dawg->stateCapacity * sizeof(DawgState_t) );
+    dawg->edges = malloc( dawg->edgeCapacity * sizeof(DawgEdge_t) );
+    dawg->mapping = NULL;
+    dawg->mappingLength = 0;
+
+    if(dawg->states == NULL || dawg->edges == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(registry, -1, registrySize * sizeof(int));
+
+    openCount[0] = 0;
+    openFinal[0] = false;
+
+    char* previous = "";
+    int previousLen = 0;
+    int i, depth;
+
+    for(i=0; i<count; i++) {
+        char* word = words[i];
+        int len = strlen(word);
+
+        if(len >= CONSOLE_INPUT_LENGTH) continue;
+
+        int common = 0;
+        while(common < len && common < previousLen && word[common] == previous[common]) common++;
+
+        // Freeze the states of the previous word below the common prefix
+        for(depth = previousLen; depth > common; depth--) {
+            int state = dawgFreezeState(dawg, openEdges[depth], openCount[depth], openFinal[depth], &registry, &registrySize);
+            openEdges[depth - 1][openCount[depth - 1] - 1].target = state;
+        }
+
+        for(depth = common; depth < len; depth++) {
+            DawgEdge_t* edge = &openEdges[depth][openCount[depth]++];
+            edge->label = word[depth];
+            edge->target = 0;
+            memset(edge->reserved, 0, sizeof(edge->reserved));
+
+            openCount[depth + 1] = 0;
+            openFinal[depth + 1] = false;
+        }
+        openFinal[len] = true;
+
+        if(len > dawg->maxLength) dawg->maxLength = len;
+        dawg->wordCount++;
+        previous = word;
+        previousLen = len;
+    }
+
+    for(depth = previousLen; depth > 0; depth--) {
+        int state = dawgFreezeState(dawg, openEdges[depth], openCount[depth], openFinal[depth], &registry, &registrySize);
+        openEdges[depth - 1][openCount[depth - 1] - 1].target = state;
+    }
+    dawg->root = dawgFreezeState(dawg, openEdges[0], openCount[0], openFinal[0], &registry, &registrySize);
+
+    free(openEdges);
+    free(registry);
+    return dawg;
+}
+Dawg_t* dawgBuildFromTable(HashTable_t* hashTable) {
+    char** words = malloc( (hashTable->wordCount + 1) * sizeof(char*) );
+    int count = 0, i;
+
+    if(words == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(i=0; i<hashTable->size; i++) {
+        char* word = hashTableGetWord(hashTable, i);
+        if(word != NULL) words[count++] = word;
+    }
+    qsort(words, count, sizeof(char*), compareStrings);
+
+    Dawg_t* dawg = dawgBuild(words, count);
+    free(words);
+
+    return dawg;
+}
+/*
+*   FUNCTION: dawgFreezeState
+*   @param1 dawg: Pointer to the automaton being built
+*   @param2 edges: Edges of the state, sorted by label, to frozen states
+*   @param3 edgeCount: Number of edges
+*   @param4 final: True if a word ends at the state
+*   @param5 registry: Open addressing table of the frozen states, -1 if
+*                     the slot is empty, grown when half full
+*   @param6 registrySize: Number of slots of the registry, a power of two
+*   @returns the index of the frozen state
+*
+*   INFO: States are equal if their finality and their edges are, the
+*         edges point to frozen states, so comparing the targets is
+*         enough. The number of words of a new state is the sum of those
+*         of its targets, plus one if it is final.
+*/
+int dawgFreezeState(Dawg_t* dawg, DawgEdge_t* edges, int edgeCount, bool final, int** registry, int* registrySize) {
+    int mask = *registrySize - 1;
+    int pos = dawgHashState(edges, edgeCount, final) & mask;
+    int i;
+
+    while((*registry)[pos] != -1) {
+        DawgState_t* other = &dawg->states[(*registry)[pos]];
+
+        if(other->final == final && other->edgeCount == edgeCount) {
+            DawgEdge_t* otherEdges = &dawg->edges[other->firstEdge];
+
+            for(i=0; i<edgeCount; i++) {
+                if(otherEdges[i].label != edges[i].label || otherEdges[i].target != edges[i].target) break;
+            }
+            if(i == edgeCount) return (*registry)[pos];
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    if(dawg->stateCount == dawg->stateCapacity) {
+        dawg->stateCapacity *= 2;
+        dawg->states = realloc(dawg->states, dawg->stateCapacity * sizeof(DawgState_t));
+    }
+    while(dawg->edgeCount + edgeCount > dawg->edgeCapacity) {
+        dawg->edgeCapacity *= 2;
+        dawg->edges = realloc(dawg->edges, dawg->edgeCapacity * sizeof(DawgEdge_t));
+    }
+    if(dawg->states == NULL || dawg->edges == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int id = dawg->stateCount++;
+    DawgState_t* state = &dawg->states[id];
+
+    state->firstEdge = dawg->edgeCount;
+    state->edgeCount = edgeCount;
+    state->final = final;
+    state->reserved = 0;
+    state->wordCount = final;
+
+    for(i=0; i<edgeCount; i++) {
+        state->wordCount += dawg->states[edges[i].target].wordCount;
+    }
+    memcpy(&dawg->edges[dawg->edgeCount], edges, edgeCount * sizeof(DawgEdge_t));
+    dawg->edgeCount += edgeCount;
+
+    (*registry)[pos] = id;
+
+    // Keep the registry at most half full
+    if(dawg->stateCount * 2 > *registrySize) {
+        free(*registry);
+        *registrySize *= 2;
+        *registry = malloc( *registrySize * sizeof(int) );
+
+        if(*registry == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(*registry, -1, *registrySize * sizeof(int));
+
+        // Every state is added again
+        int s;
+        for(s=0; s<dawg->stateCount; s++) {
+            DawgState_t* other = &dawg->states[s];
+            int p = dawgHashState(&dawg->edges[other->firstEdge], other->edgeCount, other->final) & (*registrySize - 1);
+
+            while((*registry)[p] != -1) p = (p + 1) & (*registrySize - 1);
+            (*registry)[p] = s;
+        }
+    }
+    return id;
+}
+// Hashes the finality and the edges of a state for the registry of dawgFreezeState
+unsigned int dawgHashState(DawgEdge_t* edges, int edgeCount, bool final) {
+    unsigned int hash = final ? 0x9E3779B9u : 0;
+    int i;
+
+    for(i=0; i<edgeCount; i++) {
+        hash = (hash ^ edges[i].label) * 16777619u;
+        hash = (hash ^ edges[i].target) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+/*
+*   FUNCTION: dawgSave
+*   @param1 dawg: Pointer to the automaton
+*   @param2 filePath: Path of the file to write
+*   @returns true if the file was written, false otherwise
+*
+*   INFO: Writes a header, the states and the edges, which dawgMap uses
+*         in place. Like hashTableSaveAsBinary, the file is written next
+*         to the destination and renamed over it.
+*/
+bool dawgSave(Dawg_t* dawg, const char* filePath) {
+    char tmpPath[FILENAME_MAX];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", filePath);
+
+    FILE* fp = fopen(tmpPath, "wb");
+
+    if(fp == NULL) {
+        printf("ERROR: Could not write file: %s\n", tmpPath);
+        return false;
+    }
+
+    DawgFileHeader_t header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, DAWG_FILE_MAGIC, 4);
+    header.version = DAWG_FILE_VERSION;
+    header.stateCount = dawg->stateCount;
+    header.edgeCount = dawg->edgeCount;
+    header.wordCount = dawg->wordCount;
+    header.root = dawg->root;
+    header.maxLength = dawg->maxLength;
+
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(dawg->states, sizeof(DawgState_t), dawg->stateCount, fp);
+    fwrite(dawg->edges, sizeof(DawgEdge_t), dawg->edgeCount, fp);
+
+    if(fclose(fp) != 0) {
+        printf("ERROR: Could not write file: %s\n", tmpPath);
+        remove(tmpPath);
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(filePath);
+#endif
+    if(rename(tmpPath, filePath) != 0) {
+        printf("ERROR: Could not write file: %s\n", filePath);
+        return false;
+    }
+    return true;
+}
+Dawg_t* dawgMap(FILE* fp) {
+    size_t length;
+    char* mapping = mapFile(fp, &length);
+    DawgFileHeader_t* header = (DawgFileHeader_t*) mapping;
+
+    if(length < sizeof(DawgFileHeader_t) || memcmp(header->magic, DAWG_FILE_MAGIC, 4) != 0 || header->version != DAWG_FILE_VERSION ||
+       header->stateCount < 1 || header->edgeCount < 0 || header->root < 0 || header->root >= header->stateCount ||
+       length < sizeof(DawgFileHeader_t) + (size_t) header->stateCount * sizeof(DawgState_t) + (size_t) header->edgeCount * sizeof(DawgEdge_t)) {
+        printf("ERROR: Corrupted automaton file.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Dawg_t* dawg = malloc( sizeof(Dawg_t) );
+
+    if(dawg == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dawg->states = (DawgState_t*) (mapping + sizeof(DawgFileHeader_t));
+    dawg->edges = (DawgEdge_t*) (mapping + sizeof(DawgFileHeader_t) + (size_t) header->stateCount * sizeof(DawgState_t));
+    dawg->stateCount = header->stateCount;
+    dawg->edgeCount = header->edgeCount;
+    dawg->wordCount = header->wordCount;
+    dawg->root = header->root;
+    dawg->maxLength = header->maxLength;
+    dawg->stateCapacity = 0;
+    dawg->edgeCapacity = 0;
+    dawg->mapping = mapping;
+    dawg->mappingLength = length;
+
+    return dawg;
+}
+void dawgFree(Dawg_t* dawg) {
+    if(dawg->mapping != NULL) {
+        unmapFile(dawg->mapping, dawg->mappingLength);
+    } else {
+        free(dawg->states);
+        free(dawg->edges);
+    }
+    free(dawg);
+}
+/*
+*   FUNCTION: dawgOpen
+*   @param1 filePath: Path of the automaton file
+*   @param2 dictPath: Path of the binary dictionary it is built from
+*   @returns a pointer to the mapped automaton, NULL if neither file can
+*            be read or the automaton can not be saved
+*
+*   INFO: If there is no automaton file yet, the dictionary and the words
+*         of wordLogFile are loaded, the automaton is built and saved,
+*         and the table is deallocated before the file is mapped. Words
+*         added later are not in the automaton until its file is removed.
+*/
+Dawg_t* dawgOpen(const char* filePath, const char* dictPath) {
+    FILE* fp = fopen(filePath, "rb");
+
+    if(fp == NULL) {
+        FILE* fDict = fopen(dictPath, "rb");
+
+        if(fDict == NULL) {
+            printf("ERROR: Could not read file: %s\n", dictPath);
+            return NULL;
+        }
+
+        // The automaton only needs the words, not the indexes.
+        int distance = deleteIndexDistance;
+        deleteIndexDistance = 0;
+
+        HashTable_t* hashTable = hashTableLoadFromBinary(fDict);
+        fclose(fDict);
+        wordLogReplay(hashTable, wordLogFile);
+
+        Dawg_t* built = dawgBuildFromTable(hashTable);
+        bool saved = dawgSave(built, filePath);
+
+        dawgFree(built);
+        hashTableFree(hashTable);
+        deleteIndexDistance = distance;
+
+        if(!saved || (fp = fopen(filePath, "rb")) == NULL) {
+            return NULL;
+        }
+    }
+
+    Dawg_t* dawg = dawgMap(fp);
+    fclose(fp);
+
+    return dawg;
+}
+// Same as the loop of main, with the automaton instead of the hashtable
+void dawgCheckInput(Dawg_t* dawg) {
+    printf("Dictionary has been loaded into the memory.\n");
+    printf("Enter -1 to exit the program.\n");
+
+    while(true) {
+        printf("Enter a word: ");
+        char word[64];
+
+        if(scanf("%63s", word) != 1 || strcmp(word, "-1") == 0) {
+            return;
+        }
+
+        toLower(word, strlen(word));
+
+        if(dawgContains(dawg, word)) {
+            printf("Word \"%s\" is correct.\n\n", word);
+            continue;
+        }
+
+        char mostSimilarWord[CONSOLE_INPUT_LENGTH];
+        short dist = dawgFindMostSimilarWord(dawg, word, mostSimilarWord);
+
+        if(dist <= MAX_DIST_ALLOWED) {
+            printf("Word \"%s\" is incorrect.\n"
+                   "The most similar word found is: \"%s\"\n"
+                   "Edit Distance: %d\n"
+                   "Transformation steps: %s\n\n", word, mostSimilarWord, dist, getEditPath(mostSimilarWord, word));
+        } else {
+            printf("Word \"%s\" does not exist.\n\n", word);
+        }
+    }
+}
+// Returns the state the edge of the given state with the label leads to, or -1 if there is no such edge
+int dawgFindEdge(Dawg_t* dawg, int state, unsigned char label) {
+    DawgEdge_t* edges = &dawg->edges[dawg->states[state].firstEdge];
+    int lo = 0, hi = dawg->states[state].edgeCount;
+
+    while(lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if(edges[mid].label < label) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < dawg->states[state].edgeCount && edges[lo].label == label) ? (int) edges[lo].target : -1;
+}
+bool dawgContains(Dawg_t* dawg, char* word) {
+    int state = dawg->root;
+
+    for( ; *word != '\0' && state != -1; word++) {
+        state = dawgFindEdge(dawg, state, *word);
+    }
+    return state != -1 && dawg->states[state].final;
+}
+/*
+*   FUNCTION: dawgGetWordId
+*   @param1 dawg: Pointer to the automaton
+*   @param2 word: The word
+*   @returns the number of words that come before the word in the sorted
+*            list the automaton was built from, or -1 if it is not there
+*
+*   INFO: Every edge skipped on the way adds the words below it, and
+*         every final state passed adds the word that ends there. The
+*         numbers are dense, so they can index arrays of data per word.
+*/
+int dawgGetWordId(Dawg_t* dawg, char* word) {
+    int state = dawg->root;
+    int id = 0;
+
+    for( ; *word != '\0'; word++) {
+        DawgState_t* current = &dawg->states[state];
+        DawgEdge_t* edges = &dawg->edges[current->firstEdge];
+        int i;
+
+        if(current->final) id++;
+
+        for(i=0; i<current->edgeCount && edges[i].label < (unsigned char) *word; i++) {
+            id += dawg->states[edges[i].target].wordCount;
+        }
+        if(i == current->edgeCount || edges[i].label != (unsigned char) *word) {
+            return -1;
+        }
+        state = edges[i].target;
+    }
+    return dawg->states[state].final ? id : -1;
+}
+/*
+*   FUNCTION: dawgFindMostSimilarWord
+*   @param1 dawg: Pointer to the automaton
+*   @param2 key: The word that is being searched
+*   @param3(return parameter) wordFound: Buffer of CONSOLE_INPUT_LENGTH
+*                                       bytes the most similar word is
+*                                       copied into
+*   @returns the distance, or MAX_DIST_ALLOWED + 1 if no word is
+*            within MAX_DIST_ALLOWED of the key
+*
+*   INFO: Simulates the Levenshtein automaton of the key on the DAWG:
+*         each depth of the walk holds the row of distances between the
+*         key and the labels of the path. A branch is left as soon as
+*         every cell of its row is as far as the best word found, so
+*         prefixes shared by many words are compared once. The words are
+*         visited in sorted order, ties go to the first one. Only the
+*         unit and the Damerau metrics are supported.
+*/
+short dawgFindMostSimilarWord(Dawg_t* dawg, char* key, char* wordFound) {
+    DawgSearch_t search;
+    int j;
+
+    search.dawg = dawg;
+    search.key = key;
+    search.keyLen = strlen(key);
+    search.best = MAX_DIST_ALLOWED + 1;
+    search.wordFound = wordFound;
+    wordFound[0] = '\0';
+
+    if(search.keyLen >= CONSOLE_INPUT_LENGTH) {
+        return search.best;
+    }
+
+    for(j=0; j<=search.keyLen; j++) {
+        search.rows[0][j] = j;
+    }
+    dawgSearchState(&search, dawg->root, 0);
+
+    return search.best;
+}
+void dawgSearchState(DawgSearch_t* search, int state, int depth) {
+    Dawg_t* dawg = search->dawg;
+    DawgState_t* current = &dawg->states[state];
+    short* row = search->rows[depth];
+    char* key = search->key;
+    int keyLen = search->keyLen;
+    int i, j;
+
+    if(current->final && row[keyLen] < search->best) {
+        search->best = row[keyLen];
+        memcpy(search->wordFound, search->prefix, depth);
+        search->wordFound[depth] = '\0';
+    }
+
+    if(depth + 1 >= CONSOLE_INPUT_LENGTH) return;
+
+    for(i=0; i<current->edgeCount; i++) {
+        DawgEdge_t* edge = &dawg->edges[current->firstEdge + i];
+        char c = edge->label;
+        short* next = search->rows[depth + 1];
+        short min;
+
+        next[0] = depth + 1;
+        min = next[0];
+
+        for(j=1; j<=keyLen; j++) {
+            next[j] = getMin(row[j] + 1, next[j-1] + 1, row[j-1] + (key[j-1] != c));
+
+            if(distanceMetric == METRIC_DAMERAU && depth > 0 && j > 1 && key[j-1] == search->prefix[depth-1] && key[j-2] == c) {
+                short swap = search->rows[depth - 1][j-2] + 1;
+                if(swap < next[j]) next[j] = swap;
+            }
+            if(next[j] < min) min = next[j];
+        }
+
+        if(min < search->best) {
+            search->prefix[depth] = c;
+            dawgSearchState(search, edge->target, depth + 1);
+        }
+    }
+}
+/*
+*   FUNCTION: getDeletionHashes
+*   @param1 word: The word to generate the deletions of
+*   @param2 maxDeletes: Largest number of characters to delete
+*   @param3(return parameter) hashes: Growable array the hashes are written into
+*   @param4(return parameter) capacity: Capacity of the array
+*   @returns the number of hashes written
+*
+*   INFO: Hashes the word and every string obtained by deleting up to
+*         maxDeletes of its characters. The same string may be generated
+*         more than once (e.g. by deleting either "l" of "hello").
+*/
+int getDeletionHashes(char* word, int maxDeletes, unsigned int** hashes, int* capacity) {
+    char buffer[CONSOLE_INPUT_LENGTH];
+    int len = strlen(word);
+    int count = 0;
+
+    if(len >= CONSOLE_INPUT_LENGTH) len = CONSOLE_INPUT_LENGTH - 1;
+    memcpy(buffer, word, len);
+    buffer[len] = '\0';
+
+    collectDeletionHashes(buffer, len, 0, maxDeletes, hashes, capacity, &count);
+    return count;
+}
+// Recursive helper of getDeletionHashes: deletes one more character at or after position start
+void collectDeletionHashes(char* buffer, int len, int start, int deletesLeft, unsigned int** hashes, int* capacity, int* count) {
+    int i;
+
+    if(*count == *capacity) {
+        *capacity *= 2;
+        *hashes = realloc(*hashes, *capacity * sizeof(unsigned int));
+
+        if(*hashes == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (*hashes)[(*count)++] = getStringHash(buffer, len);
+
+    if(deletesLeft == 0) return;
+
+    char shorter[CONSOLE_INPUT_LENGTH];
+    for(i=start; i<len; i++) {
+        // Delete the character at i
+        memcpy(shorter, buffer, i);
+        memcpy(shorter + i, buffer + i + 1, len - i);
+
+        collectDeletionHashes(shorter, len - 1, i, deletesLeft - 1, hashes, capacity, count);
+    }
+}
+unsigned int getStringHash(char* str, int len) {
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for(i=0; i<len; i++) {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+// Orders deletion index entries by hash, then by word address
+int compareDeleteEntries(const void* a, const void* b) {
+    const DeleteEntry_t* x = a;
+    const DeleteEntry_t* y = b;
+
+    if(x->hash != y->hash) return (x->hash < y->hash) ? -1 : 1;
+    return x->wordIndex - y->wordIndex;
+}
+int compareInts(const void* a, const void* b) {
+    return *(const int*) a - *(const int*) b;
+}
+int compareUnsignedInts(const void* a, const void* b) {
+    unsigned int x = *(const unsigned int*) a, y = *(const unsigned int*) b;
+    return (x > y) - (x < y);
+}
+int compareStrings(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+/*
+*   FUNCTION: getEditDistanceKeyboard
+*   @param1 word: The word of the dictionary
+*   @param2 typed: The string that was typed instead of the word
+*   @param3 k: Largest distance of interest
+*   @returns the distance if it is at most k, k + 1 otherwise
+*
+*   INFO: Same band as getEditDistanceBounded, with the costs of typing
+*         on a QWERTY keyboard: hitting a key next to the intended one,
+*         and pressing a key next to (or the same as) the one before it
+*         cost KEY_COST_SLIP, swapping two adjacent letters costs
+*         KEY_COST_SWAP and any other edit costs KEY_COST_UNIT.
+*         Substitutions are looked up in the keyboardCosts table. No
+*         insertion or deletion costs less than KEY_COST_SLIP, so the band
+*         only holds k / KEY_COST_SLIP diagonals on each side. The swaps
+*         need the cell two rows up, so three rows are kept, and the
+*         calculation stops once two rows in a row exceed k.
+*/
+short getEditDistanceKeyboard(char* word, char* typed, short k) {
+
+    short len1 = strlen(word);
+    short len2 = strlen(typed);
+
+    if(k < 0) return 0;
+    if(abs(len1 - len2) * KEY_COST_SLIP > k) return k + 1;
+
+    // No alignment costs more than deleting and inserting every character.
+    if(k > (len1 + len2) * KEY_COST_UNIT) k = (len1 + len2) * KEY_COST_UNIT;
+
+    const short half = k / KEY_COST_SLIP;
+    const short width = 2 * half + 1;
+    const short inf = k + 1;
+
+    // Three rows of the band, followed by the costs of inserting each typed letter
+    short bandStack[3 * (2 * BAND_STACK_WIDTH + 1) + CONSOLE_INPUT_LENGTH];
+    short* band = bandStack;
+
+    if(3 * width + len2 + 1 > (int) (sizeof(bandStack) / sizeof(short))) {
+        band = malloc( (3 * width + len2 + 1) * sizeof(short) );
+
+        if(band == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Cell (i, j) of the matrix is stored at index j - i + half of row i.
+    short* prev2 = band;
+    short* prev = band + width;
+    short* cur = band + 2 * width;
+    short* insertion = band + 3 * width;
+    short prevMin = 0;
+    short i, j, d;
+
+    for(j = 1; j <= len2; j++) {
+        unsigned char t = typed[j-1] - 'a', before = (j > 1) ? typed[j-2] - 'a' : 26;
+        insertion[j] = (t < 26 && before < 26 && keyboardCosts[before * 26 + t] < KEY_COST_UNIT) ? KEY_COST_SLIP : KEY_COST_UNIT;
+    }
+
+    // Initializing first row: the typed string on its own
+    short cost = 0;
+    for(d = 0; d < width; d++) {
+        j = d - half;
+
+        if(j > 0 && j <= len2 && cost < inf) cost += insertion[j];
+
+        prev[d] = (j >= 0 && j <= len2 && cost < inf) ? cost : inf;
+        prev2[d] = inf;
+    }
+
+    for(i = 1; i <= len1; i++) {
+        short rowMin = inf;
+        unsigned char w = word[i-1] - 'a';
+        const unsigned char* costs = (w < 26) ? &keyboardCosts[w * 26] : NULL;
+
+        for(d = 0; d < width; d++) {
+            j = i + d - half;
+
+            if(j < 0 || j > len2) {
+                cur[d] = inf;
+                continue;
+            }
+            if(j == 0) {
+                cur[d] = (i * KEY_COST_UNIT < inf) ? i * KEY_COST_UNIT : inf;
+            } else {
+                // Insertions depend on the key before, so a match is not always the cheapest way.
+                unsigned char t = typed[j-1] - 'a';
+                short substitution = (costs != NULL && t < 26) ? costs[t] : (word[i-1] == typed[j-1]) ? 0 : KEY_COST_UNIT;
+
+                short up = (d + 1 < width) ? prev[d+1] : inf;
+                short left = (d > 0) ? cur[d-1] : inf;
+
+                cur[d] = getMin(up + KEY_COST_UNIT, left + insertion[j], prev[d] + substitution);
+
+                // The last two letters were typed the other way around.
+                if(j > 1 && word[i-1] == typed[j-2] && i > 1 && word[i-2] == typed[j-1] && prev2[d] + KEY_COST_SWAP < cur[d]) {
+                    cur[d] = prev2[d] + KEY_COST_SWAP;
+                }
+                if(cur[d] > inf) cur[d] = inf;
+            }
+
+            if(cur[d] < rowMin) rowMin = cur[d];
+        }
+
+        // The distance can not get smaller in later rows, a swap reaches one row further.
+        if(rowMin > k && prevMin > k) {
+            if(band != bandStack) free(band);
+            return inf;
+        }
+        prevMin = rowMin;
+
+        short* tmp = prev2;
+        prev2 = prev;
+        prev = cur;
+        cur = tmp;
+    }
+
+    short val = prev[len2 - len1 + half];
+
+    if(band != bandStack) free(band);
+    return val;
+}
+// Calls the bounded kernel of distanceMetric
+short getEditDistanceMetric(char* str1, char* str2, short k) {
+    if(distanceMetric == METRIC_KEYBOARD) {
+        return getEditDistanceKeyboard(str1, str2, k);
+    }
+    if(distanceMetric == METRIC_DAMERAU) {
+        return getEditDistanceDamerauBounded(str1, str2, k);
+    }
+    return getEditDistanceBounded(str1, str2, k);
+}
+// The keyboard metric counts an ordinary edit as KEY_COST_UNIT
+short getDistanceLimit(void) {
+    return (distanceMetric == METRIC_KEYBOARD) ? MAX_DIST_ALLOWED * KEY_COST_UNIT : MAX_DIST_ALLOWED;
+}
+/*
+*   FUNCTION: getEditPath
+*   @param1 str1: First string
+*   @param2 str2: Second string
+*   @returns a string that describes the transformation
+*
+*   INFO: Finds the necessary operations to transform the second string into 
+*         first string and returns it as a string in a human readable form.
+*         The string lives in a scratch arena of the calling thread, so it
+*         must not be freed and is only valid until the thread's next call.
+*         Callers that need the operations themselves, or their own arena,
+*         use getEditOps and getEditPathText.
+*/
+char* getEditPath(char* str1, char* str2) {
+    static _Thread_local EditScratch_t scratch;
+
+    getEditOps(&scratch, str1, str2);
+    return getEditPathText(&scratch);
+}
+/*
+*   FUNCTION: getEditOps
+*   @param1 scratch: Arena the operations are written into
+*   @param2 str1: First string
+*   @param3 str2: Second string
+*   @returns the edit distance between the strings
+*
+*   INFO: Finds the operations that transform the second string into the
+*         first one and stores them in scratch->ops, in the order of the
+*         strings. The matrix, the operations and the rows all come from
+*         the arena, which only grows, so once it has grown to the size
+*         of the inputs no memory is allocated. Strings whose matrix
+*         would have more than EDIT_MATRIX_MAX_CELLS cells are aligned
+*         in linear space by getEditOpsHirschberg. Swapped characters
+*         are a single operation unless distanceMetric is METRIC_UNIT.
+*/
+short getEditOps(EditScratch_t* scratch, char* str1, char* str2) {
+    short len1 = strlen(str1);
+    short len2 = strlen(str2);
+
+    scratch->opCount = 0;
+    scratch->distance = 0;
+    scratch->transpositions = (distanceMetric != METRIC_UNIT);
+
+    if((long) (len1 + 1) * (len2 + 1) <= EDIT_MATRIX_MAX_CELLS) {
+        getEditOpsMatrix(scratch, str1, len1, str2, len2, 0, 0);
+    } else {
+        getEditOpsHirschberg(scratch, str1, len1, str2, len2, 0, 0);
+    }
+    return scratch->distance;
+}
+/*
+*   FUNCTION: getEditOpsMatrix
+*   @param1 scratch: Arena the operations are appended to
+*   @param2 str1: First string
+*   @param3 len1: Length of first string
+*   @param4 str2: Second string
+*   @param5 len2: Length of second string
+*   @param6 offset1: Position of str1 in the string it was cut from
+*   @param7 offset2: Position of str2 in the string it was cut from
+*   @returns nothing
+*
+*   INFO: Fills the whole edit distance matrix, as a single block of the
+*         arena, and traces the path back from its bottom-right corner.
+*         The operations are found last to first, so they are reversed
+*         once they are all appended.
+*/
+void getEditOpsMatrix(EditScratch_t* scratch, char* str1, short len1, char* str2, short len2, short offset1, short offset2) {
+    const int width = len2 + 1;
+    const bool transpositions = scratch->transpositions;
+    short i, j;
+
+    editScratchReserve((void**) &scratch->matrix, &scratch->matrixCapacity, (size_t) (len1 + 1) * width, sizeof(short));
+    short* ED = scratch->matrix;
+
+    // Initializing first column and first row
+    for(i = 0; i <= len1; i++) {
+        ED[i * width] = i;
+    }
+    for(j = 0; j <= len2; j++) {
+        ED[j] = j;
+    }
+
+    for(i = 1; i <= len1; i++) {
+        short* row = ED + i * width;
+        short* up = row - width;
+
+        for(j = 1; j <= len2; j++) {
+            if(str1[i-1] == str2[j-1]) {
+                row[j] = up[j-1];
+            } else {
+                row[j] = getMin(up[j] + 1, row[j-1] + 1, up[j-1] + SUBSTITUTION_COST);
+
+                if(transpositions && i > 1 && j > 1 && str1[i-1] == str2[j-2] && str1[i-2] == str2[j-1] && up[j-2-width] + 1 < row[j]) {
+                    row[j] = up[j-2-width] + 1;
+                }
+            }
+        }
+    }
+
+    int first = scratch->opCount;
+    i = len1;
+    j = len2;
+
+    // Trace back the path
+    while(i != 0 && j != 0) {
+        short diagonal = ED[(i-1) * width + j-1];
+        short deletion = ED[i * width + j-1];
+        short insertion = ED[(i-1) * width + j];
+
+        if(str1[i-1] == str2[j-1]) { // Characters are equal: Copy
+            i--;
+            j--;
+            editScratchAddOp(scratch, EDIT_COPY, str1[i], offset1 + i, offset2 + j);
+        } else if(transpositions && i > 1 && j > 1 && str1[i-1] == str2[j-2] && str1[i-2] == str2[j-1] &&
+                  ED[i * width + j] == ED[(i-2) * width + j-2] + 1) { // Transpose
+            i -= 2;
+            j -= 2;
+            editScratchAddOp(scratch, EDIT_TRANSPOSE, str1[i], offset1 + i, offset2 + j)->c2 = str1[i+1];
+        } else if(diagonal < insertion && diagonal < deletion) { // Substitute
+            i--;
+            j--;
+            editScratchAddOp(scratch, EDIT_SUBSTITUTE, str1[i], offset1 + i, offset2 + j);
+        } else if(diagonal >= insertion && insertion < deletion) { // Insert
+            i--;
+            editScratchAddOp(scratch, EDIT_INSERT, str1[i], offset1 + i, offset2 + j);
+        } else { // Delete
+            j--;
+            editScratchAddOp(scratch, EDIT_DELETE, str2[j], offset1 + i, offset2 + j);
+        }
+    }
+    while(i != 0) {
+        i--;
+        editScratchAddOp(scratch, EDIT_INSERT, str1[i], offset1 + i, offset2 + j);
+    }
+    while(j != 0) {
+        j--;
+        editScratchAddOp(scratch, EDIT_DELETE, str2[j], offset1 + i, offset2 + j);
+    }
+
+    // Put the operations of this matrix into the order of the strings
+    int last = scratch->opCount - 1;
+
+    while(first < last) {
+        EditOp_t tmp = scratch->ops[first];
+        scratch->ops[first++] = scratch->ops[last];
+        scratch->ops[last--] = tmp;
+    }
+}
+/*
+*   FUNCTION: getEditOpsHirschberg
+*   @param1 scratch: Arena the operations are appended to
+*   @param2 str1: First string
+*   @param3 len1: Length of first string
+*   @param4 str2: Second string
+*   @param5 len2: Length of second string
+*   @param6 offset1: Position of str1 in the string it was cut from
+*   @param7 offset2: Position of str2 in the string it was cut from
+*   @returns nothing
+*
+*   INFO: Hirschberg's algorithm: the last row of the matrix of the first
+*         half of str1 and the last row of the matrix of the reversed
+*         second half tell where an optimal path crosses the middle of
+*         str1. Both halves are then aligned on their own, until their
+*         matrices are small enough for getEditOpsMatrix. A swap of the
+*         two middle characters jumps over the middle, so with
+*         transpositions the rows before the last ones are checked for
+*         such a crossing as well. Only a few rows and a matrix of at
+*         most EDIT_MATRIX_MAX_CELLS cells are needed, at about twice the
+*         time of a single matrix.
+*/
+void getEditOpsHirschberg(EditScratch_t* scratch, char* str1, short len1, char* str2, short len2, short offset1, short offset2) {
+    if(len1 <= 1 || (long) (len1 + 1) * (len2 + 1) <= EDIT_MATRIX_MAX_CELLS) {
+        getEditOpsMatrix(scratch, str1, len1, str2, len2, offset1, offset2);
+        return;
+    }
+
+    short mid = len1 / 2;
+    short j;
+
+    editScratchReserve((void**) &scratch->rows, &scratch->rowsCapacity, 6 * (size_t) (len2 + 1), sizeof(short));
+
+    // Distances between str1[0, mid) and every prefix of str2, and one row before
+    short* forwardBefore;
+    short* forward = getEditDistanceRows(str1, mid, str2, len2, false, scratch->transpositions, scratch->rows, &forwardBefore);
+
+    // Distances between str1[mid, len1) and every suffix of str2, backward[j] for the suffix of length j
+    short* backwardBefore;
+    short* backward = getEditDistanceRows(str1 + mid, len1 - mid, str2, len2, true, scratch->transpositions, scratch->rows + 3 * (len2 + 1), &backwardBefore);
+
+    short split = 0;
+    for(j = 1; j <= len2; j++) {
+        if(forward[j] + backward[len2-j] < forward[split] + backward[len2-split]) split = j;
+    }
+
+    // The two characters around the middle may be swapped across it.
+    short swap = -1;
+    if(scratch->transpositions && str1[mid-1] != str1[mid]) {
+        short best = forward[split] + backward[len2-split];
+
+        for(j = 2; j <= len2; j++) {
+            if(str1[mid-1] == str2[j-1] && str1[mid] == str2[j-2] && forwardBefore[j-2] + 1 + backwardBefore[len2-j] < best) {
+                best = forwardBefore[j-2] + 1 + backwardBefore[len2-j];
+                swap = j;
+            }
+        }
+    }
+
+    if(swap != -1) {
+        getEditOpsHirschberg(scratch, str1, mid - 1, str2, swap - 2, offset1, offset2);
+        editScratchAddOp(scratch, EDIT_TRANSPOSE, str1[mid-1], offset1 + mid - 1, offset2 + swap - 2)->c2 = str1[mid];
+        getEditOpsHirschberg(scratch, str1 + mid + 1, len1 - mid - 1, str2 + swap, len2 - swap, offset1 + mid + 1, offset2 + swap);
+        return;
+    }
+
+    getEditOpsHirschberg(scratch, str1, mid, str2, split, offset1, offset2);
+    getEditOpsHirschberg(scratch, str1 + mid, len1 - mid, str2 + split, len2 - split, offset1 + mid, offset2 + split);
+}
+/*
+*   FUNCTION: getEditDistanceRows
+*   @param1 str1: First string
+*   @param2 len1: Length of first string
+*   @param3 str2: Second string
+*   @param4 len2: Length of second string
+*   @param5 reversed: Read both strings from their ends
+*   @param6 transpositions: Count swapped characters as a single edit
+*   @param7 rows: Room for 3 rows of len2 + 1 cells
+*   @param8(return parameter) beforeLast: Row len1 - 1, or row 0 if
+*                                        len1 is 0
+*   @returns row len1 of the edit distance matrix
+*
+*   INFO: Fills the matrix row by row, keeping the last three rows.
+*/
+short* getEditDistanceRows(char* str1, short len1, char* str2, short len2, bool reversed, bool transpositions, short* rows, short** beforeLast) {
+    short* prev2 = rows;
+    short* prev = rows + (len2 + 1);
+    short* cur = rows + 2 * (len2 + 1);
+    short i, j;
+
+    for(j = 0; j <= len2; j++) {
+        prev[j] = j;
+    }
+    *beforeLast = prev;
+
+    for(i = 1; i <= len1; i++) {
+        char c1 = reversed ? str1[len1-i] : str1[i-1];
+        char c1Before = (i > 1) ? (reversed ? str1[len1-i+1] : str1[i-2]) : 0;
+
+        cur[0] = i;
+
+        for(j = 1; j <= len2; j++) {
+            char c2 = reversed ? str2[len2-j] : str2[j-1];
+
+            if(c1 == c2) {
+                cur[j] = prev[j-1];
+            } else {
+                cur[j] = getMin(prev[j] + 1, cur[j-1] + 1, prev[j-1] + SUBSTITUTION_COST);
+
+                if(transpositions && i > 1 && j > 1) {
+                    char c2Before = reversed ? str2[len2-j+1] : str2[j-2];
+
+                    if(c1 == c2Before && c1Before == c2 && prev2[j-2] + 1 < cur[j]) {
+                        cur[j] = prev2[j-2] + 1;
+                    }
+                }
+            }
+        }
+
+        short* tmp = prev2;
+        prev2 = prev;
+        prev = cur;
+        cur = tmp;
+    }
+
+    if(len1 > 0) *beforeLast = prev2;
+    return prev;
+}
+/*
+*   FUNCTION: getEditPathText
+*   @param1 scratch: Arena that holds the operations of getEditOps
+*   @returns the operations in a human readable form
+*
+*   INFO: Each character of the first string is followed by (i) if it is
+*         inserted or (s) if it replaces a character, (d) stands for a
+*         deleted character of the second string and (t) follows two
+*         characters of the first string that were typed the other way
+*         around. The text is written into the arena as well.
+*/
+char* getEditPathText(EditScratch_t* scratch) {
+    int bufLen = 0;
+    int i;
+
+    // No operation takes more than 6 characters
+    editScratchReserve((void**) &scratch->text, &scratch->textCapacity, 6 * (size_t) scratch->opCount + 1, sizeof(char));
+    scratch->text[0] = '\0';
+
+    for(i = 0; i < scratch->opCount; i++) {
+        EditOp_t* op = &scratch->ops[i];
+
+        switch(op->type) {
+            case EDIT_COPY:
+                bufLen += sprintf(scratch->text + bufLen, "%c ", op->c);
+                break;
+            case EDIT_DELETE:
+                bufLen += sprintf(scratch->text + bufLen, "(d) ");
+                break;
+            case EDIT_INSERT:
+                bufLen += sprintf(scratch->text + bufLen, "%c(i) ", op->c);
+                break;
+            case EDIT_SUBSTITUTE:
+                bufLen += sprintf(scratch->text + bufLen, "%c(s) ", op->c);
+                break;
+            case EDIT_TRANSPOSE:
+                bufLen += sprintf(scratch->text + bufLen, "%c%c(t) ", op->c, op->c2);
+                break;
+        }
+    }
+    return scratch->text;
+}
+// Appends an operation to the arena, adds its cost to the distance and returns it
+EditOp_t* editScratchAddOp(EditScratch_t* scratch, EditOpType_t type, char c, short pos1, short pos2) {
+    if(scratch->opCount == scratch->opCapacity) {
+        editScratchReserve((void**) &scratch->ops, &scratch->opCapacity, scratch->opCount + 1, sizeof(EditOp_t));
+    }
+
+    EditOp_t* op = &scratch->ops[scratch->opCount++];
+    op->type = type;
+    op->c = c;
+    op->c2 = 0;
+    op->pos1 = pos1;
+    op->pos2 = pos2;
+
+    if(type == EDIT_SUBSTITUTE) scratch->distance += SUBSTITUTION_COST;
+    else if(type != EDIT_COPY) scratch->distance += 1;
+
+    return op;
+}
+/*
+*   FUNCTION: editScratchReserve
+*   @param1 buffer: Address of a buffer of the arena
+*   @param2 capacity: Address of its capacity, in elements
+*   @param3 count: Number of elements needed
+*   @param4 size: Size of an element
+*   @returns nothing
+*
+*   INFO: Grows the buffer to at least twice its capacity when it is too
+*         small, so a series of growing inputs reallocates it only a few
+*         times. The contents are kept.
+*/
+void editScratchReserve(void** buffer, int* capacity, size_t count, size_t size) {
+    if(count <= (size_t) *capacity) {
+        return;
     }
-    free(ED);
 
-    return path;
+    size_t newCapacity = (*capacity > 0) ? 2 * (size_t) *capacity : 64;
+    while(newCapacity < count) newCapacity *= 2;
 
+    void* grown = realloc(*buffer, newCapacity * size);
+
+    if(grown == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    *buffer = grown;
+    *capacity = newCapacity;
+}
+void editScratchRelease(EditScratch_t* scratch) {
+    free(scratch->matrix);
+    free(scratch->rows);
+    free(scratch->ops);
+    free(scratch->text);
+    memset(scratch, 0, sizeof(EditScratch_t));
 }
 /*
 *   FUNCTION: getEditDistanceMatrix
@@ -513,38 +4939,496 @@ short** getEditDistanceMatrix(char* str1, short len1, char* str2, short len2) {
             }
             else {
 
-                ED[i][j] = getMin(ED[i-1][j] + 1,
-                                  ED[i][j-1] + 1,
-                                  ED[i-1][j-1] + SUBSTITUTION_COST);
+                ED[i][j] = getMin(ED[i-1][j] + 1,
+                                  ED[i][j-1] + 1,
+                                  ED[i-1][j-1] + SUBSTITUTION_COST);
+            }
+        }
+    }
+
+    return ED;
+}
+/*
+*   FUNCTION: getEditDistance
+*   @param1 str1: First string
+*   @param2 str2: Second string
+*   @returns the distance
+*
+*   INFO: Calculates and returns the edit distance between 
+*         two given strings.
+*/
+short getEditDistance(char* str1, char* str2) {
+    
+    EditPattern_t pattern;
+    editPatternInit(&pattern, str2);
+
+    short val = getEditDistancePattern(&pattern, str1);
+
+    editPatternRelease(&pattern);
+    return val;
+}
+// Same as getEditDistance, counting swapped characters as a single edit
+short getEditDistanceDamerau(char* str1, char* str2) {
+
+    EditPattern_t pattern;
+    editPatternInit(&pattern, str2);
+
+    short val = getEditDistancePatternDamerau(&pattern, str1);
+
+    editPatternRelease(&pattern);
+    return val;
+}
+/*
+*   FUNCTION: editPatternInit
+*   @param1(return parameter) pattern: The pattern to initialize
+*   @param2 str: The string that will be compared against many others
+*   @returns nothing
+*
+*   INFO: Precomputes, for every character, the bit mask of the positions
+*         it occupies in the string. Patterns longer than 64 characters
+*         are split into several 64-bit blocks, which need heap memory
+*         that editPatternRelease gives back.
+*/
+void editPatternInit(EditPattern_t* pattern, char* str) {
+    int i;
+
+    pattern->str = str;
+    pattern->len = strlen(str);
+    pattern->blocks = (pattern->len + 63) / 64;
+
+    if(pattern->blocks <= 1) {
+        pattern->peq = pattern->inlinePeq;
+        pattern->pv = NULL;
+        pattern->mv = NULL;
+        pattern->d0 = NULL;
+        memset(pattern->inlinePeq, 0, sizeof(pattern->inlinePeq));
+    } else {
+        pattern->peq = calloc(256 * pattern->blocks, sizeof(unsigned long long));
+        pattern->pv = malloc(pattern->blocks * sizeof(unsigned long long));
+        pattern->mv = malloc(pattern->blocks * sizeof(unsigned long long));
+        pattern->d0 = malloc(pattern->blocks * sizeof(unsigned long long));
+
+        if(pattern->peq == NULL || pattern->pv == NULL || pattern->mv == NULL || pattern->d0 == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(i=0; i<pattern->len; i++) {
+        unsigned char c = str[i];
+        pattern->peq[c * pattern->blocks + i / 64] |= 1ULL << (i % 64);
+    }
+}
+void editPatternRelease(EditPattern_t* pattern) {
+    if(pattern->peq != pattern->inlinePeq) {
+        free(pattern->peq);
+        free(pattern->pv);
+        free(pattern->mv);
+        free(pattern->d0);
+    }
+}
+/*
+*   FUNCTION: getEditDistancePattern
+*   @param1 pattern: Precomputed pattern of the first string
+*   @param2 str: Second string
+*   @returns the distance
+*
+*   INFO: Calculates the edit distance with Myers' bit-vector algorithm
+*         (in Hyyro's formulation). A column of the edit distance matrix
+*         is kept as bit vectors of its vertical +1/-1 deltas, so each
+*         character of the string is processed with a handful of word
+*         operations instead of a whole column of the matrix. Patterns
+*         longer than 64 characters are processed block by block, passing
+*         the horizontal delta of each block to the next one.
+*         The bit vectors only hold for unit costs, so the edit distance
+*         matrix is used when SUBSTITUTION_COST is not 1.
+*/
+short getEditDistancePattern(EditPattern_t* pattern, char* str) {
+
+#if SUBSTITUTION_COST != 1
+    short len2 = strlen(str);
+    short** ED = getEditDistanceMatrix(str, len2, pattern->str, pattern->len);
+
+    // Return the bottom-right element
+    int val = ED[len2][pattern->len];
+
+    for(short i = 0;i <= len2; i++) {
+        free(ED[i]);
+    }
+    free(ED);
+
+    return val;
+#endif
+    int m = pattern->len;
+    int blocks = pattern->blocks;
+    short score = m;
+    int j;
+
+    if(m == 0) {
+        return strlen(str);
+    }
+
+    // Bit of the last pattern character in the last block
+    const unsigned long long lastBit = 1ULL << ((m - 1) % 64);
+
+    if(blocks == 1) {
+        unsigned long long pv = ~0ULL, mv = 0;
+
+        for(j=0; str[j] != '\0'; j++) {
+            unsigned long long eq = pattern->peq[(unsigned char) str[j]];
+            unsigned long long xv = eq | mv;
+            unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq;
+            unsigned long long ph = mv | ~(xh | pv);
+            unsigned long long mh = pv & xh;
+
+            if(ph & lastBit) score++;
+            else if(mh & lastBit) score--;
+
+            // The first row of the matrix increases by one in each column.
+            ph = (ph << 1) | 1;
+            mh = mh << 1;
+
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+        return score;
+    }
+
+    int b;
+    for(b=0; b<blocks; b++) {
+        pattern->pv[b] = ~0ULL;
+        pattern->mv[b] = 0;
+    }
+
+    for(j=0; str[j] != '\0'; j++) {
+        unsigned long long* eqs = &pattern->peq[(unsigned char) str[j] * blocks];
+        int hin = 1; // Horizontal delta entering the top of the block
+
+        for(b=0; b<blocks; b++) {
+            unsigned long long pv = pattern->pv[b], mv = pattern->mv[b];
+            unsigned long long eq = eqs[b];
+            unsigned long long highBit = (b == blocks - 1) ? lastBit : (1ULL << 63);
+            int hout = 0;
+
+            unsigned long long xv = eq | mv;
+            if(hin < 0) eq |= 1;
+            unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq;
+            unsigned long long ph = mv | ~(xh | pv);
+            unsigned long long mh = pv & xh;
+
+            if(ph & highBit) hout = 1;
+            else if(mh & highBit) hout = -1;
+
+            ph <<= 1;
+            mh <<= 1;
+            if(hin < 0) mh |= 1;
+            else if(hin > 0) ph |= 1;
+
+            pattern->pv[b] = mh | ~(xv | ph);
+            pattern->mv[b] = ph & xv;
+            hin = hout;
+        }
+        score += hin;
+    }
+    return score;
+}
+
+/*
+*   FUNCTION: getEditDistancePatternDamerau
+*   @param1 pattern: Precomputed pattern of the first string
+*   @param2 str: Second string
+*   @returns the optimal string alignment distance
+*
+*   INFO: Same as getEditDistancePattern, with Hyyro's extension for
+*         transpositions: a pattern character that matches the previous
+*         character of the string, right after a position whose diagonal
+*         delta was not zero and whose character matches the current one,
+*         gets a zero diagonal delta as well. The previous column's
+*         diagonal deltas are kept per block, the bit shifted out of the
+*         top of a block is shifted into the next one.
+*/
+short getEditDistancePatternDamerau(EditPattern_t* pattern, char* str) {
+
+#if SUBSTITUTION_COST != 1
+    return getEditDistanceDamerauBounded(pattern->str, str, pattern->len + strlen(str));
+#endif
+    int m = pattern->len;
+    int blocks = pattern->blocks;
+    short score = m;
+    int j;
+
+    if(m == 0) {
+        return strlen(str);
+    }
+
+    // Bit of the last pattern character in the last block
+    const unsigned long long lastBit = 1ULL << ((m - 1) % 64);
+
+    if(blocks == 1) {
+        unsigned long long pv = ~0ULL, mv = 0, d0 = 0, prevEq = 0;
+
+        for(j=0; str[j] != '\0'; j++) {
+            unsigned long long eq = pattern->peq[(unsigned char) str[j]];
+            unsigned long long tr = (((~d0) & eq) << 1) & prevEq;
+            unsigned long long xv = eq | mv | tr;
+            unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq | tr;
+            unsigned long long ph = mv | ~(xh | pv);
+            unsigned long long mh = pv & xh;
+
+            if(ph & lastBit) score++;
+            else if(mh & lastBit) score--;
+
+            // The first row of the matrix increases by one in each column.
+            ph = (ph << 1) | 1;
+            mh = mh << 1;
+
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            d0 = xh | xv;
+            prevEq = eq;
+        }
+        return score;
+    }
+
+    int b;
+    for(b=0; b<blocks; b++) {
+        pattern->pv[b] = ~0ULL;
+        pattern->mv[b] = 0;
+        pattern->d0[b] = 0;
+    }
+
+    unsigned long long* prevEqs = NULL;
+
+    for(j=0; str[j] != '\0'; j++) {
+        unsigned long long* eqs = &pattern->peq[(unsigned char) str[j] * blocks];
+        unsigned long long carry = 0; // Top bit of the previous block's transposition mask
+        int hin = 1; // Horizontal delta entering the top of the block
+
+        for(b=0; b<blocks; b++) {
+            unsigned long long pv = pattern->pv[b], mv = pattern->mv[b];
+            unsigned long long eq = eqs[b];
+            unsigned long long highBit = (b == blocks - 1) ? lastBit : (1ULL << 63);
+            int hout = 0;
+
+            unsigned long long swapped = (~pattern->d0[b]) & eq;
+            unsigned long long tr = (prevEqs != NULL) ? ((swapped << 1) | carry) & prevEqs[b] : 0;
+            carry = swapped >> 63;
+
+            unsigned long long xv = eq | mv | tr;
+            if(hin < 0) eq |= 1;
+            unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq | tr;
+            unsigned long long ph = mv | ~(xh | pv);
+            unsigned long long mh = pv & xh;
+
+            if(ph & highBit) hout = 1;
+            else if(mh & highBit) hout = -1;
+
+            ph <<= 1;
+            mh <<= 1;
+            if(hin < 0) mh |= 1;
+            else if(hin > 0) ph |= 1;
+
+            pattern->pv[b] = mh | ~(xv | ph);
+            pattern->mv[b] = ph & xv;
+            pattern->d0[b] = xh | xv;
+            hin = hout;
+        }
+        score += hin;
+        prevEqs = eqs;
+    }
+    return score;
+}
+/*
+*   FUNCTION: getEditDistanceBounded
+*   @param1 str1: First string
+*   @param2 str2: Second string
+*   @param3 k: Largest distance of interest
+*   @returns the distance if it is at most k, k + 1 otherwise
+*
+*   INFO: Calculates the edit distance only when it is at most k, using
+*         Ukkonen's cut-off: a cell further than k from the main diagonal
+*         costs more than k insertions or deletions, so only a band of
+*         2k+1 diagonals is filled, two rows at a time. Strings whose
+*         lengths differ by more than k are rejected right away, and the
+*         calculation stops as soon as every cell of a row exceeds k.
+*/
+short getEditDistanceBounded(char* str1, char* str2, short k) {
+
+    short len1 = strlen(str1);
+    short len2 = strlen(str2);
+
+    if(k < 0) return 0;
+    if(abs(len1 - len2) > k) return k + 1;
+
+    // No alignment costs more than deleting and inserting every character.
+    if(k > len1 + len2) k = len1 + len2;
+
+    const short width = 2 * k + 1;
+    const short inf = k + 1;
+
+    short bandStack[2 * (2 * BAND_STACK_WIDTH + 1)];
+    short* band = bandStack;
+
+    if(width > 2 * BAND_STACK_WIDTH + 1) {
+        band = malloc( 2 * width * sizeof(short) );
+
+        if(band == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Cell (i, j) of the matrix is stored at index j - i + k of row i.
+    short* prev = band;
+    short* cur = band + width;
+    short i, j, d;
+
+    // Initializing first row
+    for(d = 0; d < width; d++) {
+        j = d - k;
+        prev[d] = (j >= 0 && j <= len2) ? j : inf;
+    }
+
+    for(i = 1; i <= len1; i++) {
+        short rowMin = inf;
+
+        for(d = 0; d < width; d++) {
+            j = i + d - k;
+
+            if(j < 0 || j > len2) {
+                cur[d] = inf;
+                continue;
+            }
+            if(j == 0) {
+                cur[d] = (i < inf) ? i : inf;
+            } else if(str1[i-1] == str2[j-1]) {
+                cur[d] = prev[d];
+            } else {
+                short up = (d + 1 < width) ? prev[d+1] : inf;
+                short left = (d > 0) ? cur[d-1] : inf;
+
+                cur[d] = getMin(up + 1, left + 1, prev[d] + SUBSTITUTION_COST);
+                if(cur[d] > inf) cur[d] = inf;
+            }
+
+            if(cur[d] < rowMin) rowMin = cur[d];
+        }
+
+        // The distance can not get smaller in later rows.
+        if(rowMin > k) {
+            if(band != bandStack) free(band);
+            return inf;
+        }
+
+        short* tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+
+    short val = prev[len2 - len1 + k];
+
+    if(band != bandStack) free(band);
+    return val;
+}
+/*
+*   FUNCTION: getEditDistanceDamerauBounded
+*   @param1 str1: First string
+*   @param2 str2: Second string
+*   @param3 k: Largest distance of interest
+*   @returns the optimal string alignment distance if it is at most k,
+*            k + 1 otherwise
+*
+*   INFO: Same band as getEditDistanceBounded, where two adjacent
+*         characters typed the other way around also cost a single edit.
+*         The swaps need the cell two rows up, so three rows are kept,
+*         and the calculation stops once two rows in a row exceed k.
+*/
+short getEditDistanceDamerauBounded(char* str1, char* str2, short k) {
+
+    short len1 = strlen(str1);
+    short len2 = strlen(str2);
+
+    if(k < 0) return 0;
+    if(abs(len1 - len2) > k) return k + 1;
+
+    // No alignment costs more than deleting and inserting every character.
+    if(k > len1 + len2) k = len1 + len2;
+
+    const short width = 2 * k + 1;
+    const short inf = k + 1;
+
+    short bandStack[3 * (2 * BAND_STACK_WIDTH + 1)];
+    short* band = bandStack;
+
+    if(width > 2 * BAND_STACK_WIDTH + 1) {
+        band = malloc( 3 * width * sizeof(short) );
+
+        if(band == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Cell (i, j) of the matrix is stored at index j - i + k of row i.
+    short* prev2 = band;
+    short* prev = band + width;
+    short* cur = band + 2 * width;
+    short prevMin = 0;
+    short i, j, d;
+
+    // Initializing first row
+    for(d = 0; d < width; d++) {
+        j = d - k;
+        prev[d] = (j >= 0 && j <= len2) ? j : inf;
+        prev2[d] = inf;
+    }
+
+    for(i = 1; i <= len1; i++) {
+        short rowMin = inf;
+
+        for(d = 0; d < width; d++) {
+            j = i + d - k;
+
+            if(j < 0 || j > len2) {
+                cur[d] = inf;
+                continue;
+            }
+            if(j == 0) {
+                cur[d] = (i < inf) ? i : inf;
+            } else if(str1[i-1] == str2[j-1]) {
+                cur[d] = prev[d];
+            } else {
+                short up = (d + 1 < width) ? prev[d+1] : inf;
+                short left = (d > 0) ? cur[d-1] : inf;
+
+                cur[d] = getMin(up + 1, left + 1, prev[d] + SUBSTITUTION_COST);
+
+                // The last two characters are swapped.
+                if(i > 1 && j > 1 && str1[i-1] == str2[j-2] && str1[i-2] == str2[j-1] && prev2[d] + 1 < cur[d]) {
+                    cur[d] = prev2[d] + 1;
+                }
+                if(cur[d] > inf) cur[d] = inf;
             }
-        }
-    }
 
-    return ED;
-}
-/*
-*   FUNCTION: getEditDistance
-*   @param1 str1: First string
-*   @param2 str2: Second string
-*   @returns the distance
-*
-*   INFO: Calculates and returns the edit distance between 
-*         two given strings.
-*/
-short getEditDistance(char* str1, char* str2) {
-    
-    short len1 = strlen(str1);
-    short len2 = strlen(str2);
-    short** ED = getEditDistanceMatrix(str1, len1, str2, len2);
+            if(cur[d] < rowMin) rowMin = cur[d];
+        }
 
-    // Return the bottom-right element
-    int val = ED[len1][len2];
+        // The distance can not get smaller in later rows, a swap reaches one row further.
+        if(rowMin > k && prevMin > k) {
+            if(band != bandStack) free(band);
+            return inf;
+        }
+        prevMin = rowMin;
 
-    for(short i = 0;i <= len1; i++) {
-        free(ED[i]);
+        short* tmp = prev2;
+        prev2 = prev;
+        prev = cur;
+        cur = tmp;
     }
-    free(ED);
 
+    short val = prev[len2 - len1 + k];
+
+    if(band != bandStack) free(band);
     return val;
 }
 
@@ -583,25 +5467,623 @@ void toLower(char string[], int len) {
         if(string[i] >= 'A' && string[i] <= 'Z') string[i] += 32;
     }
 }
-bool isPrime(int x) {
-    int i;
-    for(i = 2; i <= x/2; i++) {
-        if(x % i == 0) return false;
+/*
+*   FUNCTION: mapFile
+*   @param1 fp: Pointer to the file
+*   @param2(return parameter) length: Length of the file
+*   @returns the address of the file's contents in memory
+*
+*   INFO: Maps the whole file read-only and shared, so its pages come
+*         from the page cache and are shared by every process mapping
+*         it. Where mmap is not available the file is read into a
+*         single heap block instead. Empty files are not mapped, NULL is
+*         returned for them.
+*/
+void* mapFile(FILE* fp, size_t* length) {
+    void* mapping;
+
+#ifdef _WIN32
+    fseek(fp, 0, SEEK_END);
+    *length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    mapping = malloc(*length);
+
+    if(mapping == NULL || fread(mapping, sizeof(char), *length, fp) != *length) {
+        printf("ERROR: Could not read the dictionary file.\n");
+        exit(EXIT_FAILURE);
     }
-    return true;
+#else
+    struct stat st;
+
+    if(fstat(fileno(fp), &st) != 0) {
+        printf("ERROR: Could not read the dictionary file.\n");
+        exit(EXIT_FAILURE);
+    }
+    *length = st.st_size;
+
+    if(*length == 0) {
+        return NULL;
+    }
+
+    mapping = mmap(NULL, *length, PROT_READ, MAP_SHARED, fileno(fp), 0);
+
+    if(mapping == MAP_FAILED) {
+        printf("ERROR: Could not map the dictionary file.\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+
+    return mapping;
 }
-int getLineCount(FILE* fp) {
-    int count = 0;
-    // Get current position of the file pointer
-    long pos = ftell(fp); 
-    // Set the pointer position to the beginning of the file
-    fseek(fp, 0, SEEK_SET); 
-    // Count newline characters
-    while(!feof(fp)) {
-        if(fgetc(fp) == '\n') count++;
-    }
-    // Set the position back where it was before
-    fseek(fp, pos, SEEK_SET); 
-    return count;
+void unmapFile(void* mapping, size_t length) {
+#ifdef _WIN32
+    free(mapping);
+#else
+    if(mapping != NULL) munmap(mapping, length);
+#endif
+}
+/*
+*   FUNCTION: correctWord
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 key: The misspelled word, lowercased
+*   @param3(return parameter) wordFound: The pointer that the address
+*                                       of the most similar word found
+*                                       will be copied into
+*   @param4(return parameter) path: Buffer of EDIT_PATH_LENGTH bytes
+*                                   the transformation steps are
+*                                   written into
+*   @returns the distance, as findMostSimilarWord
+*
+*   INFO: Looks the key up in suggestionCache first. Only on a miss are
+*         the word and its path calculated, and then they are cached.
+*/
+short correctWord(HashTable_t* hashTable, char* key, char** wordFound, char* path) {
+    short dist;
+
+    if(suggestionCache != NULL && suggestionCacheGet(suggestionCache, hashTable, key, wordFound, &dist, path)) {
+        return dist;
+    }
+
+    dist = findMostSimilarWord(hashTable, key, wordFound);
+    path[0] = '\0';
+
+    if(dist <= getDistanceLimit() && *wordFound != NULL) {
+        snprintf(path, EDIT_PATH_LENGTH, "%s", getEditPath(*wordFound, key));
+    }
+
+    if(suggestionCache != NULL) {
+        suggestionCachePut(suggestionCache, hashTable, key, *wordFound, dist, path);
+    }
+    return dist;
+}
+/*
+*   FUNCTION: suggestionCacheCreate
+*   @param1 capacity: Number of corrections the cache holds
+*   @returns a pointer to the created cache
+*
+*   INFO: Every entry and the index are allocated here, the cache does
+*         not allocate memory afterwards. Entries are replaced with the
+*         CLOCK algorithm, an approximation of LRU that only sets a bit
+*         on a hit, so hits do not reorder a list.
+*/
+SuggestionCache_t* suggestionCacheCreate(int capacity) {
+    SuggestionCache_t* cache = malloc( sizeof(SuggestionCache_t) );
+
+    if(cache == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int indexSize = 1;
+    while(indexSize < 2 * capacity) indexSize *= 2;
+
+    cache->capacity = capacity;
+    cache->entries = malloc( capacity * sizeof(CacheEntry_t) );
+    cache->index = malloc( indexSize * sizeof(int) );
+    cache->indexMask = indexSize - 1;
+    cache->generation = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+
+    if(cache->entries == NULL || cache->index == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_init(&cache->lock, NULL);
+    suggestionCacheClear(cache);
+
+    return cache;
+}
+/*
+*   FUNCTION: suggestionCacheGet
+*   @param1 cache: Pointer to the cache
+*   @param2 hashTable: The dictionary the correction is for
+*   @param3 key: The misspelled word, lowercased
+*   @param4(return parameter) wordFound: The cached correction
+*   @param5(return parameter) distance: The cached distance
+*   @param6(return parameter) path: Buffer of EDIT_PATH_LENGTH bytes
+*                                   the cached path is copied into
+*   @returns true on a hit, false on a miss
+*
+*   INFO: The results are copied out while the lock is held, so another
+*         thread may replace the entry right after. Entries found in
+*         another HashTable are dropped first.
+*/
+bool suggestionCacheGet(SuggestionCache_t* cache, HashTable_t* hashTable, char* key, char** wordFound, short* distance, char* path) {
+    unsigned int hash = getStringHash(key, strlen(key));
+    bool hit = false;
+
+    pthread_mutex_lock(&cache->lock);
+
+    if(cache->generation != hashTable->generation) {
+        suggestionCacheClear(cache);
+        cache->generation = hashTable->generation;
+    }
+
+    int slot = suggestionCacheFind(cache, key, hash);
+
+    if(slot != -1 && cache->index[slot] != -1) {
+        CacheEntry_t* entry = &cache->entries[ cache->index[slot] ];
+
+        entry->referenced = true;
+        *wordFound = entry->word;
+        *distance = entry->distance;
+        strcpy(path, entry->path);
+        hit = true;
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return hit;
+}
+/*
+*   FUNCTION: suggestionCachePut
+*   @param1 cache: Pointer to the cache
+*   @param2 hashTable: The dictionary the correction was found in
+*   @param3 key: The misspelled word, lowercased
+*   @param4 word: The correction, NULL if there is none
+*   @param5 distance: Distance between the key and the correction
+*   @param6 path: Transformation steps, shorter than EDIT_PATH_LENGTH
+*   @returns nothing
+*
+*   INFO: Until the cache is full, the next unused entry is taken.
+*         Then the clock hand goes over the entries, giving the ones
+*         that were hit since it last passed another round, and the
+*         first one that was not is replaced. Keys that do not fit into
+*         an entry are not cached.
+*/
+void suggestionCachePut(SuggestionCache_t* cache, HashTable_t* hashTable, char* key, char* word, short distance, char* path) {
+    int len = strlen(key);
+
+    if(len >= CONSOLE_INPUT_LENGTH || cache->capacity == 0) {
+        return;
+    }
+
+    unsigned int hash = getStringHash(key, len);
+
+    pthread_mutex_lock(&cache->lock);
+
+    if(cache->generation != hashTable->generation) {
+        suggestionCacheClear(cache);
+        cache->generation = hashTable->generation;
+    }
+
+    int slot = suggestionCacheFind(cache, key, hash);
+    int e;
+
+    if(cache->index[slot] != -1) {
+        // Another thread stored the key since it missed.
+        e = cache->index[slot];
+    } else {
+        if(cache->count < cache->capacity) {
+            e = cache->count++;
+        } else {
+            while(cache->entries[cache->hand].referenced) {
+                cache->entries[cache->hand].referenced = false;
+                cache->hand = (cache->hand + 1) % cache->capacity;
+            }
+            e = cache->hand;
+            cache->hand = (cache->hand + 1) % cache->capacity;
+
+            CacheEntry_t* victim = &cache->entries[e];
+            suggestionCacheRemove(cache, suggestionCacheFind(cache, victim->key, victim->hash));
+
+            // Removing the victim may have moved the empty slot of the key back.
+            slot = suggestionCacheFind(cache, key, hash);
+        }
+        cache->index[slot] = e;
+    }
+
+    CacheEntry_t* entry = &cache->entries[e];
+
+    memcpy(entry->key, key, len + 1);
+    entry->hash = hash;
+    entry->word = word;
+    entry->distance = distance;
+    entry->referenced = false;
+    snprintf(entry->path, EDIT_PATH_LENGTH, "%s", path);
+
+    pthread_mutex_unlock(&cache->lock);
+}
+// Probes the index from the hash of the key, -1 is only returned for keys that can not be cached
+int suggestionCacheFind(SuggestionCache_t* cache, char* key, unsigned int hash) {
+    if(cache->capacity == 0) {
+        return -1;
+    }
+
+    int slot = hash & cache->indexMask;
+
+    while(cache->index[slot] != -1) {
+        CacheEntry_t* entry = &cache->entries[ cache->index[slot] ];
+
+        if(entry->hash == hash && strcmp(entry->key, key) == 0) break;
+
+        slot = (slot + 1) & cache->indexMask;
+    }
+    return slot;
+}
+/*
+*   FUNCTION: suggestionCacheRemove
+*   @param1 cache: Pointer to the cache
+*   @param2 slot: Slot of the index that holds an entry
+*   @returns nothing
+*
+*   INFO: Linear probing can not simply empty a slot, the keys after it
+*         would no longer be found. Each key of the run that follows is
+*         moved into the hole unless its home slot lies between the hole
+*         and the key, which keeps the index free of tombstones.
+*/
+void suggestionCacheRemove(SuggestionCache_t* cache, int slot) {
+    int hole = slot;
+    int next = slot;
+
+    while(1) {
+        next = (next + 1) & cache->indexMask;
+        if(cache->index[next] == -1) break;
+
+        int home = cache->entries[ cache->index[next] ].hash & cache->indexMask;
+
+        if(((next - home) & cache->indexMask) >= ((next - hole) & cache->indexMask)) {
+            cache->index[hole] = cache->index[next];
+            hole = next;
+        }
+    }
+    cache->index[hole] = -1;
+}
+void suggestionCacheClear(SuggestionCache_t* cache) {
+    memset(cache->index, -1, (cache->indexMask + 1) * sizeof(int));
+    cache->count = 0;
+    cache->hand = 0;
+}
+void suggestionCacheFree(SuggestionCache_t* cache) {
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->entries);
+    free(cache->index);
+    free(cache);
+}
+/*
+*   FUNCTION: checkBatch
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 in: The text to check
+*   @param3 out: The file the results are written into
+*   @param4 format: OUTPUT_TEXT or OUTPUT_JSON
+*   @returns nothing
+*
+*   INFO: Reads the input in large blocks and splits it into words at
+*         every character other than a-z and A-Z, lowercasing them on the
+*         way. The words are collected into a WordSet_t first, so each
+*         distinct word is looked up once and only the distinct incorrect
+*         ones pay for findMostSimilarWord. Words longer than the console
+*         input are skipped.
+*         The results are written in the order of the first occurrences.
+*         OUTPUT_TEXT only reports the words that are not correct,
+*         OUTPUT_JSON writes a record for every distinct word. If more
+*         than one suggestion is asked for, the records of the incorrect
+*         words also list the suggestions of findMostSimilarWords. A
+*         summary is printed to stderr.
+*/
+void checkBatch(HashTable_t* hashTable, FILE* in, FILE* out, OutputFormat_t format, int suggestionCount) {
+    char letters[256];
+    char token[CONSOLE_INPUT_LENGTH];
+    int tokenLen = 0;
+    long long tokenCount = 0, skipped = 0;
+    size_t i, n;
+
+    // Lowercase letter of each character, 0 for the characters that separate words
+    memset(letters, 0, sizeof(letters));
+    for(i=0; i<26; i++) {
+        letters['a' + i] = 'a' + i;
+        letters['A' + i] = 'a' + i;
+    }
+
+    char* buffer = malloc(BATCH_READ_SIZE);
+
+    if(buffer == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    //      COLLECTING THE DISTINCT WORDS
+    WordSet_t* set = wordSetCreate(1024);
+
+    do {
+        n = fread(buffer, sizeof(char), BATCH_READ_SIZE, in);
+
+        for(i=0; i<=n; i++) {
+            // The end of the input also ends the last word.
+            char c = (i < n) ? letters[(unsigned char) buffer[i]] : 0;
+
+            if(c != 0) {
+                if(tokenLen < CONSOLE_INPUT_LENGTH - 1) {
+                    token[tokenLen] = c;
+                }
+                tokenLen++;
+
+            } else if(tokenLen > 0 && (i < n || n < BATCH_READ_SIZE)) {
+                tokenCount++;
+
+                if(tokenLen < CONSOLE_INPUT_LENGTH) {
+                    token[tokenLen] = '\0';
+                    wordSetAdd(set, token, tokenLen);
+                } else {
+                    skipped++;
+                }
+                tokenLen = 0;
+            }
+        }
+    } while(n == BATCH_READ_SIZE);
+
+    free(buffer);
+
+    //      CHECKING THE DISTINCT WORDS
+    OutputBuffer_t output;
+    outputBufferInit(&output, out);
+    int incorrect = 0;
+
+    Suggestion_t* suggestions = NULL;
+
+    if(suggestionCount > 1) {
+        suggestions = malloc( suggestionCount * sizeof(Suggestion_t) );
+
+        if(suggestions == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(i=0; i<(size_t) set->count; i++) {
+        WordSetEntry_t* entry = &set->entries[i];
+        char* word = set->words + entry->offset;
+
+        if(hashTableFindKey(hashTable, word, entry->length) != -1) {
+            if(format == OUTPUT_JSON) {
+                outputPrintf(&output, "{\"word\":\"%s\",\"count\":%d,\"status\":\"correct\"}\n", word, entry->count);
+            }
+            continue;
+        }
+
+        char* mostSimilarWord;
+        short dist = findMostSimilarWord(hashTable, word, &mostSimilarWord);
+        incorrect++;
+
+        if(dist <= getDistanceLimit()) {
+            if(format == OUTPUT_JSON) {
+                outputPrintf(&output, "{\"word\":\"%s\",\"count\":%d,\"status\":\"incorrect\",\"suggestion\":\"%s\",\"distance\":%d",
+                             word, entry->count, mostSimilarWord, dist);
+            } else {
+                outputPrintf(&output, "Word \"%s\" is incorrect. The most similar word found is: \"%s\" (Edit Distance: %d, Count: %d)",
+                             word, mostSimilarWord, dist, entry->count);
+            }
+
+            if(suggestions != NULL) {
+                int count = findMostSimilarWords(hashTable, word, suggestionCount, getDistanceLimit(), suggestions);
+                outputSuggestions(&output, suggestions, count, format);
+            }
+            outputPrintf(&output, (format == OUTPUT_JSON) ? "}\n" : "\n");
+        } else {
+            if(format == OUTPUT_JSON) {
+                outputPrintf(&output, "{\"word\":\"%s\",\"count\":%d,\"status\":\"unknown\"}\n", word, entry->count);
+            } else {
+                outputPrintf(&output, "Word \"%s\" does not exist. (Count: %d)\n", word, entry->count);
+            }
+        }
+    }
+    outputFlush(&output);
+    free(output.data);
+    free(suggestions);
+
+    fprintf(stderr, "Checked %lld words, %d distinct, %d incorrect, %lld skipped.\n",
+            tokenCount, set->count, incorrect, skipped);
+
+    wordSetFree(set);
+}
+/*
+*   FUNCTION: wordSetCreate
+*   @param1 capacity: Expected number of distinct words
+*   @returns a pointer to the created set
+*
+*   INFO: The set grows as needed, the capacity only saves the first
+*         reallocations.
+*/
+WordSet_t* wordSetCreate(int capacity) {
+    WordSet_t* set = malloc( sizeof(WordSet_t) );
+
+    if(set == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    set->count = 0;
+    set->capacity = capacity;
+    set->indexSize = 1;
+    while(set->indexSize < 2 * capacity) set->indexSize *= 2;
+
+    set->wordsLength = 0;
+    set->wordsCapacity = capacity * 8;
+
+    set->entries = malloc( set->capacity * sizeof(WordSetEntry_t) );
+    set->index = malloc( set->indexSize * sizeof(int) );
+    set->words = malloc( set->wordsCapacity );
+
+    if(set->entries == NULL || set->index == NULL || set->words == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(set->index, -1, set->indexSize * sizeof(int));
+
+    return set;
+}
+/*
+*   FUNCTION: wordSetAdd
+*   @param1 set: Pointer to the set
+*   @param2 word: The word, a null terminated string
+*   @param3 len: Length of the word
+*   @returns nothing
+*
+*   INFO: Probes the index linearly from the FNV-1a hash of the word.
+*         The full hashes are kept in the entries, so most mismatches
+*         are rejected without comparing the strings, and doubling the
+*         index does not hash the words again.
+*/
+void wordSetAdd(WordSet_t* set, char* word, int len) {
+    unsigned int hash = getStringHash(word, len);
+    int mask = set->indexSize - 1;
+    int pos = hash & mask;
+
+    while(set->index[pos] != -1) {
+        WordSetEntry_t* entry = &set->entries[ set->index[pos] ];
+
+        if(entry->hash == hash && entry->length == len && memcmp(set->words + entry->offset, word, len) == 0) {
+            entry->count++;
+            return;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    // Copy the word into the arena
+    if(set->wordsLength + len + 1 > set->wordsCapacity) {
+        while(set->wordsLength + len + 1 > set->wordsCapacity) set->wordsCapacity *= 2;
+        set->words = realloc(set->words, set->wordsCapacity);
+
+        if(set->words == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(set->words + set->wordsLength, word, len + 1);
+
+    if(set->count == set->capacity) {
+        set->capacity *= 2;
+        set->entries = realloc(set->entries, set->capacity * sizeof(WordSetEntry_t));
+
+        if(set->entries == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    WordSetEntry_t* entry = &set->entries[set->count];
+    entry->offset = set->wordsLength;
+    entry->length = len;
+    entry->hash = hash;
+    entry->count = 1;
+
+    set->index[pos] = set->count++;
+    set->wordsLength += len + 1;
+
+    // Keep the index at most half full
+    if(2 * set->count > set->indexSize) {
+        int i;
+
+        set->indexSize *= 2;
+        mask = set->indexSize - 1;
+        set->index = realloc(set->index, set->indexSize * sizeof(int));
+
+        if(set->index == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(set->index, -1, set->indexSize * sizeof(int));
+
+        for(i=0; i<set->count; i++) {
+            pos = set->entries[i].hash & mask;
+            while(set->index[pos] != -1) pos = (pos + 1) & mask;
+            set->index[pos] = i;
+        }
+    }
+}
+void wordSetFree(WordSet_t* set) {
+    free(set->entries);
+    free(set->index);
+    free(set->words);
+    free(set);
+}
+/*
+*   FUNCTION: outputBufferInit
+*   @param1(return parameter) out: The buffer to initialize
+*   @param2 fp: The file the buffer writes into
+*   @returns nothing
+*
+*   INFO: The records are collected in OUTPUT_BUFFER_SIZE bytes and
+*         written with a single fwrite, instead of a call per record.
+*         The memory is given back by freeing out->data.
+*/
+void outputBufferInit(OutputBuffer_t* out, FILE* fp) {
+    out->fp = fp;
+    out->length = 0;
+    out->capacity = OUTPUT_BUFFER_SIZE;
+    out->data = malloc(out->capacity);
+
+    if(out->data == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+void outputPrintf(OutputBuffer_t* out, const char* format, ...) {
+    va_list args;
+    int space = out->capacity - out->length;
+
+    va_start(args, format);
+    int len = vsnprintf(out->data + out->length, space, format, args);
+    va_end(args);
+
+    if(len >= space) {
+        // The record did not fit, write out the buffer and format it again.
+        outputFlush(out);
+
+        va_start(args, format);
+        len = vsnprintf(out->data, out->capacity, format, args);
+        va_end(args);
+
+        if(len >= out->capacity) len = out->capacity - 1;
+    }
+    out->length += len;
 }
+// Appends the suggestions as a JSON array, or as a list in the text format
+void outputSuggestions(OutputBuffer_t* out, Suggestion_t* suggestions, int count, OutputFormat_t format) {
+    int i;
 
+    outputPrintf(out, (format == OUTPUT_JSON) ? ",\"suggestions\":[" : " Suggestions:");
+
+    for(i=0; i<count; i++) {
+        if(format == OUTPUT_JSON) {
+            outputPrintf(out, "%s{\"word\":\"%s\",\"distance\":%d,\"frequency\":%u}", (i > 0) ? "," : "",
+                         suggestions[i].word, suggestions[i].distance, suggestions[i].frequency);
+        } else {
+            outputPrintf(out, "%s \"%s\" (%d)", (i > 0) ? "," : "", suggestions[i].word, suggestions[i].distance);
+        }
+    }
+
+    if(format == OUTPUT_JSON) {
+        outputPrintf(out, "]");
+    }
+}
+void outputFlush(OutputBuffer_t* out) {
+    fwrite(out->data, sizeof(char), out->length, out->fp);
+    fflush(out->fp);
+    out->length = 0;
+}
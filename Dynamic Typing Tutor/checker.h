@@ -0,0 +1,586 @@
+#ifndef __CHECKER_H
+#define __CHECKER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define CONSOLE_INPUT_LENGTH 64 // Standart input buffer max length
+#define MAX_DIST_ALLOWED 3      // Maximum edit distance allowed for 2 words to be considered similar
+#define SUBSTITUTION_COST 1     // Distance value for substitution. For Levenshtein Distance, change this setting to 2
+#define BAND_STACK_WIDTH 64     // Widest band that getEditDistanceBounded keeps on the stack
+#define SYMSPELL_MAX_DELETES 2  // Default number of deletions the SymSpell index holds per dictionary word
+#define DICT_FILE_MAGIC "DTTD"  // First bytes of a versioned dictionary file (unversioned files start with the table size)
+#define DICT_FILE_VERSION 4     // Version of the dictionary file format written by hashTableSaveAsBinary
+#define DICT_MAX_SECTIONS 8     // Number of section entries in the header of a dictionary file
+#define BATCH_READ_SIZE 1048576 // Bytes read from the input at once in batch mode
+#define OUTPUT_BUFFER_SIZE 65536    // Bytes collected by an OutputBuffer_t before they are written
+#define HASH_GROUP_WIDTH 16     // Control bytes of the HashTable compared at once while probing
+#define HASH_EMPTY 0x80         // Control byte of an empty slot, fingerprints only use the lower 7 bits
+#define TEXT_PREFETCH_DISTANCE 16   // Words between the one inserted and the one prefetched by hashTableLoadFromText
+#define KEY_COST_UNIT 3         // Keyboard metric cost of an ordinary edit
+#define KEY_COST_SLIP 2         // Keyboard metric cost of a neighbouring key or a doubled key
+#define KEY_COST_SWAP 1         // Keyboard metric cost of two adjacent letters typed the other way around
+#define SUGGESTION_CACHE_SIZE 1024  // Default number of corrections kept by the suggestion cache
+#define EDIT_PATH_LENGTH (10 * CONSOLE_INPUT_LENGTH)    // Longest path of getEditPath for 2 words shorter than CONSOLE_INPUT_LENGTH
+#define EDIT_MATRIX_MAX_CELLS 65536 // Largest matrix getEditOps fills, longer strings are aligned with Hirschberg's algorithm
+#define HASH_GROW_LOAD_PERCENT 75   // Load factor at which hashTableAddWord starts moving the words into a table twice as large
+#define HASH_GROW_STEP 16           // Slots of the old table moved by each word added while the table grows
+#define HASH_RENUMBER_STEP 256      // Entries of each index given their new address by each word added after the table has grown
+#define WORD_LOG_COMPACT_SIZE 256   // Words in the log after which they are saved into the dictionary file and the log is emptied
+#define DELETE_INDEX_RUN_SIZE 4096  // Entries of the words added at run time the deletion index keeps sorted by inserting them, before the run moves to the first level
+#define DELETE_INDEX_LEVELS 20      // Levels of the deletion index, the runs of level i hold up to about DELETE_INDEX_RUN_SIZE << i entries
+#define DELETE_INDEX_MERGE_PACE 4   // Entries each merge of the deletion index writes for every entry inserted
+#define DAWG_FILE_MAGIC "DTTA"  // First bytes of an automaton file written by dawgSave
+#define DAWG_FILE_VERSION 1     // Version of the automaton file format
+#define QGRAM_COUNT (27 * 27)   // Bigrams of the q-gram index: each character is a-z or the padding around the word
+#define QGRAM_LISTS (CONSOLE_INPUT_LENGTH * (QGRAM_COUNT + 1))  // Posting lists of the q-gram index: one per word length and bigram, and one of every word of the length
+#define QGRAM_PENDING_SIZE 4096 // Words added at run time the q-gram index verifies without its lists before they are merged into them
+#define QGRAM_MERGE_PACE 2      // The lists are merged within QGRAM_PENDING_SIZE / QGRAM_MERGE_PACE words added
+
+// Programs that use the functions below together with their own main
+// (e.g. checkerBenchmark.c) compile checker.c with -Dmain=__hidden_main__
+
+typedef struct {
+
+    int wordIndex;      // Address of the word in the HashTable
+    int firstChild;     // Index of the first child node, -1 if the node is a leaf
+    int nextSibling;    // Index of the next node that has the same parent, -1 if there is none
+    short edge;         // Edit distance between this node's word and its parent's word
+
+} BKNode_t;
+
+typedef struct {
+
+    BKNode_t* nodes;    // Nodes are stored contiguously, the root is nodes[0]
+    int count;
+    int capacity;       // Allocated nodes, 0 if the nodes live in a mapped dictionary file
+    int renumbered;     // The nodes from renumbered to renumberEnd still hold addresses of the table before it grew
+    int renumberEnd;
+
+} BKTree_t;
+
+typedef struct {
+
+    unsigned int* hashes;   // Hashes of the deletion strings, sorted
+    int* wordIndices;       // Address of the word each deletion string was generated from
+    int count;
+    int capacity;           // Allocated entries, 0 if the run lives in a mapped dictionary file
+    int renumbered;         // The entries from renumbered to renumberEnd still hold addresses of the table before it grew
+    int renumberEnd;
+
+} DeleteRun_t;
+
+typedef struct {
+
+    DeleteRun_t runs[2];    // Runs of the level, while there are two they are merged into output
+    int runCount;
+    DeleteRun_t output;     // Merge of the two runs so far, it moves up a level once it is complete
+    int first;              // Entries of each run merged so far
+    int second;
+
+} DeleteLevel_t;
+
+typedef struct {
+
+    int maxDeletes;             // Largest number of deletions that were applied to the words
+    DeleteRun_t insertRun;      // Entries of the last words added at run time
+    DeleteLevel_t levels[DELETE_INDEX_LEVELS];  // Sorted runs, level i + 1 receives the merged runs of level i
+
+} DeleteIndex_t;
+
+typedef struct {
+
+    unsigned int hash;      // Hash of the deletion string
+    int wordIndex;          // Address of the word it was generated from
+
+} DeleteEntry_t;
+
+typedef struct {
+
+    unsigned int* listOffsets;  // Start of each posting list in postings, QGRAM_LISTS + 1 entries, the lists of length l start at l * (QGRAM_COUNT + 1)
+    unsigned char* postings;    // Word addresses of each list in ascending order: the first one and the differences, as varints
+    unsigned int postingsLength;
+    int* pending;               // Addresses of the words added at run time, which are not in the lists
+    int pendingCount;
+    int pendingCapacity;
+    bool mapped;                // True if the lists live in a mapped dictionary file
+    bool renumbering;           // True if the lists hold addresses of the table before it grew, until the merge replaces them
+    int sealed;                 // First pending words, which are being merged into the lists
+    unsigned int* batchOffsets; // Start of each list in batchIds, QGRAM_LISTS + 1 entries
+    unsigned int* batchIds;     // Addresses of the sealed words in each list, in ascending order
+    unsigned char* mergeBlock;  // Offsets and postings of the lists merged so far, NULL if no merge is in progress
+    unsigned int mergeLength;   // Bytes of postings written to mergeBlock
+    int mergeList;              // Next list to merge
+    int mergeStep;              // Bytes of postings and sealed addresses merged for each word added
+
+} QGramIndex_t;
+
+typedef struct {
+
+    unsigned int offset;        // Position of the word in the string arena
+    unsigned short length;      // Length of the word, 0 if the slot is empty
+    unsigned char fingerprint;  // Top 7 bits of the word's hash, the same as its control byte
+    unsigned char reserved;
+
+} HashSlot_t;
+
+typedef struct {
+
+    HashSlot_t* slots;
+    unsigned char* control;     // Fingerprint of each slot or HASH_EMPTY, followed by a copy of the first HASH_GROUP_WIDTH bytes
+    int size;                   // A power of two, at least HASH_GROUP_WIDTH
+    int wordCount;
+    unsigned int* frequencies;  // Frequency of the word in each slot, NULL if the dictionary has none
+    char* words;                // String arena: the words one after another, each terminated by '\0'
+    unsigned int wordsLength;   // Used bytes of the arena
+    unsigned int wordsCapacity; // Allocated bytes of the arena, 0 if it lives in a mapped dictionary file
+    BKTree_t* bkTree;           // Metric index over the words in the table, used for similarity queries
+    DeleteIndex_t* deleteIndex; // Symmetric deletion index of the words, NULL if it was not built
+    QGramIndex_t* qgramIndex;   // Bigram posting lists of the words by length, NULL if they were not built
+    void* mapping;              // Dictionary file the table is used from in place, NULL if it is on the heap
+    size_t mappingLength;
+    unsigned int generation;    // Unique to each table and changed by every word added, results cached for another generation are stale
+    HashSlot_t* nextSlots;      // Slots of the table being grown into, NULL if the table is not growing
+    unsigned char* nextControl;
+    unsigned int* nextFrequencies;
+    int nextSize;
+    int* nextAddresses;         // New address of every slot moved so far
+    int moved;                  // Slots of the current table moved so far, words are looked up here until all of them are
+    int* oldAddresses;          // New address of every slot of the table before it grew, NULL once no index holds those addresses
+
+} HashTable_t;
+
+typedef enum {
+
+    SECTION_SLOTS = 1,          // HashSlot_t[size]
+    SECTION_WORDS,              // String arena
+    SECTION_BKTREE,             // BKNode_t[], root first
+    SECTION_DELETE_HASHES,      // Sorted unsigned int[], param: number of deletions
+    SECTION_DELETE_WORDS,       // int[], parallel to SECTION_DELETE_HASHES
+    SECTION_CONTROL,            // unsigned char[size + HASH_GROUP_WIDTH]
+    SECTION_FREQUENCIES,        // unsigned int[size]
+    SECTION_QGRAMS              // unsigned int[QGRAM_LISTS + 1] list offsets, then the postings, param: QGRAM_LISTS
+
+} DictSectionId_t;
+
+typedef struct {
+
+    int id;                     // One of DictSectionId_t, readers skip the ones they do not know
+    int param;                  // Section specific value
+    long long offset;           // Position of the section in the file, a multiple of 8
+    long long length;           // Length of the section in bytes
+
+} DictSection_t;
+
+typedef struct {
+
+    unsigned int firstEdge;     // Index of the first outgoing edge, the edges of a state are sorted by label
+    unsigned short edgeCount;
+    unsigned char final;        // 1 if a word ends at this state
+    unsigned char reserved;
+    unsigned int wordCount;     // Number of words accepted from this state, words are numbered with it
+
+} DawgState_t;
+
+typedef struct {
+
+    unsigned int target;        // State the edge leads to
+    unsigned char label;
+    unsigned char reserved[3];
+
+} DawgEdge_t;
+
+typedef struct {
+
+    char magic[4];              // DAWG_FILE_MAGIC
+    int version;                // DAWG_FILE_VERSION
+    int stateCount;             // DawgState_t[stateCount] follow the header, then DawgEdge_t[edgeCount]
+    int edgeCount;
+    int wordCount;
+    int root;
+    int maxLength;              // Length of the longest word
+    int reserved;
+
+} DawgFileHeader_t;
+
+typedef struct {
+
+    DawgState_t* states;        // Equivalent states are merged, so shared suffixes are stored once
+    DawgEdge_t* edges;
+    int stateCount;
+    int edgeCount;
+    int wordCount;
+    int root;
+    int maxLength;
+    int stateCapacity;          // Allocated states and edges, 0 if they live in a mapped file
+    int edgeCapacity;
+    void* mapping;              // Automaton file the arrays are used from in place, NULL if they are on the heap
+    size_t mappingLength;
+
+} Dawg_t;
+
+typedef struct {
+
+    Dawg_t* dawg;
+    char* key;
+    int keyLen;
+    short rows[CONSOLE_INPUT_LENGTH + 1][CONSOLE_INPUT_LENGTH + 1];   // Distances between the key and the prefix at each depth
+    char prefix[CONSOLE_INPUT_LENGTH];  // Labels of the path to the current state
+    short best;                 // Distance of the best word found so far
+    char* wordFound;            // Buffer the best word is copied into
+
+} DawgSearch_t;
+
+typedef struct {
+
+    char magic[4];              // DICT_FILE_MAGIC
+    int version;                // DICT_FILE_VERSION
+    int size;                   // Size of the HashTable
+    int wordCount;              // Number of elements in the HashTable
+    int sectionCount;
+    int reserved;
+    DictSection_t sections[DICT_MAX_SECTIONS];
+
+} DictFileHeader_t;
+
+typedef struct {
+
+    char* str;                          // The pattern itself
+    int len;                            // Length of the pattern
+    int blocks;                         // Number of 64-bit words holding one bit per pattern character
+    unsigned long long* peq;            // Match masks: bit i of peq[c * blocks + b] is set if pattern[64*b + i] == c
+    unsigned long long* pv;             // Positive vertical deltas of the current column, one word per block
+    unsigned long long* mv;             // Negative vertical deltas of the current column, one word per block
+    unsigned long long* d0;             // Zero diagonal deltas of the current column, used by getEditDistancePatternDamerau
+    unsigned long long inlinePeq[256];  // Storage for peq when the pattern fits into a single block
+
+} EditPattern_t;
+
+typedef enum {
+
+    EDIT_COPY,          // The characters of both strings are the same
+    EDIT_DELETE,        // The character of the second string is deleted
+    EDIT_INSERT,        // The character of the first string is inserted
+    EDIT_SUBSTITUTE,    // The character of the second string is replaced by the one of the first string
+    EDIT_TRANSPOSE      // Two characters of the second string are swapped into the two of the first string
+
+} EditOpType_t;
+
+typedef struct {
+
+    EditOpType_t type;
+    char c;             // Character of the first string, or the deleted one of the second string
+    char c2;            // Second character of the first string for EDIT_TRANSPOSE, 0 otherwise
+    short pos1;         // Position in the first string the operation is at
+    short pos2;         // Position in the second string the operation is at
+
+} EditOp_t;
+
+typedef struct {
+
+    short* matrix;          // Edit distance matrix as a single block, row after row
+    int matrixCapacity;
+    short* rows;            // The two rows of getEditOpsHirschberg
+    int rowsCapacity;
+    EditOp_t* ops;          // Operations found by the last getEditOps, in the order of the strings
+    int opCount;
+    int opCapacity;
+    short distance;         // Total cost of the operations
+    bool transpositions;    // Swapped characters are a single operation
+    char* text;             // Human readable form written by getEditPathText
+    int textCapacity;
+
+} EditScratch_t;
+
+typedef enum {
+
+    SEARCH_LINEAR,      // Compare the key against every word in the table
+    SEARCH_BKTREE,      // Query the BK-Tree of the table within MAX_DIST_ALLOWED
+    SEARCH_SYMSPELL,    // Look up the deletions of the key in the deletion index
+    SEARCH_PARALLEL,    // Split the table among the threads of searchPool
+    SEARCH_QGRAM        // Verify the words of similar length that share enough bigrams with the key
+
+} SearchMode_t;
+
+typedef enum {
+
+    METRIC_UNIT,        // Every edit costs the same
+    METRIC_KEYBOARD,    // Typing slips on a QWERTY keyboard cost less than other edits
+    METRIC_DAMERAU      // Two adjacent characters typed the other way around are a single edit
+
+} DistanceMetric_t;
+
+typedef struct {
+
+    char* word;
+    int wordIndex;              // Address of the word in the HashTable
+    short distance;             // Edit distance between the word and the key
+    unsigned int frequency;     // Frequency of the word in the dictionary, 0 if it has none
+
+} Suggestion_t;
+
+typedef struct {
+
+    Suggestion_t* items;        // Max-heap, items[0] is the worst suggestion kept
+    int count;
+    int capacity;               // Number of suggestions wanted
+    short maxDist;              // Largest distance a suggestion may have
+
+} SuggestionHeap_t;
+
+typedef struct SearchPool SearchPool_t;
+
+typedef struct {
+
+    SearchPool_t* pool;
+    int id;             // Workers scan the slot ranges in the order of their ids
+    short min;          // Best distance found in the range of the worker
+    int minIndex;       // Address of the word at that distance, -1 if there is none
+    Suggestion_t* suggestions;  // Best words in the range of the worker for findMostSimilarWordsParallel
+    int suggestionCount;
+    int suggestionCapacity;
+
+} SearchWorker_t;
+
+struct SearchPool {
+
+    pthread_t* threads;
+    SearchWorker_t* workers;
+    int threadCount;
+
+    pthread_mutex_t lock;
+    pthread_cond_t workReady;   // Signalled when a new query is posted
+    pthread_cond_t workDone;    // Signalled when the last worker finishes a query
+    unsigned int generation;    // Incremented for each query
+    int pending;                // Workers that have not finished the current query
+    bool quit;
+
+    HashTable_t* hashTable;     // Current query
+    char* key;
+    int k;                      // Number of suggestions wanted, 0 if only the most similar word is
+    short maxDist;              // Largest distance of the suggestions
+    atomic_int bound;           // Best distance found by any worker so far, the k-th best for suggestions
+
+};
+
+typedef struct {
+
+    char key[CONSOLE_INPUT_LENGTH];     // Normalized misspelled word
+    unsigned int hash;                  // getStringHash of the key
+    char* word;                         // Correction in the HashTable, NULL if no word is close enough
+    short distance;                     // Distance returned by findMostSimilarWord
+    bool referenced;                    // Set by every hit, cleared when the clock hand passes
+    char path[EDIT_PATH_LENGTH];        // Result of getEditPath, empty if there is no correction
+
+} CacheEntry_t;
+
+typedef struct {
+
+    CacheEntry_t* entries;
+    int capacity;
+    int count;                  // Used entries, they are never freed, only replaced
+    int hand;                   // Next entry the clock considers for replacement
+    int* index;                 // Entry of each slot of a linear probing table, -1 if the slot is empty
+    int indexMask;              // Slots of the index minus one, at least twice the capacity
+    unsigned int generation;    // Generation of the HashTable the entries were found in
+    unsigned long long hits;
+    unsigned long long misses;
+    pthread_mutex_t lock;
+
+} SuggestionCache_t;
+
+typedef enum {
+
+    OUTPUT_TEXT,        // Sentences for the words that are not correct
+    OUTPUT_JSON         // One JSON object per line for every distinct word
+
+} OutputFormat_t;
+
+typedef struct {
+
+    FILE* fp;
+    char* data;
+    int length;
+    int capacity;
+
+} OutputBuffer_t;
+
+typedef struct {
+
+    unsigned int offset;    // Position of the word in the arena of the set
+    int length;
+    unsigned int hash;
+    int count;              // Occurrences of the word in the batch
+
+} WordSetEntry_t;
+
+typedef struct {
+
+    WordSetEntry_t* entries;    // Distinct words in the order of their first occurrence
+    int count;
+    int capacity;
+    int* index;                 // Open addressing table of entry numbers, -1 if the slot is empty
+    int indexSize;              // A power of two, at least twice the number of entries
+    char* words;                // Arena of null terminated words
+    unsigned int wordsLength;
+    unsigned int wordsCapacity;
+
+} WordSet_t;
+
+extern const char hashedDictFile[];                                         // Hashed Dictionary File
+extern SearchMode_t searchMode;                                             // Strategy used by findMostSimilarWord
+extern int deleteIndexDistance;                                             // Deletions per word for new deletion indexes, 0 disables them
+extern SearchPool_t* searchPool;                                            // Threads used by SEARCH_PARALLEL, created once in main
+extern DistanceMetric_t distanceMetric;                                     // Distance the words are ranked by
+extern SuggestionCache_t* suggestionCache;                                  // Corrections of the words checked before, NULL if disabled
+extern atomic_uint lastTableGeneration;                                     // Generation of the most recently created HashTable
+extern const char wordLogFile[];                                            // Words added at run time, replayed on every start
+
+HashTable_t* hashTableLoadFromText(FILE* fp);                               // Returns the given ASCII formatted dictionary file as a hashtable in memory
+HashTable_t* hashTableLoadFromBinary(FILE* fp);                             // Copies a given hashtable binary file into memory and returns its pointer
+HashTable_t* hashTableMapBinary(FILE* fp);                                  // Maps a current version hashtable binary file into memory and uses it in place
+bool hashTableValidate(HashTable_t* hashTable);                             // Checks that the sections of a mapped file refer to each other within their bounds
+HashTable_t* hashTableCreate(int size);                                     // Creates an empty hashtable with at least the given number of slots
+HashTable_t* hashTableRehash(HashTable_t* hashTable);                       // Moves the words of a table saved by an older version into a new one
+void hashTableFree(HashTable_t* hm);                                        // Deallocates a hashtable
+bool hashTableSaveAsBinary(HashTable_t* hashTable, const char* filePath);   // Saves the given hashtable into the disk as a binary file
+int hashTableFindKey(HashTable_t* hashTable, char* key, int keyLen);        // Finds and returns the index of the given key in the hashtable, or -1 if the key does not exist
+int hashTableCalculateOptimalSize(int numberOfElements);                    // Determines the size that the hashtable should have to store the given number of elements
+unsigned long long hashTableGetHash(char* key, int keyLen);                 // Returns the 64-bit hash value of the given key
+unsigned int hashTableMatchGroup(unsigned char* group, unsigned char byte);  // Returns a bit mask of the control bytes in a group that are equal to the given byte
+int hashTableInsert(HashTable_t* hashTable, char* word, int len);           // Stores a word unless the table already has it and returns its address
+int hashTableAddWord(HashTable_t* hashTable, char* word, int len);          // Same as above for a table in use: grows it step by step and keeps its indexes up to date
+void hashTableDetach(HashTable_t* hashTable);                               // Copies a table used from a mapped file onto the heap, so words can be added
+void hashTableGrowStart(HashTable_t* hashTable);                            // Allocates the arrays of a table twice as large, the words are moved by hashTableGrowStep
+void hashTableGrowStep(HashTable_t* hashTable, int count);                  // Moves the words of the next slots into the larger table, finishing the growth after the last one
+void hashTableGrowFinish(HashTable_t* hashTable);                           // Moves every remaining word and switches to the larger table, the indexes are renumbered by hashTableRenumberStep
+void hashTableRenumberStep(HashTable_t* hashTable, int count);              // Gives up to count entries of each index their address in the larger table
+int hashTablePlaceSlot(HashTable_t* hashTable, int addr, HashSlot_t* slots, unsigned char* control, int size);  // Copies a slot into the first empty slot of its probe sequence in other arrays
+int wordLogReplay(HashTable_t* hashTable, const char* path);                // Adds the words of a log to the table and returns the number of words in it
+bool wordLogAppend(const char* path, char* word, int len);                  // Appends a word to a log, false if it could not be written
+void wordLogCompact(HashTable_t* hashTable, const char* filePath, const char* logPath);  // Saves the table as a binary file and empties the log
+char* hashTableGetWord(HashTable_t* hashTable, int addr);                   // Returns the word at the given address, or NULL if the slot is empty
+unsigned int hashTableGetFrequency(HashTable_t* hashTable, int addr);       // Returns the frequency of the word at the given address, 0 if it is not known
+bool hashTableRanksBefore(HashTable_t* hashTable, int addr, int other);     // True if the word at addr wins a tie with the one at other (-1 for none): more frequent, then alphabetically first
+void hashTableStoreWord(HashTable_t* hashTable, int addr, char* word, int len);  // Copies a word into the arena and points the slot at the given address to it
+
+BKTree_t* bkTreeBuild(HashTable_t* hashTable);                              // Builds a BK-Tree indexing every word in the given hashtable
+void bkTreeInsert(BKTree_t* tree, HashTable_t* hashTable, int wordIndex);   // Inserts the word at the given address of the hashtable into the tree
+int bkTreeGetAddress(BKTree_t* tree, HashTable_t* hashTable, int node);     // Returns the address of the word of a node in the current table
+void bkTreeFree(BKTree_t* tree);                                            // Deallocates a BK-Tree
+
+DeleteIndex_t* deleteIndexBuild(HashTable_t* hashTable, int maxDeletes);    // Builds the symmetric deletion index of every word in the given hashtable
+void deleteIndexFree(DeleteIndex_t* index);                                 // Deallocates a deletion index
+DeleteIndex_t* deleteIndexCreate(int maxDeletes, DeleteRun_t* run);         // Creates a deletion index that holds the given sorted run
+void deleteIndexInsert(DeleteIndex_t* index, HashTable_t* hashTable, int wordIndex);  // Adds the deletions of a word to the insertion run and advances the merges of the index
+void deleteIndexAddRun(DeleteIndex_t* index, HashTable_t* hashTable, int level, DeleteRun_t* run);  // Puts a run into a level, a second run there starts merging them
+void deleteIndexMergeStep(DeleteIndex_t* index, HashTable_t* hashTable, int level, int count);   // Merges up to count entries of the two runs of a level, moving the result up once it is complete
+DeleteRun_t* deleteIndexMerge(DeleteIndex_t* index, HashTable_t* hashTable);   // Merges every run of the index into one and returns it, NULL if the index is empty
+int deleteIndexGetRuns(DeleteIndex_t* index, DeleteRun_t** runs, bool outputs);   // Lists the runs of the index, with the merges in progress if outputs is true
+int deleteRunGetAddress(DeleteRun_t* run, HashTable_t* hashTable, int entry);  // Returns the address of the word of an entry in the current table
+
+Dawg_t* dawgBuild(char** words, int count);                                 // Builds the minimal automaton of a sorted list of distinct words
+Dawg_t* dawgBuildFromTable(HashTable_t* hashTable);                         // Same as above, with the words of a hashtable
+int dawgFreezeState(Dawg_t* dawg, DawgEdge_t* edges, int edgeCount, bool final, int** registry, int* registrySize);  // Returns the state equal to the given one, adding it if there is none
+unsigned int dawgHashState(DawgEdge_t* edges, int edgeCount, bool final);   // Hashes a state for the registry of frozen states
+bool dawgSave(Dawg_t* dawg, const char* filePath);                          // Saves the automaton as a flat binary file
+Dawg_t* dawgMap(FILE* fp);                                                  // Maps an automaton file into memory and uses it in place
+Dawg_t* dawgOpen(const char* filePath, const char* dictPath);               // Maps an automaton file, building it from the dictionary first if there is none
+void dawgCheckInput(Dawg_t* dawg);                                          // Checks the words typed in with the automaton until -1 is entered
+void dawgFree(Dawg_t* dawg);                                                // Deallocates an automaton
+int dawgFindEdge(Dawg_t* dawg, int state, unsigned char label);             // Returns the state an edge with the label leads to, or -1
+bool dawgContains(Dawg_t* dawg, char* word);                                // Returns true if the automaton accepts the word
+int dawgGetWordId(Dawg_t* dawg, char* word);                                // Returns the position of the word in the sorted list, or -1
+short dawgFindMostSimilarWord(Dawg_t* dawg, char* key, char* wordFound);    // Walks the automaton with the rows of the distance to the key, returns the distance and copies the best word
+void dawgSearchState(DawgSearch_t* search, int state, int depth);          // Visits the edges of a state whose rows can still lead to a better word
+int deleteIndexGetCandidates(HashTable_t* hashTable, char* key, int** candidates, int* capacity);   // Collects the sorted addresses of the words that share a deletion with the key
+
+QGramIndex_t* qgramIndexBuild(HashTable_t* hashTable);                      // Builds the bigram posting lists of every word in the given hashtable
+void qgramIndexFree(QGramIndex_t* index);                                   // Deallocates a q-gram index
+void qgramIndexInsert(QGramIndex_t* index, int wordIndex);                  // Adds a word to the words the index verifies without its lists
+void qgramIndexSeal(QGramIndex_t* index, HashTable_t* hashTable);           // Starts merging the pending words into the lists
+void qgramIndexMergeStep(QGramIndex_t* index, HashTable_t* hashTable, long long count);  // Merges the next lists until count bytes and addresses are merged, switching to the new lists after the last one
+void qgramIndexMerge(QGramIndex_t* index, HashTable_t* hashTable);          // Merges every pending word into the lists
+void qgramSortAddresses(unsigned int* ids, unsigned int* scratch, int count);   // Sorts addresses with a radix sort, scratch holds count of them
+int qgramIndexGetCandidates(HashTable_t* hashTable, char* key, short maxDist, int** candidates, int* capacity);   // Collects the addresses of the words that may be within maxDist of the key
+int qgramIndexDecodeList(QGramIndex_t* index, int list, unsigned int* ids); // Decodes a posting list and returns the number of addresses
+int qgramMergeList(unsigned int* ids, unsigned short* counts, int count, unsigned int* list, int listCount, int weight, int remaining, int threshold, unsigned int* outIds, unsigned short* outCounts);  // Adds a posting list to the counts, keeping the addresses that can still reach the threshold
+int qgramGetLists(HashTable_t* hashTable, int addr, int* lists);           // Writes the q-gram lists a word belongs to (up to CONSOLE_INPUT_LENGTH + 2) and returns their number
+int getQGrams(char* word, int len, int* grams);                             // Writes the ids of the padded bigrams of a word and returns their number
+int varintEncode(unsigned int value, unsigned char* out);                   // Writes a number in 7 bit groups, lowest first, and returns the number of bytes
+int getDeletionHashes(char* word, int maxDeletes, unsigned int** hashes, int* capacity);   // Collects the hashes of every string obtained by deleting up to maxDeletes characters
+unsigned int getStringHash(char* str, int len);                             // Returns the FNV-1a hash of the given string
+
+void* mapFile(FILE* fp, size_t* length);                        // Maps the whole given file into memory read-only
+void unmapFile(void* mapping, size_t length);                   // Releases a mapping created by mapFile
+void writeSection(FILE* fp, DictFileHeader_t* header, int id, int param, void* data, long long length);   // Appends a section to a dictionary file being written
+
+int getMin(int x, int y, int z);                                // Returns the smallest number among the 3 given numbers
+int compareInts(const void* a, const void* b);                  // qsort comparator for ints in ascending order
+int compareUnsignedInts(const void* a, const void* b);          // qsort comparator for unsigned ints in ascending order
+int compareStrings(const void* a, const void* b);               // qsort comparator for strings in strcmp order
+int compareDeleteEntries(const void* a, const void* b);         // qsort comparator for deletion index entries
+void collectDeletionHashes(char* buffer, int len, int start, int deletesLeft, unsigned int** hashes, int* capacity, int* count);
+bool hasInvalidChars(char* string);                             // Returns true if the given string has characters other than a-z, false otherwise
+void toLower(char string[], int len);                           // Converts all characters to lowercase
+
+WordSet_t* wordSetCreate(int capacity);                         // Creates an empty set of words with room for the given number of words
+void wordSetAdd(WordSet_t* set, char* word, int len);           // Adds a word to the set, or counts one more occurrence if it is already there
+void wordSetFree(WordSet_t* set);                               // Deallocates a set of words
+void outputBufferInit(OutputBuffer_t* out, FILE* fp);           // Prepares a buffer that writes into the given file
+void outputPrintf(OutputBuffer_t* out, const char* format, ...);    // Appends formatted text to the buffer, writing it out when it is full
+void outputFlush(OutputBuffer_t* out);                          // Writes the contents of the buffer into its file
+void outputSuggestions(OutputBuffer_t* out, Suggestion_t* suggestions, int count, OutputFormat_t format);  // Appends a list of suggestions to the current record
+
+short findMostSimilarWord(HashTable_t* hashTable, char* key, char** wordFound);     // Finds the most similar word in the table to the given string using EditDistance algorithm
+short findMostSimilarWordLinear(HashTable_t* hashTable, char* key, char** wordFound);   // Same as above, by comparing the key against every word in the table
+short findMostSimilarWordBKTree(HashTable_t* hashTable, char* key, char** wordFound);   // Same as above, by querying the BK-Tree within MAX_DIST_ALLOWED
+short findMostSimilarWordSymSpell(HashTable_t* hashTable, char* key, char** wordFound); // Same as above, by looking up the deletions of the key in the deletion index
+short findMostSimilarWordParallel(HashTable_t* hashTable, char* key, char** wordFound); // Same as above, by scanning the table with the threads of searchPool
+short findMostSimilarWordQGram(HashTable_t* hashTable, char* key, char** wordFound);    // Same as above, by verifying the candidates of the q-gram index
+SearchPool_t* searchPoolCreate(int threadCount);                                    // Starts a pool of threads for parallel searches
+void searchPoolFree(SearchPool_t* pool);                                            // Stops the threads of a pool and deallocates it
+void* searchPoolWorker(void* arg);                                                  // Thread function of the pool: scans its range for every posted query
+int findMostSimilarWords(HashTable_t* hashTable, char* key, int k, short maxDist, Suggestion_t* suggestions); // Finds the k best words within maxDist of the key and returns how many were found
+void findMostSimilarWordsLinear(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap);    // Same as above, by comparing the key against every word in the table
+void findMostSimilarWordsBKTree(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap);    // Same as above, by querying the BK-Tree
+void findMostSimilarWordsSymSpell(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap);  // Same as above, by looking up the deletions of the key in the deletion index
+void findMostSimilarWordsParallel(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap);  // Same as above, by scanning the table with the threads of searchPool
+void findMostSimilarWordsQGram(HashTable_t* hashTable, char* key, SuggestionHeap_t* heap);     // Same as above, by verifying the candidates of the q-gram index
+void suggestionHeapPush(SuggestionHeap_t* heap, HashTable_t* hashTable, int wordIndex, short distance); // Offers a word to the heap, which keeps it if it is among the best
+short suggestionHeapBound(SuggestionHeap_t* heap);                                  // Returns the largest distance a word may have to enter the heap
+bool suggestionIsWorse(Suggestion_t* a, Suggestion_t* b);                           // Returns true if a ranks below b: farther, or as far and less frequent, or alphabetically later
+void checkBatch(HashTable_t* hashTable, FILE* in, FILE* out, OutputFormat_t format, int suggestionCount); // Checks every word of a text and writes the results of the distinct ones
+short correctWord(HashTable_t* hashTable, char* key, char** wordFound, char* path); // findMostSimilarWord and getEditPath through suggestionCache
+SuggestionCache_t* suggestionCacheCreate(int capacity);                             // Allocates a cache for the given number of corrections
+bool suggestionCacheGet(SuggestionCache_t* cache, HashTable_t* hashTable, char* key, char** wordFound, short* distance, char* path); // Copies a cached correction of the key out, returns false if there is none
+void suggestionCachePut(SuggestionCache_t* cache, HashTable_t* hashTable, char* key, char* word, short distance, char* path);        // Stores a correction, replacing one that was not used recently
+int suggestionCacheFind(SuggestionCache_t* cache, char* key, unsigned int hash);    // Returns the index slot that holds the key, or the empty slot it would go into
+void suggestionCacheRemove(SuggestionCache_t* cache, int slot);                     // Empties a slot of the index, moving the entries after it back
+void suggestionCacheClear(SuggestionCache_t* cache);                                // Drops every correction, the counters are kept
+void suggestionCacheFree(SuggestionCache_t* cache);                                 // Deallocates a cache
+short getEditDistance(char* str1, char* str2);                                      // Returns the edit distance value between 2 given strings
+void editPatternInit(EditPattern_t* pattern, char* str);                            // Precomputes the bit masks of a string for the bit-parallel distance
+void editPatternRelease(EditPattern_t* pattern);                                    // Deallocates the memory held by a pattern, if any
+short getEditDistancePattern(EditPattern_t* pattern, char* str);                    // Returns the edit distance between a precomputed pattern and a string
+short getEditDistanceBounded(char* str1, char* str2, short k);                      // Returns the edit distance between 2 strings, or k + 1 if it exceeds k
+short getEditDistanceKeyboard(char* word, char* typed, short k);                    // Same as above, with the costs of the keyboard metric
+short getEditDistanceDamerauBounded(char* str1, char* str2, short k);               // Same as above, counting swapped characters as a single edit
+short getEditDistanceDamerau(char* str1, char* str2);                               // Returns the optimal string alignment distance between 2 given strings
+short getEditDistancePatternDamerau(EditPattern_t* pattern, char* str);             // Same as above, between a precomputed pattern and a string
+short getEditDistanceMetric(char* str1, char* str2, short k);                       // Same as above, with the costs of distanceMetric
+short getDistanceLimit(void);                                                       // Returns MAX_DIST_ALLOWED in the units of distanceMetric
+char* getEditPath(char* str1, char* str2);                                          // Returns the shortest transformation path between 2 given strings, in a thread's own arena
+short getEditOps(EditScratch_t* scratch, char* str1, char* str2);                   // Writes the operations of the shortest path into the arena and returns the distance
+void getEditOpsMatrix(EditScratch_t* scratch, char* str1, short len1, char* str2, short len2, short offset1, short offset2);     // Appends the operations traced back through a full matrix
+void getEditOpsHirschberg(EditScratch_t* scratch, char* str1, short len1, char* str2, short len2, short offset1, short offset2); // Same as above, in linear space
+char* getEditPathText(EditScratch_t* scratch);                                      // Writes the operations in the arena as a human readable string
+EditOp_t* editScratchAddOp(EditScratch_t* scratch, EditOpType_t type, char c, short pos1, short pos2);  // Appends an operation to the arena
+short* getEditDistanceRows(char* str1, short len1, char* str2, short len2, bool reversed, bool transpositions, short* rows, short** beforeLast); // Returns the last row of a matrix, keeping 3 rows
+void editScratchReserve(void** buffer, int* capacity, size_t count, size_t size);  // Grows a buffer of an arena to hold at least the given number of elements
+void editScratchRelease(EditScratch_t* scratch);                                    // Deallocates the buffers of an arena, which can be used again afterwards
+short** getEditDistanceMatrix(char* str1, short len1, char* str2, short len2);      // Returns the edit distance matrix for 2 given strings
+
+#endif
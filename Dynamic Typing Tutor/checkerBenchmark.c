@@ -0,0 +1,558 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "checker.h"
+
+#define BENCHMARK_ROUNDS 20     // Times every key set is looked up
+#define DISTANCE_KEYS 200       // Misses compared against every word of the dictionary by the distance kernels
+#define CORRECTION_KEYS 2000    // Misses corrected with the BK-Tree and with the automaton
+#define DIFFERENTIAL_PAIRS 20000    // Random string pairs the distance kernels are checked on against the matrix
+#define DIFFERENTIAL_LENGTH 200     // Longest random string, so patterns of several 64 bit blocks are checked
+#define MISMATCHES_SHOWN 10     // Mismatches of the distance kernels that are printed
+
+// The table checker.c used before the fingerprinted power of two table:
+// an array of strings, a prime size and Horner's method modulo the size.
+typedef struct {
+
+    char** table;
+    int size;
+
+} LegacyTable_t;
+
+typedef struct {
+
+    char** keys;
+    int* lengths;
+    int count;
+
+} KeySet_t;
+
+LegacyTable_t* legacyTableBuild(HashTable_t* hashTable);        // Copies the words of a HashTable into a LegacyTable_t
+int legacyTableFindKey(LegacyTable_t* legacy, char* key, int keyLen);   // Same as hashTableFindKey for the legacy table
+void legacyTableFree(LegacyTable_t* legacy);
+void keySetAdd(KeySet_t* set, char* key);                       // Appends a copy of a key to the set
+void keySetShuffle(KeySet_t* set);                              // Puts the keys into a random order
+int checkDistanceKernels(void);                                 // Compares the distance kernels with the matrix on random pairs and returns the mismatches
+int checkFrequencyTies(void);                                   // Compares the correction of every strategy with the first suggestion on words that tie and returns the mismatches
+short referenceDistance(char* str1, char* str2, bool transpositions);   // Edit distance of a full matrix, optimal string alignment if transpositions is true
+void randomString(char* buffer, int len, int alphabet);         // Writes len random letters among the first alphabet ones
+double getTime(void);                                           // Returns a monotonic time in seconds
+
+int main(int argc, char** argv) {
+
+    const char* path = (argc > 1) ? argv[1] : hashedDictFile;
+    FILE* fp = fopen(path, "rb");
+
+    if(fp == NULL) {
+        printf("ERROR: Could not read file: %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    // Only the table is measured, the indexes are not needed.
+    deleteIndexDistance = 0;
+
+    HashTable_t* hashTable = hashTableLoadFromBinary(fp);
+    fclose(fp);
+
+    LegacyTable_t* legacy = legacyTableBuild(hashTable);
+
+    //      COLLECTING THE KEYS
+    // Hits are the words of the dictionary, misses are the same words with
+    // their last letter changed until they are not in the dictionary.
+    KeySet_t hits = {NULL, NULL, 0}, misses = {NULL, NULL, 0};
+    char buffer[CONSOLE_INPUT_LENGTH];
+    int i, j;
+
+    for(i=0; i<hashTable->size; i++) {
+        char* word = hashTableGetWord(hashTable, i);
+        if(word == NULL) continue;
+
+        keySetAdd(&hits, word);
+
+        int len = strlen(word);
+        strcpy(buffer, word);
+
+        for(j=0; j<25; j++) {
+            buffer[len - 1] = 'a' + (buffer[len - 1] - 'a' + 1) % 26;
+
+            if(hashTableFindKey(hashTable, buffer, len) == -1) {
+                keySetAdd(&misses, buffer);
+                break;
+            }
+        }
+    }
+
+    srand(1);
+    keySetShuffle(&hits);
+    keySetShuffle(&misses);
+
+    //      MEASURING
+    KeySet_t* sets[2] = {&hits, &misses};
+    const char* names[2] = {"hit", "miss"};
+    int s, round;
+
+    printf("Words: %d, legacy table: %d slots, table: %d slots\n", hashTable->wordCount, legacy->size, hashTable->size);
+
+    for(s=0; s<2; s++) {
+        KeySet_t* set = sets[s];
+        long long found = 0;
+
+        double start = getTime();
+        for(round=0; round<BENCHMARK_ROUNDS; round++) {
+            for(i=0; i<set->count; i++) {
+                found += legacyTableFindKey(legacy, set->keys[i], set->lengths[i]) != -1;
+            }
+        }
+        double legacyTime = getTime() - start;
+
+        start = getTime();
+        for(round=0; round<BENCHMARK_ROUNDS; round++) {
+            for(i=0; i<set->count; i++) {
+                found += hashTableFindKey(hashTable, set->keys[i], set->lengths[i]) != -1;
+            }
+        }
+        double tableTime = getTime() - start;
+
+        double lookups = (double) set->count * BENCHMARK_ROUNDS;
+
+        printf("%-4s lookups: legacy %6.1f ns, table %6.1f ns (%lld found)\n", names[s],
+               legacyTime * 1e9 / lookups, tableTime * 1e9 / lookups, found);
+    }
+
+    //      CHECKING THE DISTANCE KERNELS
+    // The bit-parallel and banded kernels against the edit distance matrix.
+    int kernelMismatches = checkDistanceKernels();
+
+    printf("distance kernels: %d random pairs checked against the matrix (%d mismatches)\n", DIFFERENTIAL_PAIRS, kernelMismatches);
+
+    // Ties at the same distance go to the more frequent word with every strategy.
+    int tieMismatches = checkFrequencyTies();
+
+    printf("frequency ties: corrections of every strategy checked against the first suggestion (%d mismatches)\n", tieMismatches);
+
+    //      MEASURING THE DISTANCE KERNELS
+    // A linear search: some misses against every word, with the limit of each metric as the bound.
+    int keyCount = (misses.count < DISTANCE_KEYS) ? misses.count : DISTANCE_KEYS;
+    double pairs = (double) keyCount * hashTable->wordCount;
+    double unitTime = 0;
+
+    short (*kernels[3])(char*, char*, short) = {getEditDistanceBounded, getEditDistanceDamerauBounded, getEditDistanceKeyboard};
+    const char* kernelNames[3] = {"unit", "damerau", "keyboard"};
+    const short limits[3] = {MAX_DIST_ALLOWED, MAX_DIST_ALLOWED, MAX_DIST_ALLOWED * KEY_COST_UNIT};
+    int kernel;
+
+    for(kernel=0; kernel<3; kernel++) {
+        long long within = 0;
+
+        double start = getTime();
+        for(s=0; s<keyCount; s++) {
+            for(i=0; i<hashTable->size; i++) {
+                char* word = hashTableGetWord(hashTable, i);
+                if(word == NULL) continue;
+
+                within += kernels[kernel](word, misses.keys[s], limits[kernel]) <= limits[kernel];
+            }
+        }
+        double kernelTime = getTime() - start;
+
+        if(kernel == 0) unitTime = kernelTime;
+
+        printf("%-8s distances: %6.1f ns, %.2fx unit (%lld within %d)\n", kernelNames[kernel],
+               kernelTime * 1e9 / pairs, kernelTime / unitTime, within, limits[kernel]);
+    }
+
+    //      MEASURING THE WORD AUTOMATON
+    // The automaton against the table it is built from: its size, exact
+    // lookups, and corrections against the BK-Tree, which must find the
+    // same distance.
+    double start = getTime();
+    Dawg_t* dawg = dawgBuildFromTable(hashTable);
+    double buildTime = getTime() - start;
+
+    size_t dawgBytes = (size_t) dawg->stateCount * sizeof(DawgState_t) + (size_t) dawg->edgeCount * sizeof(DawgEdge_t);
+    size_t tableBytes = (size_t) hashTable->size * (sizeof(HashSlot_t) + 1) + HASH_GROUP_WIDTH + hashTable->wordsLength;
+    size_t treeBytes = (hashTable->bkTree != NULL) ? (size_t) hashTable->bkTree->count * sizeof(BKNode_t) : 0;
+
+    printf("Automaton: %d states, %d edges, built in %.1f ms\n", dawg->stateCount, dawg->edgeCount, buildTime * 1e3);
+    printf("Memory: automaton %.2f MB, table %.2f MB, table and BK-Tree %.2f MB\n",
+           dawgBytes / 1048576.0, tableBytes / 1048576.0, (tableBytes + treeBytes) / 1048576.0);
+
+    for(s=0; s<2; s++) {
+        KeySet_t* set = sets[s];
+        long long found = 0;
+
+        start = getTime();
+        for(round=0; round<BENCHMARK_ROUNDS; round++) {
+            for(i=0; i<set->count; i++) {
+                found += hashTableFindKey(hashTable, set->keys[i], set->lengths[i]) != -1;
+            }
+        }
+        double tableTime = getTime() - start;
+
+        start = getTime();
+        for(round=0; round<BENCHMARK_ROUNDS; round++) {
+            for(i=0; i<set->count; i++) {
+                found += dawgContains(dawg, set->keys[i]);
+            }
+        }
+        double dawgTime = getTime() - start;
+
+        double lookups = (double) set->count * BENCHMARK_ROUNDS;
+
+        printf("%-4s lookups: table %6.1f ns, automaton %6.1f ns (%lld found)\n", names[s],
+               tableTime * 1e9 / lookups, dawgTime * 1e9 / lookups, found);
+    }
+
+    if(hashTable->bkTree != NULL) {
+        keyCount = (misses.count < CORRECTION_KEYS) ? misses.count : CORRECTION_KEYS;
+        char wordFound[CONSOLE_INPUT_LENGTH];
+        char* treeFound;
+        short treeDistances[CORRECTION_KEYS];
+        int mismatches = 0;
+
+        start = getTime();
+        for(s=0; s<keyCount; s++) {
+            treeDistances[s] = findMostSimilarWordBKTree(hashTable, misses.keys[s], &treeFound);
+        }
+        double treeTime = getTime() - start;
+
+        start = getTime();
+        for(s=0; s<keyCount; s++) {
+            mismatches += dawgFindMostSimilarWord(dawg, misses.keys[s], wordFound) != treeDistances[s];
+        }
+        double dawgTime = getTime() - start;
+
+        printf("corrections: BK-Tree %6.1f us, automaton %6.1f us (%d distance mismatches)\n",
+               treeTime * 1e6 / keyCount, dawgTime * 1e6 / keyCount, mismatches);
+    }
+    dawgFree(dawg);
+
+    for(i=0; i<hits.count; i++) free(hits.keys[i]);
+    for(i=0; i<misses.count; i++) free(misses.keys[i]);
+    free(hits.keys);
+    free(hits.lengths);
+    free(misses.keys);
+    free(misses.lengths);
+
+    legacyTableFree(legacy);
+    hashTableFree(hashTable);
+    return 0;
+}
+/*
+*   FUNCTION: legacyTableBuild
+*   @param1 hashTable: Pointer to the HashTable
+*   @returns a pointer to the created table
+*
+*   INFO: Sizes the table with the nearest prime above twice the number
+*         of words and inserts them with linear probing, as checker.c
+*         did before it stored fingerprints.
+*/
+LegacyTable_t* legacyTableBuild(HashTable_t* hashTable) {
+    LegacyTable_t* legacy = malloc( sizeof(LegacyTable_t) );
+
+    if(legacy == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    legacy->size = hashTable->wordCount * 2;
+
+    int i, j;
+    for( ; ; legacy->size++) {
+        for(j=2; (long long) j * j <= legacy->size && legacy->size % j != 0; j++);
+        if((long long) j * j > legacy->size) break;
+    }
+
+    legacy->table = calloc(legacy->size, sizeof(char*));
+
+    if(legacy->table == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(i=0; i<hashTable->size; i++) {
+        char* word = hashTableGetWord(hashTable, i);
+        if(word == NULL) continue;
+
+        int addr = 0, len = strlen(word);
+        for(j=0; j<len; j++) {
+            addr = (addr * 31 + (word[j] - 96)) % legacy->size;
+        }
+        while(legacy->table[addr] != NULL) {
+            addr = (addr + 1) % legacy->size;
+        }
+        legacy->table[addr] = word;
+    }
+    return legacy;
+}
+int legacyTableFindKey(LegacyTable_t* legacy, char* key, int keyLen) {
+    int addr = 0, count = 0, i;
+
+    for(i=0; i<keyLen; i++) {
+        addr = (addr * 31 + (key[i] - 96)) % legacy->size;
+    }
+
+    while(legacy->table[addr] != NULL && count < legacy->size) {
+        if(strcmp(legacy->table[addr], key) == 0) return addr;
+
+        addr = (addr + 1) % legacy->size;
+        count++;
+    }
+    return -1;
+}
+void legacyTableFree(LegacyTable_t* legacy) {
+    free(legacy->table);
+    free(legacy);
+}
+void keySetAdd(KeySet_t* set, char* key) {
+    // Grow at every power of two
+    if((set->count & (set->count - 1)) == 0) {
+        int capacity = (set->count == 0) ? 1 : set->count * 2;
+        set->keys = realloc(set->keys, capacity * sizeof(char*));
+        set->lengths = realloc(set->lengths, capacity * sizeof(int));
+
+        if(set->keys == NULL || set->lengths == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    set->keys[set->count] = strdup(key);
+    set->lengths[set->count] = strlen(key);
+    set->count++;
+}
+void keySetShuffle(KeySet_t* set) {
+    int i;
+
+    for(i=set->count - 1; i>0; i--) {
+        int j = rand() % (i + 1);
+
+        char* key = set->keys[i];
+        set->keys[i] = set->keys[j];
+        set->keys[j] = key;
+
+        int len = set->lengths[i];
+        set->lengths[i] = set->lengths[j];
+        set->lengths[j] = len;
+    }
+}
+/*
+*   FUNCTION: checkDistanceKernels
+*   @returns the number of mismatches
+*
+*   INFO: Draws pairs of random strings of 0 to DIFFERENTIAL_LENGTH
+*         letters, with an alphabet of 2 to 26 letters so that small
+*         alphabets give many matches and swaps. Their distance is
+*         computed by the unit and Damerau kernels and compared with the
+*         matrix. getEditDistanceMatrix is the reference for the unit
+*         distance, and referenceDistance for the optimal string
+*         alignment one. A pattern is matched against both strings of
+*         the pair, once built from each side. The bounded kernels are
+*         given bounds below, at and above the distance, and must
+*         return k + 1 whenever the distance is greater than k. Each
+*         mismatch is printed with its kernel, up to MISMATCHES_SHOWN.
+*/
+int checkDistanceKernels(void) {
+    char str1[DIFFERENTIAL_LENGTH + 1], str2[DIFFERENTIAL_LENGTH + 1];
+    int mismatches = 0;
+    int pair, i;
+
+    srand(2);
+
+    for(pair=0; pair<DIFFERENTIAL_PAIRS; pair++) {
+        int alphabet = 2 + rand() % 25;
+
+        // Half of the pairs are close to each other, as a word and its misspelling.
+        int len1 = rand() % (DIFFERENTIAL_LENGTH + 1);
+        randomString(str1, len1, alphabet);
+
+        if(pair % 2 == 0) {
+            int len2 = rand() % (DIFFERENTIAL_LENGTH + 1);
+            randomString(str2, len2, alphabet);
+        } else {
+            strcpy(str2, str1);
+
+            int edits = rand() % 6, len2 = len1;
+            for(i=0; i<edits; i++) {
+                int pos = (len2 > 0) ? rand() % len2 : 0;
+                int type = rand() % 4;
+
+                if(type == 0 && len2 < DIFFERENTIAL_LENGTH) {
+                    memmove(str2 + pos + 1, str2 + pos, len2 - pos + 1);
+                    str2[pos] = 'a' + rand() % alphabet;
+                    len2++;
+                } else if(type == 1 && len2 > 0) {
+                    memmove(str2 + pos, str2 + pos + 1, len2 - pos);
+                    len2--;
+                } else if(type == 2 && len2 > 0) {
+                    str2[pos] = 'a' + rand() % alphabet;
+                } else if(pos + 1 < len2) {
+                    char swap = str2[pos];
+                    str2[pos] = str2[pos + 1];
+                    str2[pos + 1] = swap;
+                }
+            }
+        }
+
+        short unit = referenceDistance(str1, str2, false);
+        short damerau = referenceDistance(str1, str2, true);
+
+        EditPattern_t pattern;
+        editPatternInit(&pattern, str1);
+
+        short results[8] = {
+            getEditDistance(str1, str2), getEditDistance(str2, str1),
+            getEditDistancePattern(&pattern, str2), unit,
+            getEditDistanceDamerau(str1, str2), getEditDistanceDamerau(str2, str1),
+            getEditDistancePatternDamerau(&pattern, str2), damerau
+        };
+        const char* names[8] = {"getEditDistance", "getEditDistance (swapped)", "getEditDistancePattern", "",
+                                "getEditDistanceDamerau", "getEditDistanceDamerau (swapped)", "getEditDistancePatternDamerau", ""};
+        editPatternRelease(&pattern);
+
+        // The bounded kernels, with bounds around the distance and a random one.
+        short bounds[5] = {0, unit - 1, unit, unit + 1, rand() % 8};
+        short damerauBounds[5] = {0, damerau - 1, damerau, damerau + 1, bounds[4]};
+        int b;
+
+        for(b=0; b<5; b++) {
+            if(bounds[b] >= 0) {
+                short expected = (unit <= bounds[b]) ? unit : bounds[b] + 1;
+                short found = getEditDistanceBounded(str1, str2, bounds[b]);
+
+                if(found != expected && mismatches++ < MISMATCHES_SHOWN) {
+                    printf("MISMATCH: getEditDistanceBounded(\"%s\", \"%s\", %d) = %d instead of %d\n", str1, str2, bounds[b], found, expected);
+                }
+            }
+            if(damerauBounds[b] >= 0) {
+                short expected = (damerau <= damerauBounds[b]) ? damerau : damerauBounds[b] + 1;
+                short found = getEditDistanceDamerauBounded(str1, str2, damerauBounds[b]);
+
+                if(found != expected && mismatches++ < MISMATCHES_SHOWN) {
+                    printf("MISMATCH: getEditDistanceDamerauBounded(\"%s\", \"%s\", %d) = %d instead of %d\n", str1, str2, damerauBounds[b], found, expected);
+                }
+            }
+        }
+
+        for(i=0; i<8; i++) {
+            short expected = (i < 4) ? unit : damerau;
+
+            if(names[i][0] != '\0' && results[i] != expected && mismatches++ < MISMATCHES_SHOWN) {
+                printf("MISMATCH: %s(\"%s\", \"%s\") = %d instead of %d\n", names[i], str1, str2, results[i], expected);
+            }
+        }
+    }
+    return mismatches;
+}
+/*
+*   FUNCTION: checkFrequencyTies
+*   @returns the number of mismatches
+*
+*   INFO: Loads a small text dictionary whose words are at the same
+*         distance from the keys, with different frequencies ("cat" and
+*         "bat" from "xat") and equal ones ("cat" and "hat"). With the
+*         unit and Damerau distances, the correction of every search
+*         strategy must be the first suggestion of findMostSimilarWords,
+*         which ranks by distance, then frequency, then alphabetically.
+*         Each mismatch is printed, with the strategy and the metric.
+*/
+int checkFrequencyTies(void) {
+    const char* text = "cat 100\nbat 1\ndog 5\nhat 100\nact 7\ncast 3\n";
+    char* keys[] = {"xat", "at", "tac", "dat", "caat", "zzz"};
+    SearchMode_t modes[] = {SEARCH_LINEAR, SEARCH_PARALLEL, SEARCH_BKTREE, SEARCH_SYMSPELL, SEARCH_QGRAM};
+    const char* modeNames[] = {"linear", "parallel", "bktree", "symspell", "qgram"};
+    DistanceMetric_t metrics[] = {METRIC_UNIT, METRIC_DAMERAU};
+    const char* metricNames[] = {"unit", "damerau"};
+
+    FILE* fp = tmpfile();
+
+    if(fp == NULL) {
+        printf("ERROR: Could not create a temporary file.\n");
+        exit(EXIT_FAILURE);
+    }
+    fputs(text, fp);
+    fflush(fp);
+    rewind(fp);
+
+    HashTable_t* hashTable = hashTableLoadFromText(fp);
+    fclose(fp);
+
+    if(hashTable->deleteIndex == NULL) hashTable->deleteIndex = deleteIndexBuild(hashTable, 2);
+    if(hashTable->qgramIndex == NULL) hashTable->qgramIndex = qgramIndexBuild(hashTable);
+
+    SearchMode_t savedMode = searchMode;
+    DistanceMetric_t savedMetric = distanceMetric;
+    SearchPool_t* savedPool = searchPool;
+    int mismatches = 0, k, m, d;
+
+    searchPool = searchPoolCreate(2);
+
+    for(d=0; d<2; d++) {
+        distanceMetric = metrics[d];
+
+        for(k=0; k<(int) (sizeof(keys) / sizeof(keys[0])); k++) {
+            Suggestion_t best;
+            char* expected = (findMostSimilarWords(hashTable, keys[k], 1, getDistanceLimit(), &best) > 0) ? best.word : NULL;
+
+            for(m=0; m<(int) (sizeof(modes) / sizeof(modes[0])); m++) {
+                char* found;
+
+                searchMode = modes[m];
+                findMostSimilarWord(hashTable, keys[k], &found);
+
+                if(found != expected && (found == NULL || expected == NULL || strcmp(found, expected) != 0)) {
+                    printf("MISMATCH: %s %s correction of \"%s\" is \"%s\" instead of \"%s\"\n", modeNames[m], metricNames[d],
+                           keys[k], (found != NULL) ? found : "", (expected != NULL) ? expected : "");
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    searchPoolFree(searchPool);
+    searchPool = savedPool;
+    searchMode = savedMode;
+    distanceMetric = savedMetric;
+    hashTableFree(hashTable);
+
+    return mismatches;
+}
+short referenceDistance(char* str1, char* str2, bool transpositions) {
+    short len1 = strlen(str1), len2 = strlen(str2);
+    short** ED = getEditDistanceMatrix(str1, len1, str2, len2);
+    short i, j;
+
+    // The swaps are added to the matrix of the unit distance, row by row
+    if(transpositions) {
+        for(i=1; i<=len1; i++) {
+            for(j=1; j<=len2; j++) {
+                short best = getMin(ED[i-1][j] + 1, ED[i][j-1] + 1, ED[i-1][j-1] + (str1[i-1] != str2[j-1]) * SUBSTITUTION_COST);
+
+                if(i > 1 && j > 1 && str1[i-1] == str2[j-2] && str1[i-2] == str2[j-1] && ED[i-2][j-2] + 1 < best) {
+                    best = ED[i-2][j-2] + 1;
+                }
+                ED[i][j] = best;
+            }
+        }
+    }
+
+    short distance = ED[len1][len2];
+
+    for(i=0; i<=len1; i++) free(ED[i]);
+    free(ED);
+    return distance;
+}
+void randomString(char* buffer, int len, int alphabet) {
+    int i;
+
+    for(i=0; i<len; i++) {
+        buffer[i] = 'a' + rand() % alphabet;
+    }
+    buffer[len] = '\0';
+}
+double getTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "checkerServer.h"
+
+#define LOAD_MAX_WORDS 1000000  // Most words the load generator reads from its word list
+
+typedef struct {
+
+    const char* socketPath;
+    char** words;           // Words of the requests, shared by every connection
+    int wordCount;
+    int requests;           // Requests sent by each connection
+    RequestType_t type;
+    int count;              // Suggestions asked for by REQUEST_SUGGEST
+    int id;
+    double* latencies;      // Seconds each request took, written by the thread
+    int failures;
+
+} LoadWorker_t;
+
+int connectToServer(const char* socketPath);                    // Opens a connection to the server, or returns -1
+bool sendRequest(int fd, RequestType_t type, int count, char* word);    // Writes a request frame
+int receiveResponse(int fd, char* text, int capacity);          // Reads a response frame, returns its status or -1 and writes its text
+bool sendAll(int fd, unsigned char* buffer, int len);           // Writes the whole buffer, false if the connection failed
+bool receiveAll(int fd, unsigned char* buffer, int len);        // Reads exactly len bytes, false if the connection failed
+void printResponse(RequestType_t type, char* word, int status, char* text); // Prints a response the way the checker does
+void* loadWorker(void* arg);                                    // Thread function of the load generator: one connection sending requests
+int compareDoubles(const void* a, const void* b);               // qsort comparator for doubles in ascending order
+double getTime(void);                                           // Returns a monotonic time in seconds
+
+int main(int argc, char** argv) {
+
+    //      PARSING COMMAND LINE OPTIONS
+    const char* socketPath = SERVER_SOCKET_PATH;
+    RequestType_t type = REQUEST_CORRECT;
+    int count = 5;
+    int connections = 0, requests = 0;
+    int arg;
+    for(arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "--socket") == 0 && arg + 1 < argc) {
+            socketPath = argv[++arg];
+        } else if(strcmp(argv[arg], "--check") == 0) {
+            type = REQUEST_CHECK;
+        } else if(strcmp(argv[arg], "--correct") == 0) {
+            type = REQUEST_CORRECT;
+        } else if(strcmp(argv[arg], "--suggest") == 0 && arg + 1 < argc) {
+            type = REQUEST_SUGGEST;
+            count = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--load") == 0 && arg + 2 < argc) {
+            connections = atoi(argv[++arg]);
+            requests = atoi(argv[++arg]);
+        } else if(argv[arg][0] == '-' && argv[arg][1] != '\0') {
+            printf("Usage: %s [--socket PATH] [--check | --correct | --suggest N] [WORD]...\n"
+                   "       %s [--socket PATH] [--check | --correct | --suggest N] --load CONNECTIONS REQUESTS [WORDS.txt]\n", argv[0], argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            break;
+        }
+    }
+
+    if(count < 1) count = 1;
+    if(count > SERVER_MAX_SUGGESTIONS) count = SERVER_MAX_SUGGESTIONS;
+
+    //      SENDING THE GIVEN WORDS
+    if(connections <= 0) {
+        int fd = connectToServer(socketPath);
+        char word[CONSOLE_INPUT_LENGTH];
+        char text[SERVER_MAX_RESPONSE + 1];
+
+        if(fd == -1) {
+            printf("ERROR: Could not connect to socket: %s\n", socketPath);
+            return EXIT_FAILURE;
+        }
+
+        // Words come from the command line, or one per line from the standard input.
+        bool fromArguments = (arg < argc);
+
+        while(fromArguments ? arg < argc : scanf("%63s", word) == 1) {
+            if(fromArguments) {
+                snprintf(word, sizeof(word), "%s", argv[arg++]);
+            }
+
+            int status = -1;
+            if(sendRequest(fd, type, count, word)) {
+                status = receiveResponse(fd, text, sizeof(text));
+            }
+            if(status == -1) {
+                printf("ERROR: Connection to the server was lost.\n");
+                close(fd);
+                return EXIT_FAILURE;
+            }
+            printResponse(type, word, status, text);
+        }
+        close(fd);
+        return 0;
+    }
+
+    //      GENERATING LOAD
+    // Every connection is a thread that sends its requests one after the
+    // other, starting at its own place in the word list.
+    FILE* fWords = (arg < argc) ? fopen(argv[arg], "r") : stdin;
+
+    if(fWords == NULL) {
+        printf("ERROR: Could not read file: %s\n", argv[arg]);
+        return EXIT_FAILURE;
+    }
+
+    char** words = malloc( LOAD_MAX_WORDS * sizeof(char*) );
+    char word[CONSOLE_INPUT_LENGTH];
+    int wordCount = 0;
+
+    if(words == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    while(wordCount < LOAD_MAX_WORDS && fscanf(fWords, "%63s", word) == 1) {
+        words[wordCount++] = strdup(word);
+    }
+    if(fWords != stdin) {
+        fclose(fWords);
+    }
+    if(wordCount == 0) {
+        printf("ERROR: No words to send.\n");
+        return EXIT_FAILURE;
+    }
+    if(requests < 1) requests = 1;
+
+    LoadWorker_t* workers = malloc( connections * sizeof(LoadWorker_t) );
+    pthread_t* threads = malloc( connections * sizeof(pthread_t) );
+    double* latencies = malloc( (size_t) connections * requests * sizeof(double) );
+
+    if(workers == NULL || threads == NULL || latencies == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    double start = getTime();
+
+    for(i=0; i<connections; i++) {
+        workers[i] = (LoadWorker_t) {socketPath, words, wordCount, requests, type, count, i, latencies + (size_t) i * requests, 0};
+
+        if(pthread_create(&threads[i], NULL, loadWorker, &workers[i]) != 0) {
+            printf("ERROR: Could not create a thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    long long failures = 0;
+    for(i=0; i<connections; i++) {
+        pthread_join(threads[i], NULL);
+        failures += workers[i].failures;
+    }
+    double elapsed = getTime() - start;
+
+    long long total = (long long) connections * requests;
+    qsort(latencies, total, sizeof(double), compareDoubles);
+
+    printf("%lld requests on %d connections in %.3f s: %.0f requests/s, %lld failed\n",
+           total, connections, elapsed, (total - failures) / elapsed, failures);
+    printf("Latency: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           latencies[(long long) (0.50 * (total - 1))] * 1e6, latencies[(long long) (0.99 * (total - 1))] * 1e6, latencies[total - 1] * 1e6);
+
+    for(i=0; i<wordCount; i++) free(words[i]);
+    free(words);
+    free(workers);
+    free(threads);
+    free(latencies);
+    return 0;
+}
+int connectToServer(const char* socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(fd != -1 && connect(fd, (struct sockaddr*) &address, sizeof(address)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+bool sendRequest(int fd, RequestType_t type, int count, char* word) {
+    unsigned char frame[4 + SERVER_MAX_REQUEST];
+    int len = strlen(word);
+
+    if(len + 2 > SERVER_MAX_REQUEST) len = SERVER_MAX_REQUEST - 2;
+
+    frame[0] = 0;
+    frame[1] = 0;
+    frame[2] = (len + 2) >> 8;
+    frame[3] = (len + 2);
+    frame[4] = type;
+    frame[5] = count;
+    memcpy(frame + 6, word, len);
+
+    return sendAll(fd, frame, 6 + len);
+}
+/*
+*   FUNCTION: receiveResponse
+*   @param1 fd: Socket of the connection
+*   @param2(return parameter) text: Buffer the text of the response is
+*                                   written into, terminated by a zero
+*   @param3 capacity: Size of the buffer
+*   @returns the status of the response, or -1 if the connection failed
+*
+*   INFO: A text longer than the buffer is read to its end and cut.
+*/
+int receiveResponse(int fd, char* text, int capacity) {
+    unsigned char header[5];
+
+    if(!receiveAll(fd, header, 4)) return -1;
+
+    uint32_t len = ((uint32_t) header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+
+    if(len < 1 || !receiveAll(fd, header + 4, 1)) return -1;
+    len--;
+
+    uint32_t kept = (len < (uint32_t) capacity) ? len : (uint32_t) capacity - 1;
+
+    if(!receiveAll(fd, (unsigned char*) text, kept)) return -1;
+    text[kept] = '\0';
+
+    for( ; kept < len; kept++) {
+        unsigned char skipped;
+        if(!receiveAll(fd, &skipped, 1)) return -1;
+    }
+    return header[4];
+}
+bool sendAll(int fd, unsigned char* buffer, int len) {
+    while(len > 0) {
+        ssize_t sent = send(fd, buffer, len, MSG_NOSIGNAL);
+
+        if(sent == -1 && errno == EINTR) continue;
+        if(sent <= 0) return false;
+
+        buffer += sent;
+        len -= sent;
+    }
+    return true;
+}
+bool receiveAll(int fd, unsigned char* buffer, int len) {
+    while(len > 0) {
+        ssize_t received = recv(fd, buffer, len, 0);
+
+        if(received == -1 && errno == EINTR) continue;
+        if(received <= 0) return false;
+
+        buffer += received;
+        len -= received;
+    }
+    return true;
+}
+void printResponse(RequestType_t type, char* word, int status, char* text) {
+    if(status == STATUS_ERROR) {
+        printf("ERROR: %s: %s\n", word, text);
+    } else if(status == STATUS_CORRECT && type != REQUEST_SUGGEST) {
+        printf("Word \"%s\" is correct.\n", word);
+    } else if(status == STATUS_UNKNOWN) {
+        printf("Word \"%s\" does not exist.\n", word);
+    } else if(type == REQUEST_CHECK) {
+        printf("Word \"%s\" is incorrect.\n", word);
+    } else if(type == REQUEST_CORRECT) {
+        char mostSimilarWord[CONSOLE_INPUT_LENGTH];
+        int dist, offset = 0;
+
+        if(sscanf(text, "%63s %d %n", mostSimilarWord, &dist, &offset) >= 2) {
+            printf("Word \"%s\" is incorrect.\n"
+                   "The most similar word found is: \"%s\"\n"
+                   "Edit Distance: %d\n"
+                   "Transformation steps: %s\n", word, mostSimilarWord, dist, text + offset);
+        }
+    } else {
+        // Suggestions, one "word distance" line each
+        char* line = strtok(text, "\n");
+
+        printf("Suggestions for \"%s\":", word);
+        while(line != NULL) {
+            char* space = strchr(line, ' ');
+            if(space != NULL) *space = '\0';
+
+            char* next = strtok(NULL, "\n");
+            printf(" \"%s\" (%s)%s", line, (space != NULL) ? space + 1 : "?", (next != NULL) ? "," : "");
+            line = next;
+        }
+        printf("\n");
+    }
+}
+/*
+*   FUNCTION: loadWorker
+*   @param1 arg: Pointer to the LoadWorker_t of the thread
+*   @returns NULL
+*
+*   INFO: Waits for each response before the next request, so the
+*         latencies are those a tutor session would see. A connection
+*         that fails counts its remaining requests as failures, with no
+*         latency.
+*/
+void* loadWorker(void* arg) {
+    LoadWorker_t* worker = arg;
+    char text[SERVER_MAX_RESPONSE + 1];
+    int fd = connectToServer(worker->socketPath);
+    int i;
+
+    for(i=0; i<worker->requests; i++) {
+        char* word = worker->words[((long long) worker->id * 7919 + i) % worker->wordCount];
+        double start = getTime();
+
+        if(fd == -1 || !sendRequest(fd, worker->type, worker->count, word) || receiveResponse(fd, text, sizeof(text)) == -1) {
+            worker->failures += worker->requests - i;
+
+            for( ; i<worker->requests; i++) worker->latencies[i] = 0;
+            break;
+        }
+        worker->latencies[i] = getTime() - start;
+    }
+
+    if(fd != -1) close(fd);
+    return NULL;
+}
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+double getTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,579 @@
+#define _GNU_SOURCE     // accept4
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "checkerServer.h"
+
+volatile sig_atomic_t serverQuit = 0;       // Set by serverStop, checked by the event loop
+
+int main(int argc, char** argv) {
+
+    //      PARSING COMMAND LINE OPTIONS
+    const char* socketPath = SERVER_SOCKET_PATH;
+    int cacheSize = SUGGESTION_CACHE_SIZE;
+    int workerCount = sysconf(_SC_NPROCESSORS_ONLN);
+    int arg;
+    for(arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "--linear") == 0) {
+            searchMode = SEARCH_LINEAR;
+        } else if(strcmp(argv[arg], "--bktree") == 0) {
+            searchMode = SEARCH_BKTREE;
+        } else if(strcmp(argv[arg], "--symspell") == 0) {
+            searchMode = SEARCH_SYMSPELL;
+        } else if(strcmp(argv[arg], "--qgram") == 0) {
+            searchMode = SEARCH_QGRAM;
+        } else if(strcmp(argv[arg], "--keyboard") == 0) {
+            distanceMetric = METRIC_KEYBOARD;
+        } else if(strcmp(argv[arg], "--damerau") == 0) {
+            distanceMetric = METRIC_DAMERAU;
+        } else if(strcmp(argv[arg], "--workers") == 0 && arg + 1 < argc) {
+            workerCount = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--deletes") == 0 && arg + 1 < argc) {
+            deleteIndexDistance = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--cache") == 0 && arg + 1 < argc) {
+            cacheSize = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--socket") == 0 && arg + 1 < argc) {
+            socketPath = argv[++arg];
+        } else {
+            // The workers already search in parallel, so there is no --parallel.
+            printf("Usage: %s [--linear | --bktree | --symspell | --qgram] [--keyboard | --damerau] [--workers N] [--deletes N]\n"
+                   "       [--cache N] [--socket PATH]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    //      LOADING THE DICTIONARY
+    FILE* fDictHashed = fopen(hashedDictFile, "rb");
+
+    if(fDictHashed == NULL) {
+        printf("ERROR: Could not read file: %s\n", hashedDictFile);
+        return EXIT_FAILURE;
+    }
+
+    HashTable_t* hashedDict = hashTableLoadFromBinary(fDictHashed);
+    fclose(fDictHashed);
+
+    bool outdated = (hashedDict->mapping == NULL);
+
+    if(searchMode == SEARCH_SYMSPELL && hashedDict->deleteIndex == NULL && deleteIndexDistance > 0) {
+        hashedDict->deleteIndex = deleteIndexBuild(hashedDict, deleteIndexDistance);
+        outdated = true;
+    }
+    if(searchMode == SEARCH_QGRAM && hashedDict->qgramIndex == NULL) {
+        hashedDict->qgramIndex = qgramIndexBuild(hashedDict);
+        outdated = true;
+    }
+    if(outdated) {
+        hashTableSaveAsBinary(hashedDict, hashedDictFile);
+    }
+
+    if(cacheSize > 0) {
+        suggestionCache = suggestionCacheCreate(cacheSize);
+    }
+
+    //      SERVING
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = serverStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Blocked until serverRun waits for events, and in the workers, which inherit the mask
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, NULL);
+
+    Server_t* server = serverCreate(hashedDict, socketPath, workerCount > 0 ? workerCount : 1);
+
+    printf("Dictionary has been loaded into the memory.\n");
+    printf("Listening on %s with %d workers.\n", socketPath, server->workerCount);
+    fflush(stdout);
+
+    serverRun(server);
+
+    printf("Served %llu requests on %llu connections.\n", (unsigned long long) atomic_load(&server->requests), server->connections);
+    serverFree(server, socketPath);
+
+    if(suggestionCache != NULL) {
+        printf("Suggestion cache: %llu hits, %llu misses\n", suggestionCache->hits, suggestionCache->misses);
+        suggestionCacheFree(suggestionCache);
+    }
+    hashTableFree(hashedDict);
+    return 0;
+}
+/*
+*   FUNCTION: serverCreate
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 socketPath: Path of the Unix socket
+*   @param3 workerCount: Number of worker threads
+*   @returns a pointer to the created server
+*
+*   INFO: A socket file left behind by a previous server is removed
+*         first. The listening socket and the eventfd of the workers are
+*         registered with epoll, their data is the address of their
+*         descriptor inside the server so the loop can tell them from
+*         the connections.
+*/
+Server_t* serverCreate(HashTable_t* hashTable, const char* socketPath, int workerCount) {
+    Server_t* server = malloc( sizeof(Server_t) );
+
+    if(server == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if(strlen(socketPath) >= sizeof(address.sun_path)) {
+        printf("ERROR: Socket path is too long: %s\n", socketPath);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+
+    server->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if(server->listenFd == -1 || bind(server->listenFd, (struct sockaddr*) &address, sizeof(address)) == -1 ||
+       listen(server->listenFd, SERVER_BACKLOG) == -1) {
+        printf("ERROR: Could not listen on socket: %s\n", socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    server->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    server->doneFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(server->epollFd == -1 || server->doneFd == -1) {
+        printf("ERROR: Could not create the event loop.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &server->listenFd;
+    epoll_ctl(server->epollFd, EPOLL_CTL_ADD, server->listenFd, &event);
+
+    event.events = EPOLLIN;
+    event.data.ptr = &server->doneFd;
+    epoll_ctl(server->epollFd, EPOLL_CTL_ADD, server->doneFd, &event);
+
+    server->hashTable = hashTable;
+    server->queueHead = NULL;
+    server->queueTail = NULL;
+    server->doneHead = NULL;
+    server->quit = false;
+    server->open = NULL;
+    server->closed = NULL;
+    server->connections = 0;
+    atomic_init(&server->requests, 0);
+    pthread_mutex_init(&server->queueLock, NULL);
+    pthread_cond_init(&server->queueReady, NULL);
+    pthread_mutex_init(&server->doneLock, NULL);
+
+    server->workerCount = workerCount;
+    server->threads = malloc( workerCount * sizeof(pthread_t) );
+
+    if(server->threads == NULL) {
+        printf("ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    for(i=0; i<workerCount; i++) {
+        if(pthread_create(&server->threads[i], NULL, serverWorker, server) != 0) {
+            printf("ERROR: Could not create a thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return server;
+}
+/*
+*   FUNCTION: serverRun
+*   @param1 server: Pointer to the server
+*
+*   INFO: Only this thread touches the sockets. Connections are edge
+*         triggered, so every event is followed by connectionProcess,
+*         which reads and writes until the socket would block. Workers
+*         only see a connection between the dispatch of a request and
+*         the moment they put it on the done list. SIGINT and SIGTERM
+*         are blocked everywhere else and only unblocked by epoll_pwait,
+*         so a signal that comes after serverQuit is checked interrupts
+*         the wait instead of being missed until the next event.
+*/
+void serverRun(Server_t* server) {
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    sigset_t waitMask;
+
+    pthread_sigmask(SIG_BLOCK, NULL, &waitMask);
+    sigdelset(&waitMask, SIGINT);
+    sigdelset(&waitMask, SIGTERM);
+
+    while(!serverQuit) {
+        int count = epoll_pwait(server->epollFd, events, SERVER_MAX_EVENTS, -1, &waitMask);
+        int i;
+
+        if(count == -1) {
+            if(errno == EINTR) continue;
+
+            printf("ERROR: Could not wait for events.\n");
+            break;
+        }
+
+        for(i=0; i<count; i++) {
+            if(events[i].data.ptr == &server->listenFd) {
+                serverAccept(server);
+            } else if(events[i].data.ptr == &server->doneFd) {
+                serverCompleteRequests(server);
+            } else {
+                connectionProcess(server, events[i].data.ptr);
+            }
+        }
+
+        // A connection closed above may still have had an event later in the batch.
+        while(server->closed != NULL) {
+            Connection_t* next = server->closed->next;
+            free(server->closed);
+            server->closed = next;
+        }
+    }
+}
+void serverStop(int signum) {
+    (void) signum;
+    serverQuit = 1;
+}
+/*
+*   FUNCTION: serverFree
+*   @param1 server: Pointer to the server
+*   @param2 socketPath: Path of the Unix socket, which is removed
+*
+*   INFO: The workers finish the requests they hold before they stop, so
+*         every connection can be closed once they are joined.
+*/
+void serverFree(Server_t* server, const char* socketPath) {
+    int i;
+
+    pthread_mutex_lock(&server->queueLock);
+    server->quit = true;
+    pthread_cond_broadcast(&server->queueReady);
+    pthread_mutex_unlock(&server->queueLock);
+
+    for(i=0; i<server->workerCount; i++) {
+        pthread_join(server->threads[i], NULL);
+    }
+
+    while(server->open != NULL) {
+        connectionClose(server, server->open);
+    }
+    while(server->closed != NULL) {
+        Connection_t* next = server->closed->next;
+        free(server->closed);
+        server->closed = next;
+    }
+
+    close(server->listenFd);
+    close(server->doneFd);
+    close(server->epollFd);
+    unlink(socketPath);
+
+    pthread_mutex_destroy(&server->queueLock);
+    pthread_cond_destroy(&server->queueReady);
+    pthread_mutex_destroy(&server->doneLock);
+    free(server->threads);
+    free(server);
+}
+void serverAccept(Server_t* server) {
+    while(1) {
+        int fd = accept4(server->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if(fd == -1) {
+            // EAGAIN when there is nobody left, anything else drops a single client
+            if(errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+
+        Connection_t* conn = malloc( sizeof(Connection_t) );
+
+        if(conn == NULL) {
+            printf("ERROR: Could not allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        conn->fd = fd;
+        conn->inLen = 0;
+        conn->outLen = 0;
+        conn->outSent = 0;
+        conn->busy = false;
+        conn->closed = false;
+        conn->next = NULL;
+        conn->prevOpen = NULL;
+        conn->nextOpen = server->open;
+
+        if(server->open != NULL) server->open->prevOpen = conn;
+        server->open = conn;
+        server->connections++;
+
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = conn;
+        epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event);
+
+        // Requests sent right after connecting may already be waiting.
+        connectionProcess(server, conn);
+    }
+}
+void serverCompleteRequests(Server_t* server) {
+    uint64_t value;
+
+    if(read(server->doneFd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+        return;
+    }
+
+    pthread_mutex_lock(&server->doneLock);
+    Connection_t* conn = server->doneHead;
+    server->doneHead = NULL;
+    pthread_mutex_unlock(&server->doneLock);
+
+    while(conn != NULL) {
+        Connection_t* next = conn->next;
+
+        conn->busy = false;
+        connectionProcess(server, conn);
+
+        conn = next;
+    }
+}
+/*
+*   FUNCTION: connectionProcess
+*   @param1 server: Pointer to the server
+*   @param2 conn: Pointer to the connection
+*
+*   INFO: Repeats three steps until the socket would block or a worker
+*         owns the connection: send what is left of the last response,
+*         hand a whole buffered request to the workers, receive more.
+*         Nothing is read while a response is pending, so a client that
+*         does not read its responses only fills its own socket buffer.
+*/
+void connectionProcess(Server_t* server, Connection_t* conn) {
+    while(!conn->busy && !conn->closed) {
+        while(conn->outSent < conn->outLen) {
+            ssize_t sent = send(conn->fd, conn->out + conn->outSent, conn->outLen - conn->outSent, MSG_NOSIGNAL);
+
+            if(sent == -1 && errno == EINTR) continue;
+            if(sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            if(sent <= 0) {
+                connectionClose(server, conn);
+                return;
+            }
+            conn->outSent += sent;
+        }
+
+        if(conn->inLen >= 4) {
+            uint32_t len = ((uint32_t) conn->in[0] << 24) | (conn->in[1] << 16) | (conn->in[2] << 8) | conn->in[3];
+
+            if(len < 2 || len > SERVER_MAX_REQUEST) {
+                connectionClose(server, conn);
+                return;
+            }
+
+            if(conn->inLen >= 4 + (int) len) {
+                memcpy(conn->request, conn->in + 4, len);
+                conn->request[len] = '\0';
+                conn->requestLen = len;
+
+                conn->inLen -= 4 + len;
+                memmove(conn->in, conn->in + 4 + len, conn->inLen);
+
+                conn->busy = true;
+                conn->next = NULL;
+
+                pthread_mutex_lock(&server->queueLock);
+                if(server->queueTail != NULL) {
+                    server->queueTail->next = conn;
+                } else {
+                    server->queueHead = conn;
+                }
+                server->queueTail = conn;
+                pthread_cond_signal(&server->queueReady);
+                pthread_mutex_unlock(&server->queueLock);
+                return;
+            }
+        }
+
+        // The buffer holds one frame at most, so there is always room here.
+        ssize_t received = recv(conn->fd, conn->in + conn->inLen, sizeof(conn->in) - conn->inLen, 0);
+
+        if(received == -1 && errno == EINTR) continue;
+        if(received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if(received <= 0) {
+            connectionClose(server, conn);
+            return;
+        }
+        conn->inLen += received;
+    }
+}
+void connectionClose(Server_t* server, Connection_t* conn) {
+    // Closing the descriptor also removes it from epoll
+    close(conn->fd);
+    conn->closed = true;
+
+    if(conn->prevOpen != NULL) {
+        conn->prevOpen->nextOpen = conn->nextOpen;
+    } else {
+        server->open = conn->nextOpen;
+    }
+    if(conn->nextOpen != NULL) {
+        conn->nextOpen->prevOpen = conn->prevOpen;
+    }
+    conn->next = server->closed;
+    server->closed = conn;
+}
+/*
+*   FUNCTION: serverWorker
+*   @param1 arg: Pointer to the server
+*   @returns NULL
+*
+*   INFO: Takes the oldest request of the work queue, writes its response
+*         into the connection and puts the connection on the done list.
+*         The event loop is woken up only when the done list was empty,
+*         one wake-up takes every connection on it.
+*/
+void* serverWorker(void* arg) {
+    Server_t* server = arg;
+    Suggestion_t suggestions[SERVER_MAX_SUGGESTIONS];
+
+    while(1) {
+        pthread_mutex_lock(&server->queueLock);
+
+        while(!server->quit && server->queueHead == NULL) {
+            pthread_cond_wait(&server->queueReady, &server->queueLock);
+        }
+        if(server->queueHead == NULL) {
+            pthread_mutex_unlock(&server->queueLock);
+            return NULL;
+        }
+
+        Connection_t* conn = server->queueHead;
+        server->queueHead = conn->next;
+        if(server->queueHead == NULL) server->queueTail = NULL;
+
+        pthread_mutex_unlock(&server->queueLock);
+
+        serverHandleRequest(server, conn, suggestions);
+        responseFinish(conn);
+        atomic_fetch_add(&server->requests, 1);
+
+        pthread_mutex_lock(&server->doneLock);
+        bool wake = (server->doneHead == NULL);
+        conn->next = server->doneHead;
+        server->doneHead = conn;
+        pthread_mutex_unlock(&server->doneLock);
+
+        if(wake) {
+            uint64_t one = 1;
+            if(write(server->doneFd, &one, sizeof(one)) == -1) {
+                printf("ERROR: Could not wake up the event loop.\n");
+            }
+        }
+    }
+}
+/*
+*   FUNCTION: serverHandleRequest
+*   @param1 server: Pointer to the server
+*   @param2 conn: Pointer to the connection that holds the request
+*   @param3 suggestions: Buffer of SERVER_MAX_SUGGESTIONS suggestions
+*
+*   INFO: Runs on the worker threads. The dictionary is only read, and
+*         the suggestion cache has its own lock, so requests do not wait
+*         for each other here.
+*/
+void serverHandleRequest(Server_t* server, Connection_t* conn, Suggestion_t* suggestions) {
+    RequestType_t type = conn->request[0];
+    int count = conn->request[1];
+    char* word = (char*) conn->request + 2;
+    int len = conn->requestLen - 2;
+
+    toLower(word, len);
+
+    if(len == 0 || len >= CONSOLE_INPUT_LENGTH || (int) strlen(word) != len || hasInvalidChars(word)) {
+        responseStart(conn, STATUS_ERROR);
+        responseAppend(conn, "Words are 1 to %d letters from a to z", CONSOLE_INPUT_LENGTH - 1);
+        return;
+    }
+
+    bool correct = hashTableFindKey(server->hashTable, word, len) != -1;
+
+    if(type == REQUEST_CHECK) {
+        responseStart(conn, correct ? STATUS_CORRECT : STATUS_INCORRECT);
+
+    } else if(type == REQUEST_CORRECT) {
+        if(correct) {
+            responseStart(conn, STATUS_CORRECT);
+            return;
+        }
+
+        char* mostSimilarWord;
+        char path[EDIT_PATH_LENGTH];
+        short dist = correctWord(server->hashTable, word, &mostSimilarWord, path);
+
+        if(dist <= getDistanceLimit() && mostSimilarWord != NULL) {
+            responseStart(conn, STATUS_INCORRECT);
+            responseAppend(conn, "%s %d %s", mostSimilarWord, dist, path);
+        } else {
+            responseStart(conn, STATUS_UNKNOWN);
+        }
+
+    } else if(type == REQUEST_SUGGEST) {
+        if(count > SERVER_MAX_SUGGESTIONS) count = SERVER_MAX_SUGGESTIONS;
+
+        int found = findMostSimilarWords(server->hashTable, word, count, getDistanceLimit(), suggestions);
+        int i;
+
+        responseStart(conn, correct ? STATUS_CORRECT : (found > 0) ? STATUS_INCORRECT : STATUS_UNKNOWN);
+        for(i=0; i<found; i++) {
+            responseAppend(conn, "%s %d\n", suggestions[i].word, suggestions[i].distance);
+        }
+
+    } else {
+        responseStart(conn, STATUS_ERROR);
+        responseAppend(conn, "Unknown request type");
+    }
+}
+void responseStart(Connection_t* conn, ResponseStatus_t status) {
+    conn->out[4] = status;
+    conn->outLen = 5;
+    conn->outSent = 0;
+}
+void responseAppend(Connection_t* conn, const char* format, ...) {
+    int room = sizeof(conn->out) - conn->outLen;
+    va_list args;
+
+    va_start(args, format);
+    int written = vsnprintf((char*) conn->out + conn->outLen, room, format, args);
+    va_end(args);
+
+    // The terminating zero is not part of the response
+    if(written > 0) conn->outLen += (written < room) ? written : room - 1;
+}
+void responseFinish(Connection_t* conn) {
+    uint32_t len = conn->outLen - 4;
+
+    conn->out[0] = len >> 24;
+    conn->out[1] = len >> 16;
+    conn->out[2] = len >> 8;
+    conn->out[3] = len;
+}
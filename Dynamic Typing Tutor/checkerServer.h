@@ -0,0 +1,104 @@
+#ifndef __CHECKER_SERVER_H
+#define __CHECKER_SERVER_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "checker.h"
+
+#define SERVER_SOCKET_PATH "checker.sock"   // Unix socket the server listens on by default
+#define SERVER_MAX_REQUEST 128      // Largest request payload, a type, a count and a word
+#define SERVER_MAX_RESPONSE 4096    // Largest response payload, longer texts are cut
+#define SERVER_MAX_SUGGESTIONS 32   // Most suggestions a single REQUEST_SUGGEST returns
+#define SERVER_MAX_EVENTS 256       // Events taken from epoll at once
+#define SERVER_BACKLOG 1024         // Connections waiting to be accepted
+
+// Every message is a frame: the length of the payload as a 4 byte big
+// endian number, then the payload. A request payload is a type byte, a
+// count byte (the number of suggestions of REQUEST_SUGGEST, 0 otherwise)
+// and the word. A response payload is a status byte and a text:
+//
+//  REQUEST_CHECK   : no text
+//  REQUEST_CORRECT : "word distance path" if the status is STATUS_INCORRECT
+//  REQUEST_SUGGEST : a "word distance" line for each suggestion, closest first
+//  STATUS_ERROR    : the reason
+//
+// A connection may send several requests without waiting, the responses
+// come back in the same order.
+
+typedef enum {
+
+    REQUEST_CHECK = 'c',    // Is the word in the dictionary
+    REQUEST_CORRECT = 'r',  // The most similar word and the transformation steps
+    REQUEST_SUGGEST = 's'   // The closest words, ranked by distance and frequency
+
+} RequestType_t;
+
+typedef enum {
+
+    STATUS_CORRECT,     // The word is in the dictionary
+    STATUS_INCORRECT,   // The word is not in the dictionary, the text holds the corrections
+    STATUS_UNKNOWN,     // The word is not in the dictionary and no word is within the limit
+    STATUS_ERROR        // The request could not be understood
+
+} ResponseStatus_t;
+
+typedef struct Connection {
+
+    int fd;
+    unsigned char in[4 + SERVER_MAX_REQUEST];   // Bytes received and not yet handled, at most one whole frame
+    int inLen;
+    unsigned char request[SERVER_MAX_REQUEST + 1];  // Payload handed to a worker, followed by a terminating zero
+    int requestLen;
+    unsigned char out[4 + SERVER_MAX_RESPONSE]; // Frame of the last response
+    int outLen;
+    int outSent;
+    bool busy;                  // A worker owns the request and the response
+    bool closed;                // Closed during the current batch of events, deallocated after it
+    struct Connection* next;    // Next connection in the work queue or the done list
+    struct Connection* prevOpen;    // Neighbours in the list of open connections
+    struct Connection* nextOpen;
+
+} Connection_t;
+
+typedef struct {
+
+    HashTable_t* hashTable;
+    int listenFd;
+    int epollFd;
+    int doneFd;                 // eventfd that wakes up the event loop when a worker finishes a request
+
+    pthread_t* threads;
+    int workerCount;
+
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueReady;  // Signalled when a connection is added to the work queue
+    Connection_t* queueHead;    // Connections whose request waits for a worker, oldest first
+    Connection_t* queueTail;
+
+    pthread_mutex_t doneLock;
+    Connection_t* doneHead;     // Connections whose response waits to be sent
+    bool quit;
+
+    Connection_t* open;         // Every open connection, so they can be closed on exit
+    Connection_t* closed;       // Connections closed during the current batch of events
+    unsigned long long connections;
+    atomic_ullong requests;
+
+} Server_t;
+
+Server_t* serverCreate(HashTable_t* hashTable, const char* socketPath, int workerCount);  // Listens on a Unix socket and starts the workers
+void serverRun(Server_t* server);                                       // Runs the event loop until serverStop is called
+void serverStop(int signum);                                            // Signal handler that ends serverRun
+void serverFree(Server_t* server, const char* socketPath);              // Stops the workers, closes every connection and removes the socket
+void serverAccept(Server_t* server);                                    // Accepts every pending connection
+void serverCompleteRequests(Server_t* server);                          // Takes back the connections of the done list and sends their responses
+void connectionProcess(Server_t* server, Connection_t* conn);           // Sends, receives and dispatches until the connection would block
+void connectionClose(Server_t* server, Connection_t* conn);             // Closes a connection that no worker owns, it is deallocated after the batch of events
+void* serverWorker(void* arg);                                          // Thread function of the workers: answers the requests of the work queue
+void serverHandleRequest(Server_t* server, Connection_t* conn, Suggestion_t* suggestions);   // Writes the response of a request into the connection
+void responseStart(Connection_t* conn, ResponseStatus_t status);        // Starts a response frame with the given status
+void responseAppend(Connection_t* conn, const char* format, ...);       // Appends formatted text to the response, cut at SERVER_MAX_RESPONSE
+void responseFinish(Connection_t* conn);                                // Writes the length of the response into its frame
+
+#endif
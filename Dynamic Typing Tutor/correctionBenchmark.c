@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "checker.h"
+
+#define CORPUS_SAMPLES 1000     // Default number of misspellings generated for each distance
+#define CORPUS_ATTEMPTS 100     // Tries to misspell a word before another word is picked
+
+typedef struct {
+
+    char misspelling[CONSOLE_INPUT_LENGTH];
+    char* original;         // Word of the dictionary the misspelling was made from
+    short injected;         // Number of random edits applied to the original
+    short distance;         // Actual distance between the misspelling and the original
+
+} CorpusEntry_t;
+
+typedef struct {
+
+    double* samples;        // Latencies in seconds
+    int count;
+
+} Latencies_t;
+
+unsigned long long nextRandom(unsigned long long* state);          // Returns the next number of a xorshift64* generator
+char* pickWord(HashTable_t* hashTable, unsigned long long* state);  // Returns a random word of the dictionary
+int misspellWord(char* word, int edits, char* out, unsigned long long* state);   // Applies random edits to a word and returns the length of the result
+CorpusEntry_t* generateCorpus(HashTable_t* hashTable, int distance, int count, unsigned long long* state, int* realWords);   // Generates misspellings at the given number of edits
+bool isPathValid(EditScratch_t* scratch, char* from, char* to); // Checks that the operations of getEditOps turn one string into the other
+int compareDoubles(const void* a, const void* b);               // qsort comparator for doubles in ascending order
+double getPercentile(Latencies_t* latencies, double percentile);   // Returns a percentile of the latencies, which are sorted first
+double getTime(void);                                           // Returns a monotonic time in seconds
+
+int main(int argc, char** argv) {
+
+    //      PARSING COMMAND LINE OPTIONS
+    const char* path = hashedDictFile;
+    char* corpusFile = NULL;
+    unsigned long long seed = 1;
+    int samples = CORPUS_SAMPLES;
+    int threadCount = 1;
+    int arg;
+    for(arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "--linear") == 0) {
+            searchMode = SEARCH_LINEAR;
+        } else if(strcmp(argv[arg], "--bktree") == 0) {
+            searchMode = SEARCH_BKTREE;
+        } else if(strcmp(argv[arg], "--symspell") == 0) {
+            searchMode = SEARCH_SYMSPELL;
+        } else if(strcmp(argv[arg], "--qgram") == 0) {
+            searchMode = SEARCH_QGRAM;
+        } else if(strcmp(argv[arg], "--parallel") == 0) {
+            searchMode = SEARCH_PARALLEL;
+        } else if(strcmp(argv[arg], "--keyboard") == 0) {
+            distanceMetric = METRIC_KEYBOARD;
+        } else if(strcmp(argv[arg], "--damerau") == 0) {
+            distanceMetric = METRIC_DAMERAU;
+        } else if(strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc) {
+            threadCount = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--seed") == 0 && arg + 1 < argc) {
+            seed = strtoull(argv[++arg], NULL, 10);
+        } else if(strcmp(argv[arg], "--samples") == 0 && arg + 1 < argc) {
+            samples = atoi(argv[++arg]);
+        } else if(strcmp(argv[arg], "--corpus") == 0 && arg + 1 < argc) {
+            corpusFile = argv[++arg];
+        } else if(argv[arg][0] != '-') {
+            path = argv[arg];
+        } else {
+            fprintf(stderr, "Usage: %s [--linear | --bktree | --symspell | --parallel | --qgram] [--keyboard | --damerau] [--threads N]\n"
+                            "       [--seed N] [--samples N] [--corpus FILE] [DICTIONARY.bin]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE* fp = fopen(path, "rb");
+
+    if(fp == NULL) {
+        fprintf(stderr, "ERROR: Could not read file: %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    HashTable_t* hashTable = hashTableLoadFromBinary(fp);
+    fclose(fp);
+
+    if(searchMode == SEARCH_SYMSPELL && hashTable->deleteIndex == NULL && deleteIndexDistance > 0) {
+        hashTable->deleteIndex = deleteIndexBuild(hashTable, deleteIndexDistance);
+    }
+    if(searchMode == SEARCH_QGRAM && hashTable->qgramIndex == NULL) {
+        hashTable->qgramIndex = qgramIndexBuild(hashTable);
+    }
+    if(searchMode == SEARCH_PARALLEL) {
+        searchPool = searchPoolCreate(threadCount > 0 ? threadCount : 1);
+    }
+
+    if(samples < 1) samples = 1;
+
+    //      GENERATING THE CORPUS
+    // Every distance gets its own stream of the generator, so changing
+    // the number of distances does not change the misspellings of the others.
+    CorpusEntry_t* corpus[MAX_DIST_ALLOWED + 1];
+    int realWords[MAX_DIST_ALLOWED + 1];
+    int d, i;
+
+    for(d=1; d<=MAX_DIST_ALLOWED; d++) {
+        unsigned long long state = seed * 0x9E3779B97F4A7C15ULL + d;
+        corpus[d] = generateCorpus(hashTable, d, samples, &state, &realWords[d]);
+    }
+
+    if(corpusFile != NULL) {
+        FILE* fCorpus = fopen(corpusFile, "w");
+
+        if(fCorpus == NULL) {
+            fprintf(stderr, "ERROR: Could not write file: %s\n", corpusFile);
+            return EXIT_FAILURE;
+        }
+        for(d=1; d<=MAX_DIST_ALLOWED; d++) {
+            for(i=0; i<samples; i++) {
+                fprintf(fCorpus, "%s\t%s\t%d\n", corpus[d][i].misspelling, corpus[d][i].original, corpus[d][i].injected);
+            }
+        }
+        fclose(fCorpus);
+    }
+
+    //      MEASURING THE LOOKUPS
+    // The originals should all be found and the misspellings should all be missing.
+    long long found = 0, missing = 0, lookups = 0;
+
+    double start = getTime();
+    for(d=1; d<=MAX_DIST_ALLOWED; d++) {
+        for(i=0; i<samples; i++) {
+            CorpusEntry_t* entry = &corpus[d][i];
+
+            found += hashTableFindKey(hashTable, entry->original, strlen(entry->original)) != -1;
+            missing += hashTableFindKey(hashTable, entry->misspelling, strlen(entry->misspelling)) == -1;
+            lookups += 2;
+        }
+    }
+    double lookupTime = getTime() - start;
+
+    const char* modeNames[5] = {"linear", "bktree", "symspell", "parallel", "qgram"};
+    const char* metricNames[3] = {"unit", "keyboard", "damerau"};
+
+    printf("{\"dictionary\":\"%s\",\"words\":%d,\"seed\":%llu,\"samples\":%d,\"searchMode\":\"%s\",\"metric\":\"%s\",\n",
+           path, hashTable->wordCount, seed, samples, modeNames[searchMode], metricNames[distanceMetric]);
+    printf(" \"lookup\":{\"lookups\":%lld,\"perSecond\":%.0f,\"originalsFound\":%.4f,\"misspellingsMissing\":%.4f},\n",
+           lookups, lookups / lookupTime, (double) found * 2 / lookups, (double) missing * 2 / lookups);
+    printf(" \"distances\":[");
+
+    //      MEASURING THE CORRECTIONS AND THE PATHS
+    Latencies_t correction = {malloc(samples * sizeof(double)), 0};
+    Latencies_t pathing = {malloc(samples * sizeof(double)), 0};
+    EditScratch_t scratch;
+
+    if(correction.samples == NULL || pathing.samples == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(&scratch, 0, sizeof(scratch));
+
+    for(d=1; d<=MAX_DIST_ALLOWED; d++) {
+        int correct = 0, optimal = 0, corrected = 0, validPaths = 0;
+        long long distanceSum = 0;
+
+        correction.count = 0;
+        pathing.count = 0;
+
+        for(i=0; i<samples; i++) {
+            CorpusEntry_t* entry = &corpus[d][i];
+            char* wordFound;
+
+            start = getTime();
+            short dist = findMostSimilarWord(hashTable, entry->misspelling, &wordFound);
+            correction.samples[correction.count++] = getTime() - start;
+
+            distanceSum += entry->distance;
+
+            // Nothing farther than the original may be returned, and nothing at all
+            // only if the original is beyond the limit of the metric.
+            if((wordFound != NULL) ? dist <= entry->distance : entry->distance > getDistanceLimit()) optimal++;
+            if(wordFound == NULL || dist > getDistanceLimit()) continue;
+
+            corrected++;
+            if(strcmp(wordFound, entry->original) == 0) correct++;
+
+            start = getTime();
+            getEditPath(wordFound, entry->misspelling);
+            pathing.samples[pathing.count++] = getTime() - start;
+
+            // The keyboard metric weighs the operations, so only the others have to add up to its distance.
+            short pathDist = getEditOps(&scratch, wordFound, entry->misspelling);
+            if(isPathValid(&scratch, entry->misspelling, wordFound) && (distanceMetric == METRIC_KEYBOARD || pathDist == dist)) validPaths++;
+        }
+
+        double correctionTotal = 0;
+        for(i=0; i<correction.count; i++) correctionTotal += correction.samples[i];
+
+        printf("%s\n  {\"injected\":%d,\"meanDistance\":%.3f,\"realWordsSkipped\":%d,\n", (d > 1) ? "," : "",
+               d, (double) distanceSum / samples, realWords[d]);
+        printf("   \"correction\":{\"accuracy\":%.4f,\"corrected\":%.4f,\"optimal\":%.4f,\"perSecond\":%.1f,\"p50Us\":%.3f,\"p99Us\":%.3f},\n",
+               (double) correct / samples, (double) corrected / samples, (double) optimal / samples,
+               correction.count / correctionTotal, getPercentile(&correction, 0.50) * 1e6, getPercentile(&correction, 0.99) * 1e6);
+        printf("   \"path\":{\"valid\":%.4f,\"p50Us\":%.3f,\"p99Us\":%.3f}}",
+               (pathing.count > 0) ? (double) validPaths / pathing.count : 0.0,
+               getPercentile(&pathing, 0.50) * 1e6, getPercentile(&pathing, 0.99) * 1e6);
+    }
+    printf("\n ]}\n");
+
+    for(d=1; d<=MAX_DIST_ALLOWED; d++) {
+        free(corpus[d]);
+    }
+    free(correction.samples);
+    free(pathing.samples);
+    editScratchRelease(&scratch);
+
+    if(searchPool != NULL) {
+        searchPoolFree(searchPool);
+    }
+    hashTableFree(hashTable);
+    return 0;
+}
+unsigned long long nextRandom(unsigned long long* state) {
+    // xorshift64*, the same sequence on every platform unlike rand()
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+char* pickWord(HashTable_t* hashTable, unsigned long long* state) {
+    char* word;
+
+    do {
+        word = hashTableGetWord(hashTable, nextRandom(state) % hashTable->size);
+    } while(word == NULL);
+
+    return word;
+}
+/*
+*   FUNCTION: misspellWord
+*   @param1 word: The word to misspell
+*   @param2 edits: Number of edits to apply
+*   @param3(return parameter) out: Buffer of CONSOLE_INPUT_LENGTH bytes
+*                                  the misspelling is written into
+*   @param4 state: State of the random number generator
+*   @returns the length of the misspelling
+*
+*   INFO: Each edit is an insertion, a deletion, a substitution or a
+*         transposition of two adjacent letters, at a random position.
+*         Edits may undo each other, so the result may be closer to the
+*         word than the number of edits.
+*/
+int misspellWord(char* word, int edits, char* out, unsigned long long* state) {
+    int len = strlen(word);
+    int e;
+
+    memcpy(out, word, len + 1);
+
+    for(e=0; e<edits; e++) {
+        int type = nextRandom(state) % 4;
+        char letter = 'a' + nextRandom(state) % 26;
+
+        if(type == 0 && len + 1 < CONSOLE_INPUT_LENGTH) {
+            int pos = nextRandom(state) % (len + 1);
+            memmove(out + pos + 1, out + pos, len - pos + 1);
+            out[pos] = letter;
+            len++;
+        } else if(type == 1 && len > 1) {
+            int pos = nextRandom(state) % len;
+            memmove(out + pos, out + pos + 1, len - pos);
+            len--;
+        } else if(type == 3 && len > 1) {
+            int pos = nextRandom(state) % (len - 1);
+            char tmp = out[pos];
+            out[pos] = out[pos + 1];
+            out[pos + 1] = tmp;
+        } else {
+            int pos = nextRandom(state) % len;
+            out[pos] = (out[pos] == letter) ? 'a' + (letter - 'a' + 1) % 26 : letter;
+        }
+    }
+    return len;
+}
+/*
+*   FUNCTION: generateCorpus
+*   @param1 hashTable: Pointer to the dictionary HashTable
+*   @param2 distance: Number of edits applied to each word
+*   @param3 count: Number of misspellings
+*   @param4 state: State of the random number generator
+*   @param5(return parameter) realWords: Number of misspellings that
+*                                       were skipped because they are
+*                                       words of the dictionary
+*   @returns the misspellings, with the words they were made from
+*
+*   INFO: A misspelling that is itself a word can not be detected, so
+*         such results are drawn again. The actual distance is stored
+*         next to the number of edits.
+*/
+CorpusEntry_t* generateCorpus(HashTable_t* hashTable, int distance, int count, unsigned long long* state, int* realWords) {
+    CorpusEntry_t* corpus = malloc( count * sizeof(CorpusEntry_t) );
+
+    if(corpus == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    *realWords = 0;
+    int i = 0;
+
+    while(i < count) {
+        CorpusEntry_t* entry = &corpus[i];
+        int attempt;
+
+        entry->original = pickWord(hashTable, state);
+
+        for(attempt=0; attempt<CORPUS_ATTEMPTS; attempt++) {
+            int len = misspellWord(entry->original, distance, entry->misspelling, state);
+
+            if(hashTableFindKey(hashTable, entry->misspelling, len) == -1) break;
+            (*realWords)++;
+        }
+        if(attempt == CORPUS_ATTEMPTS) continue;
+
+        entry->injected = distance;
+        entry->distance = getEditDistanceMetric(entry->original, entry->misspelling, 2 * CONSOLE_INPUT_LENGTH * KEY_COST_UNIT);
+        i++;
+    }
+    return corpus;
+}
+/*
+*   FUNCTION: isPathValid
+*   @param1 scratch: Arena that holds the operations of getEditOps
+*   @param2 from: The second string given to getEditOps
+*   @param3 to: The first string given to getEditOps
+*   @returns true if the operations turn from into to, false otherwise
+*
+*   INFO: Replays the operations in order, checking that their positions
+*         follow each other and that copied, deleted and swapped
+*         characters are really there.
+*/
+bool isPathValid(EditScratch_t* scratch, char* from, char* to) {
+    int pos1 = 0, pos2 = 0;
+    int i;
+
+    for(i=0; i<scratch->opCount; i++) {
+        EditOp_t* op = &scratch->ops[i];
+
+        if(op->pos1 != pos1 || op->pos2 != pos2) return false;
+
+        switch(op->type) {
+            case EDIT_COPY:
+                if(from[pos2] != op->c || to[pos1] != op->c) return false;
+                pos1++;
+                pos2++;
+                break;
+            case EDIT_DELETE:
+                if(from[pos2] != op->c) return false;
+                pos2++;
+                break;
+            case EDIT_INSERT:
+                if(to[pos1] != op->c) return false;
+                pos1++;
+                break;
+            case EDIT_SUBSTITUTE:
+                if(from[pos2] == '\0' || to[pos1] != op->c) return false;
+                pos1++;
+                pos2++;
+                break;
+            case EDIT_TRANSPOSE:
+                if(from[pos2] != op->c2 || from[pos2 + 1] != op->c || to[pos1] != op->c || to[pos1 + 1] != op->c2) return false;
+                pos1 += 2;
+                pos2 += 2;
+                break;
+        }
+    }
+    return to[pos1] == '\0' && from[pos2] == '\0';
+}
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+double getPercentile(Latencies_t* latencies, double percentile) {
+    if(latencies->count == 0) {
+        return 0;
+    }
+    qsort(latencies->samples, latencies->count, sizeof(double), compareDoubles);
+
+    int index = (int) (percentile * (latencies->count - 1) + 0.5);
+    return latencies->samples[index];
+}
+double getTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
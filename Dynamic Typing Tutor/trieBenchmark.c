@@ -0,0 +1,532 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "TriePrediction.h"
+
+// Compares the memory and the lookup latency of the trie built by
+// buildTrie() with its compact form made by freezeTrie(), and the speed of
+// buildTrie() with the fscanf() loop it replaced.
+//
+//  gcc -O2 -pthread -Dmain=__hidden_main__ -c TriePrediction.c
+//  gcc -O2 -pthread -o trieBenchmark trieBenchmark.c TriePrediction.o
+//  ./trieBenchmark corpus.txt [threads]
+
+#define BENCHMARK_ROUNDS 20
+#define MAX_KEYS 100000
+#define LEGACY_QUERIES 2000
+#define COMPLETIONS 10
+
+typedef struct KeySet
+{
+	char **keys;
+	int count;
+	int capacity;
+} KeySet;
+
+// Returns a monotonic time in seconds.
+double getTime(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Appends a copy of str to the set.
+void addKey(KeySet *set, char *str)
+{
+	if (set->count == set->capacity)
+	{
+		set->capacity = (set->capacity == 0) ? 1024 : set->capacity * 2;
+		set->keys = realloc(set->keys, sizeof(char *) * set->capacity);
+		if (set->keys == NULL)
+		{
+			printf("ERROR: Could not allocate memory.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	set->keys[set->count++] = strdup(str);
+}
+
+// Puts the keys of the set into a random order.
+void shuffleKeys(KeySet *set)
+{
+	int i, j;
+	char *temp;
+
+	for (i = set->count - 1; i > 0; i--)
+	{
+		j = rand() % (i + 1);
+		temp = set->keys[i];
+		set->keys[i] = set->keys[j];
+		set->keys[j] = temp;
+	}
+}
+
+void freeKeys(KeySet *set)
+{
+	int i;
+
+	for (i = 0; i < set->count; i++)
+		free(set->keys[i]);
+
+	free(set->keys);
+}
+
+// Adds every word of the main trie (not of the subtries) to the set.
+void collectWords(Trie *trie, unsigned int root, char *buffer, int k, KeySet *set)
+{
+	int i;
+
+	if (root == 0 || set->count >= MAX_KEYS)
+		return;
+
+	if (trieNode(trie, root)->count > 0)
+		addKey(set, buffer);
+
+	for (i = 0; i < 26; i++)
+	{
+		buffer[k] = 'a' + i;
+		buffer[k + 1] = '\0';
+		collectWords(trie, trieNode(trie, root)->children[i], buffer, k + 1, set);
+	}
+
+	buffer[k] = '\0';
+}
+
+// Average time of a getNode() call over the keys, in nanoseconds.
+double timeMutable(Trie *trie, KeySet *set, int *found)
+{
+	int i, r;
+	double start = getTime();
+
+	*found = 0;
+	for (r = 0; r < BENCHMARK_ROUNDS; r++)
+		for (i = 0; i < set->count; i++)
+			*found += (getNode(trie, trie->root, set->keys[i]) != 0);
+
+	return (getTime() - start) * 1e9 / ((double)BENCHMARK_ROUNDS * set->count);
+}
+
+// Average time of a getCompactNode() call over the keys, in nanoseconds.
+double timeCompact(CompactTrie *trie, KeySet *set, int *found)
+{
+	int i, r;
+	double start = getTime();
+
+	*found = 0;
+	for (r = 0; r < BENCHMARK_ROUNDS; r++)
+		for (i = 0; i < set->count; i++)
+			*found += (getCompactNode(trie, 1, set->keys[i]) != 0);
+
+	return (getTime() - start) * 1e9 / ((double)BENCHMARK_ROUNDS * set->count);
+}
+
+// The search getMostFrequentWord() did before the best words were kept in
+// the nodes: a walk of the whole (sub)trie, in alphabetical order.
+void legacyMostFrequent(Trie *trie, unsigned int root, char *buffer, int k, char *best, int *best_count)
+{
+	int i;
+
+	if (root == 0)
+		return;
+
+	if (trieNode(trie, root)->count > *best_count)
+	{
+		*best_count = trieNode(trie, root)->count;
+		strcpy(best, buffer);
+	}
+
+	for (i = 0; i < 26; i++)
+	{
+		buffer[k] = 'a' + i;
+		buffer[k + 1] = '\0';
+		legacyMostFrequent(trie, trieNode(trie, root)->children[i], buffer, k + 1, best, best_count);
+	}
+
+	buffer[k] = '\0';
+}
+
+// Times the most frequent word of the given (sub)tries with the walk, the
+// cached best words of the mutable trie and those of the compact trie.
+// mutable_roots[i] and compact_roots[i] are the same node in both tries.
+void timePredictions(char *label, Trie *root, CompactTrie *trie, unsigned int *mutable_roots, unsigned int *compact_roots, int count)
+{
+	int i, r, best_count, legacy_count = (count < LEGACY_QUERIES)? count:LEGACY_QUERIES;
+	int mismatches = 0;
+	char buffer[MAX_CHARACTERS_PER_WORD + 2], best[MAX_CHARACTERS_PER_WORD + 2], word[MAX_CHARACTERS_PER_WORD + 2];
+	double start, legacy_ns, mutable_ns, compact_ns;
+
+	if (count == 0)
+		return;
+
+	start = getTime();
+	for (i = 0; i < legacy_count; i++)
+	{
+		buffer[0] = best[0] = '\0';
+		best_count = 0;
+		legacyMostFrequent(root, mutable_roots[i], buffer, 0, best, &best_count);
+
+		// The walk only gives the part of the word below the root
+		getMostFrequentWord(root, mutable_roots[i], word);
+		mismatches += (strcmp(word + strlen(word) - strlen(best), best) != 0);
+	}
+	legacy_ns = (getTime() - start) * 1e9 / legacy_count;
+
+	start = getTime();
+	for (r = 0; r < BENCHMARK_ROUNDS; r++)
+		for (i = 0; i < count; i++)
+			getMostFrequentWord(root, mutable_roots[i], word);
+	mutable_ns = (getTime() - start) * 1e9 / ((double)BENCHMARK_ROUNDS * count);
+
+	start = getTime();
+	for (r = 0; r < BENCHMARK_ROUNDS; r++)
+		for (i = 0; i < count; i++)
+			getMostFrequentCompactWord(trie, compact_roots[i], word);
+	compact_ns = (getTime() - start) * 1e9 / ((double)BENCHMARK_ROUNDS * count);
+
+	for (i = 0; i < count; i++)
+	{
+		getMostFrequentWord(root, mutable_roots[i], buffer);
+		getMostFrequentCompactWord(trie, compact_roots[i], word);
+		mismatches += (strcmp(buffer, word) != 0);
+	}
+
+	printf("%-10s %12.1f %12.1f %12.1f\n", label, legacy_ns, mutable_ns, compact_ns);
+	if (mismatches != 0)
+		printf("MISMATCH: %d most frequent words differ\n", mismatches);
+}
+
+// Brute force version of getMostFrequentWords(): every word of the
+// (sub)trie is visited in alphabetical order and goes after the words of
+// the list with the same count.
+void bruteForceMostFrequent(Trie *trie, unsigned int root, int k, unsigned int *words, int *size)
+{
+	int i, j, count;
+
+	if (root == 0)
+		return;
+
+	count = trieNode(trie, root)->count;
+	if (count > 0 && (*size < k || trieNode(trie, words[*size - 1])->count < count))
+	{
+		i = (*size < k)? (*size)++ : *size - 1;
+		for (j = i; j > 0 && trieNode(trie, words[j - 1])->count < count; j--)
+			words[j] = words[j - 1];
+		words[j] = root;
+	}
+
+	for (i = 0; i < 26; i++)
+		bruteForceMostFrequent(trie, trieNode(trie, root)->children[i], k, words, size);
+}
+
+// Times the COMPLETIONS most frequent words of the given (sub)tries with
+// the brute force search and with the best-first searches of both tries,
+// and checks that all of them find the same words.
+void timeCompletions(char *label, Trie *root, CompactTrie *trie, unsigned int *mutable_roots, unsigned int *compact_roots, int count)
+{
+	int i, j, r, found, expected, legacy_count = (count < LEGACY_QUERIES)? count:LEGACY_QUERIES;
+	int mismatches = 0;
+	unsigned int words[COMPLETIONS], compact_words[COMPLETIONS];
+	char word[MAX_CHARACTERS_PER_WORD + 2], compact_word[MAX_CHARACTERS_PER_WORD + 2];
+	double start, brute_ns, mutable_ns, compact_ns;
+
+	if (count == 0)
+		return;
+
+	start = getTime();
+	for (i = 0; i < legacy_count; i++)
+	{
+		expected = 0;
+		bruteForceMostFrequent(root, mutable_roots[i], COMPLETIONS, words, &expected);
+	}
+	brute_ns = (getTime() - start) * 1e9 / legacy_count;
+
+	start = getTime();
+	for (r = 0; r < BENCHMARK_ROUNDS; r++)
+		for (i = 0; i < count; i++)
+			getMostFrequentWords(root, mutable_roots[i], COMPLETIONS, words);
+	mutable_ns = (getTime() - start) * 1e9 / ((double)BENCHMARK_ROUNDS * count);
+
+	start = getTime();
+	for (r = 0; r < BENCHMARK_ROUNDS; r++)
+		for (i = 0; i < count; i++)
+			getMostFrequentCompactWords(trie, compact_roots[i], COMPLETIONS, compact_words);
+	compact_ns = (getTime() - start) * 1e9 / ((double)BENCHMARK_ROUNDS * count);
+
+	for (i = 0; i < count; i++)
+	{
+		expected = 0;
+		bruteForceMostFrequent(root, mutable_roots[i], COMPLETIONS, compact_words, &expected);
+		found = getMostFrequentWords(root, mutable_roots[i], COMPLETIONS, words);
+		mismatches += (found != expected || memcmp(words, compact_words, sizeof(unsigned int) * found) != 0);
+
+		found = getMostFrequentCompactWords(trie, compact_roots[i], COMPLETIONS, compact_words);
+		mismatches += (found != expected);
+		for (j = 0; j < found && j < expected; j++)
+		{
+			getWord(root, words[j], word);
+			getCompactWord(trie, compact_words[j], compact_word);
+			mismatches += (strcmp(word, compact_word) != 0);
+		}
+	}
+
+	printf("%-10s %12.1f %12.1f %12.1f\n", label, brute_ns, mutable_ns, compact_ns);
+	if (mismatches != 0)
+		printf("MISMATCH: %d lists of completions differ\n", mismatches);
+}
+
+// Returns 1 if two (sub)tries hold the same words with the same counts,
+// subtries and most frequent words.
+int sameTrie(Trie *a, unsigned int root_a, Trie *b, unsigned int root_b)
+{
+	int i;
+	TrieNode *node_a, *node_b;
+
+	if (root_a == 0 || root_b == 0)
+		return root_a == root_b;
+
+	node_a = trieNode(a, root_a);
+	node_b = trieNode(b, root_b);
+
+	if (node_a->count != node_b->count || node_a->bestCount != node_b->bestCount ||
+	    (node_a->best == root_a) != (node_b->best == root_b))
+		return 0;
+
+	for (i = 0; i < 26; i++)
+		if (!sameTrie(a, node_a->children[i], b, node_b->children[i]))
+			return 0;
+
+	return sameTrie(a, node_a->subtrie, b, node_b->subtrie);
+}
+
+// The loop buildTrie() ran before the corpus was mapped: every word was
+// copied by fscanf() and stripped of its punctuators, and the node of the
+// previous word was looked up again to insert the word in its subtrie.
+Trie *legacyBuildTrie(char *filename)
+{
+	int i, j, word_count = 0, sentenceEnded;
+	unsigned int last_node;
+	char buffer[MAX_CHARACTERS_PER_WORD + 1], prev[MAX_CHARACTERS_PER_WORD + 1];
+	FILE *ifp;
+	Trie *trie;
+
+	if ((ifp = fopen(filename, "r")) == NULL)
+		return NULL;
+
+	trie = createTrie();
+
+	while (fscanf(ifp, "%1023s", buffer) != EOF)
+	{
+		word_count++;
+		sentenceEnded = (strpbrk(buffer, ".?!") != NULL);
+
+		for (i = j = 0; buffer[i] != '\0'; i++)
+			if (isalpha((unsigned char)buffer[i]))
+				buffer[j++] = buffer[i];
+		buffer[j] = '\0';
+
+		trie->root = insertString(trie, trie->root, buffer);
+
+		if (word_count > 1)
+		{
+			last_node = getNode(trie, trie->root, buffer);
+
+			if (sentenceEnded)
+			{
+				trieNode(trie, last_node)->subtrie = 0;
+				word_count = 0;
+			}
+			else
+			{
+				last_node = getNode(trie, trie->root, prev);
+				trieNode(trie, last_node)->subtrie = insertString(trie, trieNode(trie, last_node)->subtrie, buffer);
+			}
+		}
+
+		strcpy(prev, buffer);
+	}
+
+	fclose(ifp);
+	return trie;
+}
+
+// Returns the size of a file in megabytes.
+double fileMegabytes(char *filename)
+{
+	long size;
+	FILE *ifp;
+
+	if ((ifp = fopen(filename, "r")) == NULL)
+		return 0;
+
+	fseek(ifp, 0, SEEK_END);
+	size = ftell(ifp);
+	fclose(ifp);
+
+	return size / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	int i, j, len, words, nodes, threads, found_mutable, found_compact, prefix_count, subtrie_count;
+	unsigned int node, *mutable_prefixes, *compact_prefixes, *mutable_subtries, *compact_subtries;
+	char buffer[MAX_CHARACTERS_PER_WORD + 2];
+	double start, build_time, legacy_time, freeze_time, destroy_time, mutable_ns, compact_ns, megabytes;
+	size_t mutable_bytes, compact_bytes;
+	KeySet hits = {NULL, 0, 0}, misses = {NULL, 0, 0};
+	Trie *root, *parallel, *legacy;
+	CompactTrie *trie;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "Proper syntax: %s <corpus text file> [threads]\n", argv[0]);
+		return 1;
+	}
+
+	threads = (argc > 2)? atoi(argv[2]):4;
+
+	start = getTime();
+	root = buildTrie(argv[1]);
+	build_time = getTime() - start;
+
+	if (root == NULL)
+	{
+		fprintf(stderr, "Could not read %s\n", argv[1]);
+		return 1;
+	}
+
+	megabytes = fileMegabytes(argv[1]);
+
+	start = getTime();
+	legacy = legacyBuildTrie(argv[1]);
+	legacy_time = getTime() - start;
+
+	start = getTime();
+	trie = freezeTrie(root);
+	freeze_time = getTime() - start;
+
+	if (trie == NULL)
+	{
+		printf("ERROR: Could not allocate memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// The subtries repeat words of the main trie, so the bytes are divided
+	// by the distinct words of the main trie only. The mutable trie also
+	// keeps the subtries that buildTrie() detaches at the end of sentences.
+	words = countStrings(root, root->root);
+	nodes = root->nodeCount - 1;
+	mutable_bytes = (size_t)root->chunkCount * TRIE_CHUNK_NODES * sizeof(TrieNode);
+	compact_bytes = (size_t)trie->nodeCount * sizeof(CompactTrieNode);
+
+	printf("Corpus: %s\n", argv[1]);
+	printf("Distinct words: %d, nodes allocated: %d\n", words, nodes);
+	printf("Build: %.3f s (%.1f MB/s, %.1f MB/s with fscanf), freeze: %.3f s\n",
+	       build_time, megabytes / build_time, megabytes / legacy_time, freeze_time);
+	if (legacy == NULL || !sameTrie(root, root->root, legacy, legacy->root))
+		printf("MISMATCH: the trie built with fscanf differs\n");
+	legacy = destroyTrie(legacy);
+
+	start = getTime();
+	parallel = buildTrieParallel(argv[1], threads);
+	printf("Build with %d threads: %.3f s\n\n", threads, getTime() - start);
+	if (parallel == NULL || !sameTrie(root, root->root, parallel, parallel->root))
+		printf("MISMATCH: the trie built with %d threads differs\n\n", threads);
+	parallel = destroyTrie(parallel);
+
+	printf("%-10s %14s %12s\n", "", "bytes", "bytes/word");
+	printf("%-10s %14zu %12.1f\n", "Mutable", mutable_bytes, (double)mutable_bytes / words);
+	printf("%-10s %14zu %12.1f\n\n", "Compact", compact_bytes, (double)compact_bytes / words);
+
+	// Hits are the words of the trie, misses the same words reversed with a
+	// letter added, keeping those that are not words.
+	buffer[0] = '\0';
+	collectWords(root, root->root, buffer, 0, &hits);
+
+	for (i = 0; i < hits.count; i++)
+	{
+		len = strlen(hits.keys[i]);
+		buffer[0] = 'q';
+		for (j = 0; j < len; j++)
+			buffer[j + 1] = hits.keys[i][len - 1 - j];
+		buffer[len + 1] = '\0';
+
+		if (getNode(root, root->root, buffer) == 0)
+			addKey(&misses, buffer);
+	}
+
+	srand(1);
+	shuffleKeys(&hits);
+	shuffleKeys(&misses);
+
+	printf("%-10s %12s %12s\n", "ns/lookup", "hits", "misses");
+
+	mutable_ns = timeMutable(root, &hits, &found_mutable);
+	printf("%-10s %12.1f", "Mutable", mutable_ns);
+	mutable_ns = timeMutable(root, &misses, &found_compact);
+	printf(" %12.1f\n", mutable_ns);
+
+	compact_ns = timeCompact(trie, &hits, &found_compact);
+	printf("%-10s %12.1f", "Compact", compact_ns);
+	if (found_compact != found_mutable)
+		printf("\nMISMATCH: %d hits found instead of %d\n", found_compact, found_mutable);
+	compact_ns = timeCompact(trie, &misses, &found_compact);
+	printf(" %12.1f\n", compact_ns);
+	if (found_compact != 0)
+		printf("MISMATCH: %d misses found\n", found_compact);
+
+	// Predictions are asked for the first two letters of a word and for the
+	// word that follows a word, whose subtrie is searched.
+	mutable_prefixes = malloc(sizeof(unsigned int) * hits.count);
+	compact_prefixes = malloc(sizeof(unsigned int) * hits.count);
+	mutable_subtries = malloc(sizeof(unsigned int) * hits.count);
+	compact_subtries = malloc(sizeof(unsigned int) * hits.count);
+	if (mutable_prefixes == NULL || compact_prefixes == NULL || mutable_subtries == NULL || compact_subtries == NULL)
+	{
+		printf("ERROR: Could not allocate memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	prefix_count = subtrie_count = 0;
+	for (i = 0; i < hits.count; i++)
+	{
+		strncpy(buffer, hits.keys[i], 2);
+		buffer[2] = '\0';
+		mutable_prefixes[prefix_count] = getPrefixNode(root, root->root, buffer);
+		compact_prefixes[prefix_count++] = getCompactPrefixNode(trie, 1, buffer);
+
+		node = getNode(root, root->root, hits.keys[i]);
+		if (trieNode(root, node)->subtrie != 0)
+		{
+			mutable_subtries[subtrie_count] = trieNode(root, node)->subtrie;
+			compact_subtries[subtrie_count++] = trie->nodes[getCompactNode(trie, 1, hits.keys[i])].subtrie;
+		}
+	}
+
+	printf("\n%-10s %12s %12s %12s\n", "ns/predict", "walk", "mutable", "compact");
+	timePredictions("Prefix", root, trie, mutable_prefixes, compact_prefixes, prefix_count);
+	timePredictions("Next word", root, trie, mutable_subtries, compact_subtries, subtrie_count);
+
+	printf("\n%-10s %12s %12s %12s\n", "ns/top-" "10", "brute force", "mutable", "compact");
+	timeCompletions("Prefix", root, trie, mutable_prefixes, compact_prefixes, prefix_count);
+	timeCompletions("Next word", root, trie, mutable_subtries, compact_subtries, subtrie_count);
+
+	free(mutable_prefixes);
+	free(compact_prefixes);
+	free(mutable_subtries);
+	free(compact_subtries);
+	freeKeys(&hits);
+	freeKeys(&misses);
+	trie = destroyCompactTrie(trie);
+
+	start = getTime();
+	root = destroyTrie(root);
+	destroy_time = getTime() - start;
+	printf("\nTeardown of the mutable trie: %.3f s\n", destroy_time);
+
+	return 0;
+}